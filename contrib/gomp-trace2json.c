@@ -0,0 +1,284 @@
+/* Convert a libgomp GOMP_TRACE file to Chrome trace JSON.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of GCC.
+
+   GCC is free software; you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 3, or (at your option) any later
+   version.
+
+   GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+   for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING3.  If not see
+   <http://www.gnu.org/licenses/>.  */
+
+/* Build with
+
+     gcc -O2 -o gomp-trace2json gomp-trace2json.c
+
+   and run as
+
+     gomp-trace2json [TRACE [JSON]]
+
+   reading standard input and writing standard output by default.  The
+   result can be loaded into chrome://tracing or a compatible viewer.
+   Parallel regions, implicit tasks, barriers and explicit tasks become
+   nested slices of the threads that ran them; each chunk of loop
+   iterations becomes a slice lasting until the thread's next event,
+   which is roughly the time the chunk took.  Deferred tasks are linked
+   by flow arrows from where they were created to where they ran.  The
+   file format is described in libgomp/trace.c.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum
+{
+  PARALLEL_BEGIN = 1,
+  PARALLEL_END,
+  BARRIER_BEGIN,
+  BARRIER_END,
+  TASK_CREATE,
+  TASK_BEGIN,
+  TASK_END,
+  LOOP_CHUNK,
+  IMPLICIT_BEGIN,
+  IMPLICIT_END
+};
+
+struct event
+{
+  unsigned long long time;
+  unsigned int kind;
+  unsigned int arg0;
+  unsigned long long arg1;
+};
+
+static const char *progname;
+static FILE *in, *out;
+static int swap;
+static int first = 1;
+
+static void
+fatal (const char *msg)
+{
+  fprintf (stderr, "%s: %s\n", progname, msg);
+  exit (1);
+}
+
+static unsigned int
+swap32 (unsigned int x)
+{
+  return ((x >> 24) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000)
+	  | (x << 24)) & 0xffffffff;
+}
+
+static unsigned long long
+swap64 (unsigned long long x)
+{
+  return ((unsigned long long) swap32 (x) << 32) | swap32 (x >> 32);
+}
+
+/* Read a 32-bit word from the input.  If EOF is not NULL, set it
+   instead of failing at the end of the file.  */
+
+static unsigned int
+read_word (int *eof)
+{
+  unsigned int x;
+
+  if (fread (&x, 4, 1, in) != 1)
+    {
+      if (eof != NULL && feof (in))
+	{
+	  *eof = 1;
+	  return 0;
+	}
+      fatal ("truncated trace file");
+    }
+  return swap ? swap32 (x) : x;
+}
+
+/* Likewise for a 64-bit word, which must be present.  */
+
+static unsigned long long
+read64 (void)
+{
+  unsigned long long x;
+
+  if (fread (&x, 8, 1, in) != 1)
+    fatal ("truncated trace file");
+  return swap ? swap64 (x) : x;
+}
+
+/* Start a new JSON event of thread TID at TIME nanoseconds.  */
+
+static void
+begin (const char *name, const char *ph, unsigned int pid, unsigned int tid,
+       unsigned long long time)
+{
+  fprintf (out, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":%u,\"tid\":%u,"
+	   "\"ts\":%llu.%03llu", first ? "" : ",", name, ph, pid, tid,
+	   time / 1000, time % 1000);
+  first = 0;
+}
+
+static void
+convert_thread (unsigned int pid, unsigned int tid,
+		unsigned long long count, unsigned long long n)
+{
+  struct event chunk;
+  int have_chunk = 0;
+
+  begin ("thread_name", "M", pid, tid, 0);
+  fprintf (out, ",\"args\":{\"name\":\"libgomp thread %u\"}}", tid);
+  if (count > n)
+    fprintf (stderr, "%s: thread %u: %llu oldest events were lost\n",
+	     progname, tid, count - n);
+
+  while (n-- > 0)
+    {
+      struct event ev;
+
+      ev.time = read64 ();
+      ev.kind = read_word (NULL);
+      ev.arg0 = read_word (NULL);
+      ev.arg1 = read64 ();
+
+      if (have_chunk)
+	{
+	  begin ("chunk", "X", pid, tid, chunk.time);
+	  fprintf (out, ",\"dur\":%llu.%03llu,\"args\":{\"first\":%lld,"
+		   "\"iterations\":%u}}", (ev.time - chunk.time) / 1000,
+		   (ev.time - chunk.time) % 1000, (long long) chunk.arg1,
+		   chunk.arg0);
+	  have_chunk = 0;
+	}
+
+      switch (ev.kind)
+	{
+	case PARALLEL_BEGIN:
+	  begin ("parallel", "B", pid, tid, ev.time);
+	  fprintf (out, ",\"args\":{\"threads\":%u,\"fn\":\"%#llx\"}}",
+		   ev.arg0, ev.arg1);
+	  break;
+	case PARALLEL_END:
+	  begin ("parallel", "E", pid, tid, ev.time);
+	  fputs ("}", out);
+	  break;
+	case BARRIER_BEGIN:
+	case BARRIER_END:
+	  begin (ev.arg0 ? "barrier" : "dock",
+		 ev.kind == BARRIER_BEGIN ? "B" : "E", pid, tid, ev.time);
+	  fprintf (out, ",\"args\":{\"barrier\":\"%#llx\"}}", ev.arg1);
+	  break;
+	case TASK_CREATE:
+	  begin ("task create", "i", pid, tid, ev.time);
+	  fprintf (out, ",\"s\":\"t\",\"args\":{\"task\":\"%#llx\","
+		   "\"deferred\":%u}}", ev.arg1, ev.arg0);
+	  if (ev.arg0)
+	    {
+	      begin ("task", "s", pid, tid, ev.time);
+	      fprintf (out, ",\"cat\":\"task\",\"id\":\"%#llx\"}", ev.arg1);
+	    }
+	  break;
+	case TASK_BEGIN:
+	  begin ("task", "B", pid, tid, ev.time);
+	  fprintf (out, ",\"args\":{\"task\":\"%#llx\"}}", ev.arg1);
+	  if (ev.arg0)
+	    {
+	      begin ("task", "f", pid, tid, ev.time);
+	      fprintf (out, ",\"cat\":\"task\",\"bp\":\"e\",\"id\":\"%#llx\"}",
+		       ev.arg1);
+	    }
+	  break;
+	case TASK_END:
+	  begin ("task", "E", pid, tid, ev.time);
+	  fputs ("}", out);
+	  break;
+	case LOOP_CHUNK:
+	  chunk = ev;
+	  have_chunk = 1;
+	  break;
+	case IMPLICIT_BEGIN:
+	  begin ("implicit task", "B", pid, tid, ev.time);
+	  fprintf (out, ",\"args\":{\"fn\":\"%#llx\"}}", ev.arg1);
+	  break;
+	case IMPLICIT_END:
+	  begin ("implicit task", "E", pid, tid, ev.time);
+	  fputs ("}", out);
+	  break;
+	default:
+	  fprintf (stderr, "%s: thread %u: unknown event %u\n",
+		   progname, tid, ev.kind);
+	  break;
+	}
+    }
+
+  if (have_chunk)
+    {
+      begin ("chunk", "i", pid, tid, chunk.time);
+      fprintf (out, ",\"s\":\"t\",\"args\":{\"first\":%lld,"
+	       "\"iterations\":%u}}", (long long) chunk.arg1, chunk.arg0);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  char magic[8];
+  unsigned int order, size, pid;
+  int eof = 0;
+
+  progname = argv[0];
+  if (argc > 3)
+    {
+      fprintf (stderr, "usage: %s [TRACE [JSON]]\n", progname);
+      return 1;
+    }
+  in = argc > 1 ? fopen (argv[1], "rb") : stdin;
+  if (in == NULL)
+    fatal ("could not open the trace file");
+  out = argc > 2 ? fopen (argv[2], "w") : stdout;
+  if (out == NULL)
+    fatal ("could not open the output file");
+
+  if (fread (magic, 1, 8, in) != 8 || memcmp (magic, "GOMPTRC1", 8) != 0)
+    fatal ("not a libgomp trace file");
+  order = read_word (NULL);
+  if (order == 0x04030201)
+    swap = 1;
+  else if (order != 0x01020304)
+    fatal ("unknown byte order");
+  size = read_word (NULL);
+  if (size != 24)
+    fatal ("unsupported event size");
+  pid = read_word (NULL);
+  read_word (NULL);
+
+  fputs ("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", out);
+  while (1)
+    {
+      unsigned int tid;
+      unsigned long long count, n;
+
+      tid = read_word (&eof);
+      if (eof)
+	break;
+      read_word (NULL);
+      count = read64 ();
+      n = read64 ();
+      convert_thread (pid, tid, count, n);
+    }
+  fputs ("\n]}\n", out);
+
+  if (ferror (out) || (out != stdout && fclose (out) != 0))
+    fatal ("could not write the output file");
+  return 0;
+}
@@ -23,6 +23,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "system.h"
 #include "alloc-pool.h"
 #include "hashtab.h"
+#include "timevar.h"
 
 #define align_eight(x) (((x+7) >> 3) << 3)
 
@@ -209,6 +210,8 @@ empty_alloc_pool (alloc_pool pool)
       next_block = block->next;
       free (block);
     }
+  timevar_pool_mem_total
+    -= (HOST_WIDE_INT) (pool->blocks_allocated * pool->block_size);
 
 #ifdef GATHER_STATISTICS
   desc->current -= (pool->elts_allocated - pool->elts_free) * pool->elt_size;
@@ -272,6 +275,7 @@ pool_alloc (alloc_pool pool)
 
 	  /* Make the block.  */
 	  block = XNEWVEC (char, pool->block_size);
+	  timevar_pool_mem_total += pool->block_size;
 	  block_header = (alloc_pool_list) block;
 	  block += align_eight (sizeof (struct alloc_pool_list_def));
 	  
@@ -28,6 +28,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "ggc.h"
 #include "bitmap.h"
 #include "hashtab.h"
+#include "timevar.h"
 
 #ifdef GATHER_STATISTICS
 
@@ -319,8 +320,8 @@ bitmap_obstack_initialize (bitmap_obstack *bit_obstack)
   bit_obstack->heads = NULL;
   obstack_specify_allocation (&bit_obstack->obstack, OBSTACK_CHUNK_SIZE,
 			      __alignof__ (bitmap_element),
-			      obstack_chunk_alloc,
-			      obstack_chunk_free);
+			      timevar_obstack_chunk_alloc,
+			      timevar_obstack_chunk_free);
 }
 
 /* Release the memory from a bitmap obstack.  If BIT_OBSTACK is NULL,
@@ -3876,6 +3876,13 @@ enum built_in_attribute
 
 static GTY(()) tree built_in_attributes[(int) ATTR_LAST];
 
+/* The types and attributes of the library functions that def_builtin_1
+   has not declared yet, indexed by function code.  In C, a library
+   builtin such as "memcpy" is only declared when its name is first
+   seen; see c_declare_lazy_builtin.  */
+static GTY(()) tree lazy_builtin_types[(int) END_BUILTINS];
+static GTY(()) tree lazy_builtin_attrs[(int) END_BUILTINS];
+
 static void c_init_attributes (void);
 
 enum c_builtin_type
@@ -4523,14 +4530,66 @@ def_builtin_1 (enum built_in_function fncode,
   if (both_p
       && !flag_no_builtin && !builtin_function_disabled_p (libname)
       && !(nonansi_p && flag_no_nonansi_builtin))
-    add_builtin_function (libname, libtype, fncode, fnclass,
-			  NULL, fnattrs);
+    {
+      /* Names in the implementation namespace are made visible
+	 without being seen, see push_file_scope, so they are declared
+	 now like everything in C++.  */
+      if (!c_dialect_cxx ()
+	  && !(libname[0] == '_'
+	       && (libname[1] == '_' || ISUPPER (libname[1]))))
+	{
+	  C_LAZY_BUILTIN (get_identifier (libname)) = 1;
+	  lazy_builtin_types[(int) fncode] = libtype;
+	  lazy_builtin_attrs[(int) fncode] = fnattrs;
+	}
+      else
+	add_builtin_function (libname, libtype, fncode, fnclass,
+			      NULL, fnattrs);
+    }
 
   built_in_decls[(int) fncode] = decl;
   if (implicit_p)
     implicit_built_in_decls[(int) fncode] = decl;
 }
 
+/* Declare the library builtin function ID, flagged C_LAZY_BUILTIN,
+   now that its name has been seen.  */
+
+void
+c_declare_lazy_builtin (tree id)
+{
+  const char *name = IDENTIFIER_POINTER (id);
+  tree builtin = identifier_global_value
+    (get_identifier (ACONCAT (("__builtin_", name, NULL))));
+  location_t saved_location = input_location;
+  int fncode;
+
+  C_LAZY_BUILTIN (id) = 0;
+  if (builtin
+      && TREE_CODE (builtin) == FUNCTION_DECL
+      && DECL_BUILT_IN_CLASS (builtin) == BUILT_IN_NORMAL)
+    fncode = DECL_FUNCTION_CODE (builtin);
+  else
+    /* The __builtin_ name has been declared as something else.  */
+    for (fncode = 0; fncode < (int) END_BUILTINS; fncode++)
+      if (lazy_builtin_types[fncode]
+	  && !strcmp (IDENTIFIER_POINTER (DECL_NAME (built_in_decls[fncode]))
+		      + strlen ("__builtin_"), name))
+	break;
+  gcc_assert (fncode < (int) END_BUILTINS && lazy_builtin_types[fncode]);
+
+  /* Like the other builtins, the declaration is at BUILTINS_LOCATION.  */
+  input_location = BUILTINS_LOCATION;
+  add_builtin_function (name, lazy_builtin_types[fncode],
+			(enum built_in_function) fncode,
+			DECL_BUILT_IN_CLASS (built_in_decls[fncode]), NULL,
+			lazy_builtin_attrs[fncode]);
+  input_location = saved_location;
+
+  lazy_builtin_types[fncode] = NULL_TREE;
+  lazy_builtin_attrs[fncode] = NULL_TREE;
+}
+
 /* Nonzero if the type T promotes to int.  This is (nearly) the
    integral promotions defined in ISO C99 6.3.1.1/2.  */
 
@@ -7405,8 +7464,8 @@ resort_field_decl_cmp (const void *x_p, const void *y_p)
   {
     tree d1 = DECL_NAME (*x);
     tree d2 = DECL_NAME (*y);
-    resort_data.new_value (&d1, resort_data.cookie);
-    resort_data.new_value (&d2, resort_data.cookie);
+    resort_data.new_value (&d1, NULL, resort_data.cookie);
+    resort_data.new_value (&d2, NULL, resort_data.cookie);
     if (d1 < d2)
       return -1;
   }
@@ -32,7 +32,7 @@ along with GCC; see the file COPYING3.  If not see
       DECL_PRETTY_FUNCTION_P (in VAR_DECL)
    1: C_DECLARED_LABEL_FLAG (in LABEL_DECL)
       STATEMENT_LIST_STMT_EXPR (in STATEMENT_LIST)
-   2: unused
+   2: C_LAZY_BUILTIN (in IDENTIFIER_NODE, C only)
    3: STATEMENT_LIST_HAS_LABEL (in STATEMENT_LIST)
    4: unused
 */
@@ -759,14 +759,22 @@ extern void set_builtin_user_assembler_name (tree decl, const char *asmspec);
 
 extern void disable_builtin_function (const char *);
 
+/* In an IDENTIFIER_NODE, nonzero if the identifier names a library
+   builtin function that has not been declared yet.  */
+#define C_LAZY_BUILTIN(ID) TREE_LANG_FLAG_2 (IDENTIFIER_NODE_CHECK (ID))
+
+extern void c_declare_lazy_builtin (tree);
+
 extern void set_compound_literal_name (tree decl);
 
 extern tree build_va_arg (tree, tree);
 
 extern unsigned int c_common_init_options (unsigned int, const char **);
 extern bool c_common_post_options (const char **);
+extern bool c_common_read_main_file (const char **);
 extern bool c_common_init (void);
 extern void c_common_finish (void);
+extern void c_common_print_statistics (void);
 extern void c_common_parse_file (int);
 extern alias_set_type c_common_get_alias_set (tree);
 extern void c_register_builtin_type (tree, const char*);
@@ -54,6 +54,7 @@ static void builtin_define_with_hex_fp_value (const char *, tree,
 					      int, const char *,
 					      const char *,
 					      const char *);
+static const char *lazy_hex_fp_value (cpp_reader *, cpp_hashnode *);
 static void builtin_define_stdint_macros (void);
 static void builtin_define_type_max (const char *, tree, int);
 static void builtin_define_type_precision (const char *, tree);
@@ -467,6 +468,8 @@ c_cpp_builtins (cpp_reader *pfile)
   if (flag_undef)
     return;
 
+  cpp_get_callbacks (pfile)->compute_macro = lazy_hex_fp_value;
+
   define__GNUC__ ();
 
   /* For stddef.h.  They require macros defined in c-common.c.  */
@@ -475,20 +478,20 @@ c_cpp_builtins (cpp_reader *pfile)
   if (c_dialect_cxx ())
     {
       if (flag_weak && SUPPORTS_ONE_ONLY)
-	cpp_define (pfile, "__GXX_WEAK__=1");
+	cpp_define_lazily (pfile, "__GXX_WEAK__=1");
       else
-	cpp_define (pfile, "__GXX_WEAK__=0");
+	cpp_define_lazily (pfile, "__GXX_WEAK__=0");
       if (warn_deprecated)
-	cpp_define (pfile, "__DEPRECATED");
+	cpp_define_lazily (pfile, "__DEPRECATED");
       if (flag_rtti)
-	cpp_define (pfile, "__GXX_RTTI");
+	cpp_define_lazily (pfile, "__GXX_RTTI");
       if (cxx_dialect == cxx0x)
-        cpp_define (pfile, "__GXX_EXPERIMENTAL_CXX0X__");
+        cpp_define_lazily (pfile, "__GXX_EXPERIMENTAL_CXX0X__");
     }
   /* Note that we define this for C as well, so that we know if
      __attribute__((cleanup)) will interface with EH.  */
   if (flag_exceptions)
-    cpp_define (pfile, "__EXCEPTIONS");
+    cpp_define_lazily (pfile, "__EXCEPTIONS");
 
   /* Represents the C++ ABI version, always defined so it can be used while
      preprocessing C and assembler.  */
@@ -512,7 +515,7 @@ c_cpp_builtins (cpp_reader *pfile)
 
   /* libgcc needs to know this.  */
   if (USING_SJLJ_EXCEPTIONS)
-    cpp_define (pfile, "__USING_SJLJ_EXCEPTIONS__");
+    cpp_define_lazily (pfile, "__USING_SJLJ_EXCEPTIONS__");
 
   /* limits.h needs to know these.  */
   builtin_define_type_max ("__SCHAR_MAX__", signed_char_type_node, 0);
@@ -616,36 +619,36 @@ c_cpp_builtins (cpp_reader *pfile)
   builtin_define_with_value ("__VERSION__", version_string, 1);
 
   if (flag_gnu89_inline)
-    cpp_define (pfile, "__GNUC_GNU_INLINE__");
+    cpp_define_lazily (pfile, "__GNUC_GNU_INLINE__");
   else
-    cpp_define (pfile, "__GNUC_STDC_INLINE__");
+    cpp_define_lazily (pfile, "__GNUC_STDC_INLINE__");
 
   /* Definitions for LP64 model.  */
   if (TYPE_PRECISION (long_integer_type_node) == 64
       && POINTER_SIZE == 64
       && TYPE_PRECISION (integer_type_node) == 32)
     {
-      cpp_define (pfile, "_LP64");
-      cpp_define (pfile, "__LP64__");
+      cpp_define_lazily (pfile, "_LP64");
+      cpp_define_lazily (pfile, "__LP64__");
     }
 
   /* Other target-independent built-ins determined by command-line
      options.  */
   if (optimize_size)
-    cpp_define (pfile, "__OPTIMIZE_SIZE__");
+    cpp_define_lazily (pfile, "__OPTIMIZE_SIZE__");
   if (optimize)
-    cpp_define (pfile, "__OPTIMIZE__");
+    cpp_define_lazily (pfile, "__OPTIMIZE__");
 
   if (fast_math_flags_set_p ())
-    cpp_define (pfile, "__FAST_MATH__");
+    cpp_define_lazily (pfile, "__FAST_MATH__");
   if (flag_no_inline)
-    cpp_define (pfile, "__NO_INLINE__");
+    cpp_define_lazily (pfile, "__NO_INLINE__");
   if (flag_signaling_nans)
-    cpp_define (pfile, "__SUPPORT_SNAN__");
+    cpp_define_lazily (pfile, "__SUPPORT_SNAN__");
   if (flag_finite_math_only)
-    cpp_define (pfile, "__FINITE_MATH_ONLY__=1");
+    cpp_define_lazily (pfile, "__FINITE_MATH_ONLY__=1");
   else
-    cpp_define (pfile, "__FINITE_MATH_ONLY__=0");
+    cpp_define_lazily (pfile, "__FINITE_MATH_ONLY__=0");
   if (flag_pic)
     {
       builtin_define_with_int_value ("__pic__", flag_pic);
@@ -658,67 +661,67 @@ c_cpp_builtins (cpp_reader *pfile)
     }
 
   if (flag_iso)
-    cpp_define (pfile, "__STRICT_ANSI__");
+    cpp_define_lazily (pfile, "__STRICT_ANSI__");
 
   if (!flag_signed_char)
-    cpp_define (pfile, "__CHAR_UNSIGNED__");
+    cpp_define_lazily (pfile, "__CHAR_UNSIGNED__");
 
   if (c_dialect_cxx () && TYPE_UNSIGNED (wchar_type_node))
-    cpp_define (pfile, "__WCHAR_UNSIGNED__");
+    cpp_define_lazily (pfile, "__WCHAR_UNSIGNED__");
 
   /* Tell source code if the compiler makes sync_compare_and_swap
      builtins available.  */
 #ifdef HAVE_sync_compare_and_swapqi
   if (HAVE_sync_compare_and_swapqi)
-    cpp_define (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_1");
+    cpp_define_lazily (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_1");
 #endif
 
 #ifdef HAVE_sync_compare_and_swaphi
   if (HAVE_sync_compare_and_swaphi)
-    cpp_define (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_2");
+    cpp_define_lazily (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_2");
 #endif
 
 #ifdef HAVE_sync_compare_and_swapsi
   if (HAVE_sync_compare_and_swapsi)
-    cpp_define (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4");
+    cpp_define_lazily (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4");
 #endif
 
 #ifdef HAVE_sync_compare_and_swapdi
   if (HAVE_sync_compare_and_swapdi)
-    cpp_define (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8");
+    cpp_define_lazily (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8");
 #endif
 
 #ifdef HAVE_sync_compare_and_swapti
   if (HAVE_sync_compare_and_swapti)
-    cpp_define (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16");
+    cpp_define_lazily (pfile, "__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16");
 #endif
 
 #ifdef DWARF2_UNWIND_INFO
   if (dwarf2out_do_cfi_asm ())
-    cpp_define (pfile, "__GCC_HAVE_DWARF2_CFI_ASM");
+    cpp_define_lazily (pfile, "__GCC_HAVE_DWARF2_CFI_ASM");
 #endif
 
   /* Make the choice of ObjC runtime visible to source code.  */
   if (c_dialect_objc () && flag_next_runtime)
-    cpp_define (pfile, "__NEXT_RUNTIME__");
+    cpp_define_lazily (pfile, "__NEXT_RUNTIME__");
 
   /* Show the availability of some target pragmas.  */
   if (flag_mudflap || targetm.handle_pragma_redefine_extname)
-    cpp_define (pfile, "__PRAGMA_REDEFINE_EXTNAME");
+    cpp_define_lazily (pfile, "__PRAGMA_REDEFINE_EXTNAME");
 
   if (targetm.handle_pragma_extern_prefix)
-    cpp_define (pfile, "__PRAGMA_EXTERN_PREFIX");
+    cpp_define_lazily (pfile, "__PRAGMA_EXTERN_PREFIX");
 
   /* Make the choice of the stack protector runtime visible to source code.
      The macro names and values here were chosen for compatibility with an
      earlier implementation, i.e. ProPolice.  */
   if (flag_stack_protect == 2)
-    cpp_define (pfile, "__SSP_ALL__=2");
+    cpp_define_lazily (pfile, "__SSP_ALL__=2");
   else if (flag_stack_protect == 1)
-    cpp_define (pfile, "__SSP__=1");
+    cpp_define_lazily (pfile, "__SSP__=1");
 
   if (flag_openmp)
-    cpp_define (pfile, "_OPENMP=200805");
+    cpp_define_lazily (pfile, "_OPENMP=200805");
 
   builtin_define_type_sizeof ("__SIZEOF_INT__", integer_type_node);
   builtin_define_type_sizeof ("__SIZEOF_LONG__", long_integer_type_node);
@@ -742,7 +745,7 @@ c_cpp_builtins (cpp_reader *pfile)
      linking that hook's body when part of non-C front ends.  */
 # define preprocessing_asm_p() (cpp_get_options (pfile)->lang == CLK_ASM)
 # define preprocessing_trad_p() (cpp_get_options (pfile)->traditional)
-# define builtin_define(TXT) cpp_define (pfile, TXT)
+# define builtin_define(TXT) cpp_define_lazily (pfile, TXT)
 # define builtin_assert(TXT) cpp_assert (pfile, TXT)
   TARGET_CPU_CPP_BUILTINS ();
   TARGET_OS_CPP_BUILTINS ();
@@ -761,7 +764,7 @@ c_cpp_builtins (cpp_reader *pfile)
      alternate format (BID) is used instead of the standard (DPD)
      format.  */
   if (ENABLE_DECIMAL_FLOAT && ENABLE_DECIMAL_BID_FORMAT)
-    cpp_define (pfile, "__DECIMAL_BID_FORMAT__");
+    cpp_define_lazily (pfile, "__DECIMAL_BID_FORMAT__");
 
   builtin_define_with_int_value ("__BIGGEST_ALIGNMENT__",
 				 BIGGEST_ALIGNMENT / BITS_PER_UNIT);
@@ -793,7 +796,7 @@ builtin_define_std (const char *macro)
       if (p[1] != '_')
 	*--p = '_';
     }
-  cpp_define (parse_in, p);
+  cpp_define_lazily (parse_in, p);
 
   /* If it was in user's namespace...  */
   if (p != buff + 2)
@@ -804,11 +807,11 @@ builtin_define_std (const char *macro)
       if (q[-2] != '_')
 	*q++ = '_';
       *q = '\0';
-      cpp_define (parse_in, p);
+      cpp_define_lazily (parse_in, p);
 
       /* Finally, define the original macro if permitted.  */
       if (!flag_iso)
-	cpp_define (parse_in, macro);
+	cpp_define_lazily (parse_in, macro);
     }
 }
 
@@ -832,7 +835,7 @@ builtin_define_with_value (const char *macro, const char *expansion, int is_str)
   else
     sprintf (buf, "%s=%s", macro, expansion);
 
-  cpp_define (parse_in, buf);
+  cpp_define_lazily (parse_in, buf);
 }
 
 
@@ -850,7 +853,48 @@ builtin_define_with_int_value (const char *macro, HOST_WIDE_INT value)
   buf[mlen] = '=';
   sprintf (buf + mlen + 1, HOST_WIDE_INT_PRINT_DEC, value);
 
-  cpp_define (parse_in, buf);
+  cpp_define_lazily (parse_in, buf);
+}
+
+/* The hexadecimal floating-point values that have been registered
+   with cpp_define_computed; converting them to decimal is slow, so it
+   is only done for the macros that are used.  */
+static struct
+{
+  const char *macro;
+  enum machine_mode mode;
+  int digits;
+  const char *hex_str;
+  const char *fp_suffix;
+  const char *fp_cast;
+} lazy_hex_fp_values[12];
+static int lazy_hex_fp_value_count;
+
+/* The compute_macro callback: return the decimal expansion of the
+   hexadecimal floating-point value of NODE.  */
+static const char *
+lazy_hex_fp_value (cpp_reader *pfile ATTRIBUTE_UNUSED, cpp_hashnode *node)
+{
+  static char buf2[256];
+  REAL_VALUE_TYPE real;
+  char dec_str[64], buf1[256];
+  int i;
+
+  for (i = 0; i < lazy_hex_fp_value_count; i++)
+    if (!strcmp (lazy_hex_fp_values[i].macro, (const char *) NODE_NAME (node)))
+      break;
+  gcc_assert (i < lazy_hex_fp_value_count);
+
+  real_from_string (&real, lazy_hex_fp_values[i].hex_str);
+  real_to_decimal_for_mode (dec_str, &real, sizeof (dec_str),
+			    lazy_hex_fp_values[i].digits, 0,
+			    lazy_hex_fp_values[i].mode);
+
+  /* Assemble the macro in the following fashion
+     macro = fp_cast [dec_str fp_suffix] */
+  sprintf (buf1, "%s%s", dec_str, lazy_hex_fp_values[i].fp_suffix);
+  sprintf (buf2, lazy_hex_fp_values[i].fp_cast, buf1);
+  return buf2;
 }
 
 /* Pass an object-like macro a hexadecimal floating-point value.  */
@@ -861,8 +905,7 @@ builtin_define_with_hex_fp_value (const char *macro,
 				  const char *fp_suffix,
 				  const char *fp_cast)
 {
-  REAL_VALUE_TYPE real;
-  char dec_str[64], buf1[256], buf2[256];
+  int i;
 
   /* Hex values are really cool and convenient, except that they're
      not supported in strict ISO C90 mode.  First, the "p-" sequence
@@ -872,19 +915,29 @@ builtin_define_with_hex_fp_value (const char *macro,
 
      So instead what we do is construct the number in hex (because
      it's easy to get the exact correct value), parse it as a real,
-     then print it back out as decimal.  */
-
-  real_from_string (&real, hex_str);
-  real_to_decimal_for_mode (dec_str, &real, sizeof (dec_str), digits, 0,
-			    TYPE_MODE (type));
-
-  /* Assemble the macro in the following fashion
-     macro = fp_cast [dec_str fp_suffix] */
-  sprintf (buf1, "%s%s", dec_str, fp_suffix);
-  sprintf (buf2, fp_cast, buf1);
-  sprintf (buf1, "%s=%s", macro, buf2);
-  
-  cpp_define (parse_in, buf1);
+     then print it back out as decimal.  That is left to
+     lazy_hex_fp_value.  */
+
+  /* The builtins are defined again for each file of a combined
+     compilation.  */
+  for (i = 0; i < lazy_hex_fp_value_count; i++)
+    if (!strcmp (lazy_hex_fp_values[i].macro, macro))
+      break;
+  if (i == lazy_hex_fp_value_count)
+    {
+      gcc_assert (i < (int) ARRAY_SIZE (lazy_hex_fp_values));
+      lazy_hex_fp_values[i].macro = xstrdup (macro);
+      lazy_hex_fp_value_count++;
+    }
+  else
+    free (CONST_CAST (char *, lazy_hex_fp_values[i].hex_str));
+  lazy_hex_fp_values[i].mode = TYPE_MODE (type);
+  lazy_hex_fp_values[i].digits = digits;
+  lazy_hex_fp_values[i].hex_str = xstrdup (hex_str);
+  lazy_hex_fp_values[i].fp_suffix = fp_suffix;
+  lazy_hex_fp_values[i].fp_cast = fp_cast;
+
+  cpp_define_computed (parse_in, macro);
 }
 
 /* Define MAX for TYPE based on the precision of the type.  IS_LONG is
@@ -927,5 +980,5 @@ builtin_define_type_max (const char *macro, tree type, int is_long)
                          + strlen (suffix) + 1);
   sprintf (buf, "%s=%s%s", macro, value, suffix);
 
-  cpp_define (parse_in, buf);
+  cpp_define_lazily (parse_in, buf);
 }
@@ -99,8 +99,12 @@ static bool warn_unused_macros;
 /* If -Wvariadic-macros.  */
 static bool warn_variadic_macros = true;
 
-/* Number of deferred options.  */
-static size_t deferred_count;
+/* Number of deferred options, and the number there is room for.  */
+static size_t deferred_count, deferred_size;
+
+/* Number of deferred options when a compile server had handled its own
+   options; the rest came with the file sent to it.  */
+static size_t server_deferred_count;
 
 /* Number of deferred options scanned for -include.  */
 static size_t include_cursor;
@@ -112,7 +116,7 @@ static void set_std_cxx0x (int);
 static void set_std_c89 (int, int);
 static void set_std_c99 (int);
 static void check_deps_environment_vars (void);
-static void handle_deferred_opts (void);
+static void handle_deferred_opts (size_t);
 static void sanitize_cpp_opts (void);
 static void add_prefixed_path (const char *, size_t);
 static void push_command_line_include (void);
@@ -190,6 +194,12 @@ c_common_missing_argument (const char *opt, size_t code)
 static void
 defer_opt (enum opt_code code, const char *arg)
 {
+  if (deferred_count == deferred_size)
+    {
+      deferred_size = deferred_size * 2 + 1;
+      deferred_opts = XRESIZEVEC (struct deferred_opt, deferred_opts,
+				  deferred_size);
+    }
   deferred_opts[deferred_count].code = code;
   deferred_opts[deferred_count].arg = arg;
   deferred_count++;
@@ -236,6 +246,7 @@ c_common_init_options (unsigned int argc, const char **argv)
   flag_complex_method = 2;
 
   deferred_opts = XNEWVEC (struct deferred_opt, argc);
+  deferred_size = argc;
 
   result = lang_flags[c_language];
 
@@ -801,6 +812,10 @@ c_common_handle_option (size_t scode, const char *arg, int value)
       cpp_opts->wide_charset = arg;
       break;
 
+    case OPT_finclude_cache_:
+      cpp_opts->include_cache = arg;
+      break;
+
     case OPT_finput_charset_:
       cpp_opts->input_charset = arg;
       break;
@@ -1027,7 +1042,7 @@ c_common_post_options (const char **pfilename)
   if (cpp_opts->deps.style == DEPS_NONE)
     check_deps_environment_vars ();
 
-  handle_deferred_opts ();
+  handle_deferred_opts (0);
 
   sanitize_cpp_opts ();
 
@@ -1182,15 +1197,21 @@ c_common_post_options (const char **pfilename)
      immediately.  */
   errorcount += cpp_errors (parse_in);
 
-  *pfilename = this_input_filename
-    = cpp_read_main_file (parse_in, in_fnames[0]);
-  /* Don't do any compilation or preprocessing if there is no input file.  */
-  if (this_input_filename == NULL)
+  /* A compile server reads each file to compile in a child, with
+     c_common_read_main_file.  */
+  if (flag_compile_server)
     {
-      errorcount++;
+      if (num_in_fnames != 0)
+	error ("input files cannot be given with -server");
+      if (flag_preprocess_only)
+	error ("-E cannot be used with -server");
+      server_deferred_count = deferred_count;
       return false;
     }
 
+  if (!c_common_read_main_file (pfilename))
+    return false;
+
   if (flag_working_directory
       && flag_preprocess_only && !flag_no_line_commands)
     pp_dir_change (parse_in, get_src_pwd ());
@@ -1198,6 +1219,34 @@ c_common_post_options (const char **pfilename)
   return flag_preprocess_only;
 }
 
+/* Start reading the main input file, and set *PFILENAME to its
+   original name.  Return false if there is no input file.  */
+bool
+c_common_read_main_file (const char **pfilename)
+{
+  /* The file sent to a compile server comes with its own dependency
+     options, if any (see decode_server_request).  */
+  if (flag_compile_server)
+    {
+      handle_deferred_opts (server_deferred_count);
+      if (deps_seen && cpp_opts->deps.style == DEPS_NONE)
+	{
+	  error ("to generate dependencies you must specify either -M or -MM");
+	  return false;
+	}
+    }
+
+  *pfilename = this_input_filename
+    = cpp_read_main_file (parse_in, in_fnames[0]);
+  /* Don't do any compilation or preprocessing if there is no input file.  */
+  if (this_input_filename == NULL)
+    {
+      errorcount++;
+      return false;
+    }
+  return true;
+}
+
 /* Front end initialization common to C, ObjC and C++.  */
 bool
 c_common_init (void)
@@ -1319,6 +1368,13 @@ c_common_finish (void)
     fatal_error ("when writing output to %s: %m", out_fname);
 }
 
+/* Print the statistics of the preprocessor, for -fmem-report.  */
+void
+c_common_print_statistics (void)
+{
+  cpp_dump_statistics (parse_in);
+}
+
 /* Either of two environment variables can specify output of
    dependencies.  Their value is either "OUTPUT_FILE" or "OUTPUT_FILE
    DEPS_TARGET", where OUTPUT_FILE is the file to write deps info to
@@ -1364,9 +1420,9 @@ check_deps_environment_vars (void)
     }
 }
 
-/* Handle deferred command line switches.  */
+/* Handle deferred command line switches, from the FIRST on.  */
 static void
-handle_deferred_opts (void)
+handle_deferred_opts (size_t first)
 {
   size_t i;
   struct deps *deps;
@@ -1379,7 +1435,7 @@ handle_deferred_opts (void)
 
   deps = cpp_get_deps (parse_in);
 
-  for (i = 0; i < deferred_count; i++)
+  for (i = first; i < deferred_count; i++)
     {
       struct deferred_opt *opt = &deferred_opts[i];
 
@@ -247,6 +247,9 @@ c_lex_one_token (c_parser *parser, c_token *token)
 	      }
 	  }
 
+	if (C_LAZY_BUILTIN (token->value))
+	  c_declare_lazy_builtin (token->value);
+
 	decl = lookup_name (token->value);
 	if (decl)
 	  {
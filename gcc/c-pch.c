@@ -35,6 +35,10 @@ along with GCC; see the file COPYING3.  If not see
 #include "target.h"
 #include "opts.h"
 
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
 /* This is a list of flag variables that must match exactly, and their
    names for the error message.  The possible values for *flag_var must
    fit in a 'signed char'.  */
@@ -71,6 +75,24 @@ struct c_pch_validity
 struct c_pch_header
 {
   unsigned long asm_size;
+  /* The number of PCH files this one is layered on.  A c_pch_layer
+     structure for each, followed by its name, comes next.  */
+  unsigned long n_layers;
+};
+
+/* A PCH file that another is layered on.  The other holds only what
+   changed since this one was loaded, and the layers must be read in
+   first.  */
+
+struct c_pch_layer
+{
+  /* The size and modification time of the file, to check that it
+     hasn't changed since.  */
+  off_t size;
+  time_t mtime;
+  /* The offset in the file of the data for gt_pch_restore_layer.  */
+  long gt_offset;
+  size_t name_length;
 };
 
 #define IDENT_LENGTH 8
@@ -78,6 +100,14 @@ struct c_pch_header
 /* The file we'll be writing the PCH to.  */
 static FILE *pch_outfile;
 
+/* The PCH files read by this compilation, in the order they must be
+   restored in: the one named in the pch_preprocess pragma comes last,
+   after those it is layered on.  A PCH file written by this compilation
+   is layered on all of them.  */
+static struct c_pch_layer *pch_layers;
+static char **pch_layer_names;
+static unsigned long n_pch_layers;
+
 /* The position in the assembler output file when pch_init was called.  */
 static long asm_file_startpos;
 
@@ -92,7 +122,7 @@ static const char *
 get_ident (void)
 {
   static char result[IDENT_LENGTH];
-  static const char templ[IDENT_LENGTH] = "gpch.013";
+  static const char templ[IDENT_LENGTH] = "gpch.016";
   static const char c_language_chars[] = "Co+O";
 
   memcpy (result, templ, IDENT_LENGTH);
@@ -175,6 +205,7 @@ c_common_write_pch (void)
   long asm_file_end;
   long written;
   struct c_pch_header h;
+  unsigned long i;
 
   (*debug_hooks->handle_pch) (1);
 
@@ -182,10 +213,17 @@ c_common_write_pch (void)
 
   asm_file_end = ftell (asm_out_file);
   h.asm_size = asm_file_end - asm_file_startpos;
+  h.n_layers = n_pch_layers;
 
   if (fwrite (&h, sizeof (h), 1, pch_outfile) != 1)
     fatal_error ("can%'t write %s: %m", pch_file);
 
+  for (i = 0; i < n_pch_layers; i++)
+    if (fwrite (&pch_layers[i], sizeof (pch_layers[i]), 1, pch_outfile) != 1
+	|| fwrite (pch_layer_names[i], pch_layers[i].name_length, 1,
+		   pch_outfile) != 1)
+      fatal_error ("can%'t write %s: %m", pch_file);
+
   buf = XNEWVEC (char, 16384);
 
   if (fseek (asm_out_file, asm_file_startpos, SEEK_SET) != 0)
@@ -348,8 +386,59 @@ c_common_valid_pch (cpp_reader *pfile, const char *name, int fd)
   result = cpp_valid_state (pfile, name, fd);
   if (result == -1)
     return 2;
-  else
-    return result == 0;
+  else if (result != 0)
+    return 0;
+
+  /* Check the PCH files this one is layered on.  Each is layered on
+     those before it, so checking the last checks them all.  */
+  {
+    off_t header_pos = lseek (fd, 0, SEEK_CUR);
+    struct c_pch_header h;
+    struct c_pch_layer layer;
+    char *layer_name = NULL;
+    unsigned long i;
+
+    if (header_pos == -1
+	|| read (fd, &h, sizeof (h)) != sizeof (h))
+      fatal_error ("can%'t read %s: %m", name);
+    for (i = 0; i < h.n_layers; i++)
+      {
+	free (layer_name);
+	if (read (fd, &layer, sizeof (layer)) != sizeof (layer))
+	  fatal_error ("can%'t read %s: %m", name);
+	layer_name = XNEWVEC (char, layer.name_length + 1);
+	if ((size_t) read (fd, layer_name, layer.name_length)
+	    != layer.name_length)
+	  fatal_error ("can%'t read %s: %m", name);
+	layer_name[layer.name_length] = '\0';
+      }
+    if (h.n_layers != 0)
+      {
+	struct stat st;
+	int layer_fd;
+
+	result = 2;
+	layer_fd = open (layer_name, O_RDONLY | O_BINARY, 0666);
+	if (layer_fd != -1
+	    && fstat (layer_fd, &st) == 0
+	    && st.st_size == layer.size
+	    && st.st_mtime == layer.mtime)
+	  result = c_common_valid_pch (pfile, layer_name, layer_fd);
+	else if (cpp_get_options (pfile)->warn_invalid_pch)
+	  cpp_error (pfile, CPP_DL_WARNING,
+		     "%s: not used because %s has changed", name, layer_name);
+	if (layer_fd != -1)
+	  close (layer_fd);
+	free (layer_name);
+	if (result != 1)
+	  return result;
+      }
+
+    if (lseek (fd, header_pos, SEEK_SET) == -1)
+      fatal_error ("can%'t read %s: %m", name);
+  }
+
+  return 1;
 }
 
 /* If non-NULL, this function is called after a precompile header file
@@ -368,6 +457,7 @@ c_common_read_pch (cpp_reader *pfile, const char *name,
   struct save_macro_data *smd;
   expanded_location saved_loc;
   bool saved_trace_includes;
+  unsigned long i;
 
   f = fdopen (fd, "rb");
   if (f == NULL)
@@ -386,6 +476,21 @@ c_common_read_pch (cpp_reader *pfile, const char *name,
       return;
     }
 
+  /* Remember the layers, which are read in below, followed by this
+     file itself.  */
+  gcc_assert (n_pch_layers == 0);
+  pch_layers = XNEWVEC (struct c_pch_layer, h.n_layers + 1);
+  pch_layer_names = XNEWVEC (char *, h.n_layers + 1);
+  for (i = 0; i < h.n_layers; i++)
+    {
+      if (fread (&pch_layers[i], sizeof (pch_layers[i]), 1, f) != 1)
+	fatal_error ("can%'t read %s: %m", name);
+      pch_layer_names[i] = XNEWVEC (char, pch_layers[i].name_length + 1);
+      if (fread (pch_layer_names[i], pch_layers[i].name_length, 1, f) != 1)
+	fatal_error ("can%'t read %s: %m", name);
+      pch_layer_names[i][pch_layers[i].name_length] = '\0';
+    }
+
   if (!flag_preprocess_only)
     {
       unsigned long written;
@@ -417,6 +522,31 @@ c_common_read_pch (cpp_reader *pfile, const char *name,
 
   cpp_prepare_state (pfile, &smd);
 
+  for (i = 0; i < h.n_layers; i++)
+    {
+      FILE *layer_f = fopen (pch_layer_names[i], "rb");
+
+      if (layer_f == NULL)
+	fatal_error ("%s: couldn%'t open PCH file: %m", pch_layer_names[i]);
+      if (fseek (layer_f, pch_layers[i].gt_offset, SEEK_SET) != 0)
+	fatal_error ("can%'t read %s: %m", pch_layer_names[i]);
+      gt_pch_restore_layer (layer_f);
+      fclose (layer_f);
+    }
+
+  {
+    struct stat st;
+
+    if (fstat (fd, &st) != 0)
+      fatal_error ("can%'t read %s: %m", name);
+    pch_layers[i].size = st.st_size;
+    pch_layers[i].mtime = st.st_mtime;
+    pch_layers[i].gt_offset = ftell (f);
+    pch_layers[i].name_length = strlen (name);
+    pch_layer_names[i] = xstrdup (name);
+    n_pch_layers = h.n_layers + 1;
+  }
+
   gt_pch_restore (f);
 
   if (cpp_read_state (pfile, name, f, smd) != 0)
@@ -451,10 +581,6 @@ c_common_no_more_pch (void)
 
 /* Handle #pragma GCC pch_preprocess, to load in the PCH file.  */
 
-#ifndef O_BINARY
-# define O_BINARY 0
-#endif
-
 void
 c_common_pch_pragma (cpp_reader *pfile, const char *name)
 {
@@ -467,6 +593,14 @@ c_common_pch_pragma (cpp_reader *pfile, const char *name)
       return;
     }
 
+  /* A PCH file can be layered on another, but only one can be
+     named here.  */
+  if (n_pch_layers != 0)
+    {
+      error ("a PCH file has already been loaded");
+      return;
+    }
+
   fd = open (name, O_RDONLY | O_BINARY, 0666);
   if (fd == -1)
     fatal_error ("%s: couldn%'t open PCH file: %m", name);
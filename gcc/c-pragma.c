@@ -490,6 +490,8 @@ handle_pragma_weak (cpp_reader * ARG_UNUSED (dummy))
   if (t != CPP_EOF)
     warning (OPT_Wpragmas, "junk at end of %<#pragma weak%>");
 
+  if (C_LAZY_BUILTIN (name))
+    c_declare_lazy_builtin (name);
   decl = identifier_global_value (name);
   if (decl && DECL_P (decl))
     {
@@ -571,6 +573,8 @@ handle_pragma_redefine_extname (cpp_reader * ARG_UNUSED (dummy))
       return;
     }
 
+  if (C_LAZY_BUILTIN (oldname))
+    c_declare_lazy_builtin (oldname);
   decl = identifier_global_value (oldname);
   if (decl
       && (TREE_PUBLIC (decl) || DECL_EXTERNAL (decl))
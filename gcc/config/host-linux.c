@@ -156,17 +156,11 @@ linux_gt_pch_get_address (size_t size, int fd)
 /* Map SIZE bytes of FD+OFFSET at BASE.  Return 1 if we succeeded at
    mapping the data at BASE, -1 if we couldn't.
 
-   It's not possibly to reliably mmap a file using MAP_PRIVATE to
-   a specific START address on either hpux or linux.  First we see
-   if mmap with MAP_PRIVATE works.  If it does, we are off to the
-   races.  If it doesn't, we try an anonymous private mmap since the
-   kernel is more likely to honor the BASE address in anonymous maps.
-   We then copy the data to the anonymous private map.  This assumes
-   of course that we don't need to change the data in the PCH file
-   after it is created.
-
-   This approach obviously causes a performance penalty but there is
-   little else we can do given the current PCH implementation.  */
+   The mapping is private and backed by the file, so that concurrent
+   compilations using the same PCH share its pages until they write
+   to them.  If BASE is taken, gt_pch_restore maps the file elsewhere
+   and relocates the data, which keeps most pages shared; copying the
+   data into anonymous memory at BASE would share none.  */
 
 static int
 linux_gt_pch_use_address (void *base, size_t size, int fd, size_t offset)
@@ -188,32 +182,7 @@ linux_gt_pch_use_address (void *base, size_t size, int fd, size_t offset)
   if (addr != (void *) MAP_FAILED)
     munmap (addr, size);
 
-  /* Try to make an anonymous private mmap at the desired location.  */
-  addr = mmap (base, size, PROT_READ | PROT_WRITE,
-	       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-
-  if (addr != base)
-    {
-      if (addr != (void *) MAP_FAILED)
-        munmap (addr, size);
-      return -1;
-    }
-
-  if (lseek (fd, offset, SEEK_SET) == (off_t)-1)
-    return -1;
-
-  while (size)
-    {
-      ssize_t nbytes;
-
-      nbytes = read (fd, base, MIN (size, SSIZE_MAX));
-      if (nbytes <= 0)
-        return -1;
-      base = (char *) base + nbytes;
-      size -= nbytes;
-    }
-
-  return 1;
+  return -1;
 }
 
 
@@ -314,10 +314,10 @@ ix86_target_macros (void)
     {
       cpp_assert (parse_in, "cpu=x86_64");
       cpp_assert (parse_in, "machine=x86_64");
-      cpp_define (parse_in, "__amd64");
-      cpp_define (parse_in, "__amd64__");
-      cpp_define (parse_in, "__x86_64");
-      cpp_define (parse_in, "__x86_64__");
+      cpp_define_lazily (parse_in, "__amd64");
+      cpp_define_lazily (parse_in, "__amd64__");
+      cpp_define_lazily (parse_in, "__x86_64");
+      cpp_define_lazily (parse_in, "__x86_64__");
     }
   else
     {
@@ -330,7 +330,7 @@ ix86_target_macros (void)
 			       ix86_arch,
 			       ix86_tune,
 			       ix86_fpmath,
-			       cpp_define);
+			       cpp_define_lazily);
 }
 
 
@@ -359,7 +359,7 @@ reg_attrs_htab_hash (const void *x)
 {
   const reg_attrs *const p = (const reg_attrs *) x;
 
-  return ((p->offset * 1000) ^ (long) p->decl);
+  return ((p->offset * 1000) ^ (size_t) iterative_hash_expr (p->decl, 0));
 }
 
 /* Returns nonzero if the value represented by X (which is really a
@@ -229,6 +229,16 @@ static int combine_flag = 0;
 
 static int use_pipes;
 
+/* The number of input files that may be compiled at the same time,
+   from -j.  */
+
+static int max_jobs = 1;
+
+/* Nonzero means keep the compiler proper running and send it each
+   input file to compile, from -server.  */
+
+static int use_compile_server;
+
 /* The compiler version.  */
 
 static const char *compiler_version;
@@ -320,6 +330,17 @@ static void delete_if_ordinary (const char *);
 static void delete_temp_files (void);
 static void delete_failure_queue (void);
 static void clear_failure_queue (void);
+static void compile_input (int);
+#ifdef HAVE_WORKING_FORK
+static void compile_inputs_in_parallel (void);
+static int compile_server_file_option (const char *);
+static void stop_compile_server (void);
+static bool start_compile_server (const char **, int);
+static void start_shared_compile_server (void);
+static void stop_shared_compile_server (void);
+static void use_shared_compile_server (int, const char *);
+static bool run_in_compile_server (const char *, const char **, int *);
+#endif
 static int check_live_switch (int, int);
 static const char *handle_braces (const char *);
 static inline bool input_suffix_matches (const char *, const char *);
@@ -1132,6 +1153,7 @@ static const struct option_map option_map[] =
    {"--include-with-prefix", "-iwithprefix", "a"},
    {"--include-with-prefix-before", "-iwithprefixbefore", "a"},
    {"--include-with-prefix-after", "-iwithprefix", "a"},
+   {"--jobs", "-j", "aj"},
    {"--language", "-x", "a"},
    {"--library-directory", "-L", "a"},
    {"--machine", "-m", "aj"},
@@ -2842,7 +2864,8 @@ execute (void)
   int i;
   int n_commands;		/* # of command.  */
   char *string;
-  struct pex_obj *pex;
+  struct pex_obj *pex = NULL;
+  int server_status = 0;
   struct command
   {
     const char *prog;		/* program name.  */
@@ -2986,37 +3009,49 @@ execute (void)
     }
 #endif
 
-  /* Run each piped subprocess.  */
+#ifdef HAVE_WORKING_FORK
+  if (use_compile_server && n_commands == 1
+      && run_in_compile_server (commands[0].prog, commands[0].argv,
+				&server_status))
+    {
+      if (commands[0].argv[0] != commands[0].prog)
+	free (CONST_CAST (char *, commands[0].argv[0]));
+    }
+  else
+#endif
+    {
+      /* Run each piped subprocess.  */
 
-  pex = pex_init (PEX_USE_PIPES | (report_times ? PEX_RECORD_TIMES : 0),
-		  programname, temp_filename);
-  if (pex == NULL)
-    pfatal_with_name (_("pex_init failed"));
+      pex = pex_init (PEX_USE_PIPES | (report_times ? PEX_RECORD_TIMES : 0),
+		      programname, temp_filename);
+      if (pex == NULL)
+	pfatal_with_name (_("pex_init failed"));
 
-  for (i = 0; i < n_commands; i++)
-    {
-      const char *errmsg;
-      int err;
-      const char *string = commands[i].argv[0];
-
-      errmsg = pex_run (pex,
-			((i + 1 == n_commands ? PEX_LAST : 0)
-			 | (string == commands[i].prog ? PEX_SEARCH : 0)),
-			string, CONST_CAST (char **, commands[i].argv),
-			NULL, NULL, &err);
-      if (errmsg != NULL)
+      for (i = 0; i < n_commands; i++)
 	{
-	  if (err == 0)
-	    fatal (errmsg);
-	  else
+	  const char *errmsg;
+	  int err;
+	  const char *string = commands[i].argv[0];
+
+	  errmsg = pex_run (pex,
+			    ((i + 1 == n_commands ? PEX_LAST : 0)
+			     | (string == commands[i].prog ? PEX_SEARCH : 0)),
+			    string, CONST_CAST (char **, commands[i].argv),
+			    NULL, NULL, &err);
+	  if (errmsg != NULL)
 	    {
-	      errno = err;
-	      pfatal_with_name (errmsg);
+	      if (err == 0)
+		fatal (errmsg);
+	      else
+		{
+		  errno = err;
+		  pfatal_with_name (errmsg);
+		}
 	    }
-	}
 
-      if (string != commands[i].prog)
-	free (CONST_CAST (char *, string));
+	  if (string != commands[i].prog)
+	    free (CONST_CAST (char *, string));
+	}
     }
 
   execution_count++;
@@ -3029,17 +3064,23 @@ execute (void)
     int ret_code = 0;
 
     statuses = (int *) alloca (n_commands * sizeof (int));
-    if (!pex_get_status (pex, n_commands, statuses))
-      pfatal_with_name (_("failed to get exit status"));
-
-    if (report_times)
+    if (pex == NULL)
+      statuses[0] = server_status;
+    else
       {
-	times = (struct pex_time *) alloca (n_commands * sizeof (struct pex_time));
-	if (!pex_get_times (pex, n_commands, times))
-	  pfatal_with_name (_("failed to get process times"));
-      }
+	if (!pex_get_status (pex, n_commands, statuses))
+	  pfatal_with_name (_("failed to get exit status"));
 
-    pex_free (pex);
+	if (report_times)
+	  {
+	    times = (struct pex_time *) alloca (n_commands
+						* sizeof (struct pex_time));
+	    if (!pex_get_times (pex, n_commands, times))
+	      pfatal_with_name (_("failed to get process times"));
+	  }
+
+	pex_free (pex);
+      }
 
     for (i = 0; i < n_commands; ++i)
       {
@@ -3077,7 +3118,7 @@ See %s for instructions.",
 	    ret_code = -1;
 	  }
 
-	if (report_times)
+	if (times != NULL)
 	  {
 	    struct pex_time *pt = &times[i];
 	    double ut, st;
@@ -3161,6 +3202,11 @@ static int added_libraries;
 /* And a vector of corresponding output files is made up later.  */
 
 const char **outfiles;
+
+/* Nonzero for each input file that was specified explicitly as link
+   input.  */
+
+static char *explicit_link_files;
 
 #if defined(HAVE_TARGET_OBJECT_SUFFIX) || defined(HAVE_TARGET_EXECUTABLE_SUFFIX)
 
@@ -3257,6 +3303,8 @@ display_help (void)
   fputs (_("  -save-temps              Do not delete intermediate files\n"), stdout);
   fputs (_("  -pipe                    Use pipes rather than intermediate files\n"), stdout);
   fputs (_("  -time                    Time the execution of each subprocess\n"), stdout);
+  fputs (_("  -j <number>              Compile up to <number> input files at once\n"), stdout);
+  fputs (_("  -server                  Keep the compiler running for all the input files\n"), stdout);
   fputs (_("  -specs=<file>            Override built-in specs with the contents of <file>\n"), stdout);
   fputs (_("  -std=<standard>          Assume that the input sources are for <standard>\n"), stdout);
   fputs (_("\
@@ -3827,6 +3875,24 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\n"
 	}
       else if (strcmp (argv[i], "-time") == 0)
 	report_times = 1;
+      else if (strncmp (argv[i], "-j", 2) == 0)
+	{
+	  const char *p = argv[i] + 2;
+
+	  if (*p == 0)
+	    {
+	      if (++i >= argc)
+		fatal ("argument to '-j' is missing");
+	      p = argv[i];
+	    }
+	  max_jobs = atoi (p);
+	  while (ISDIGIT (*p))
+	    p++;
+	  if (*p != 0 || max_jobs < 1)
+	    fatal ("argument to '-j' must be a positive number");
+	}
+      else if (strcmp (argv[i], "-server") == 0)
+	use_compile_server = 1;
       else if (strcmp (argv[i], "-pipe") == 0)
 	{
 	  /* -pipe has to go into the switches array as well as
@@ -4218,6 +4284,12 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\n"
 	;
       else if (strcmp (argv[i], "-time") == 0)
 	;
+      else if (strcmp (argv[i], "-j") == 0)
+	i++;
+      else if (strncmp (argv[i], "-j", 2) == 0)
+	;
+      else if (strcmp (argv[i], "-server") == 0)
+	;
       else if (strcmp (argv[i], "-###") == 0)
 	;
       else if (argv[i][0] == '-' && argv[i][1] != 0)
@@ -6210,6 +6282,856 @@ fatal_error (int signum)
   kill (getpid (), signum);
 }
 
+/* Compile input file I, recording its output file in OUTFILES for the
+   link, or mark it as link input if there is no compiler for it.  */
+
+static void
+compile_input (int i)
+{
+  int this_file_error = 0;
+  int value;
+
+  /* Tell do_spec what to substitute for %i.  */
+
+  input_file_number = i;
+  set_input (infiles[i].name);
+
+  if (infiles[i].compiled)
+    return;
+
+  /* Use the same thing in %o, unless cp->spec says otherwise.  */
+
+  outfiles[i] = input_filename;
+
+  /* Figure out which compiler from the file's suffix.  */
+
+  if (! combine_inputs)
+    input_file_compiler
+      = lookup_compiler (infiles[i].name, input_filename_length,
+			 infiles[i].language);
+  else
+    input_file_compiler = infiles[i].incompiler;
+
+  if (input_file_compiler)
+    {
+      /* Ok, we found an applicable compiler.  Run its spec.  */
+
+      if (input_file_compiler->spec[0] == '#')
+	{
+	  error ("%s: %s compiler not installed on this system",
+		 input_filename, &input_file_compiler->spec[1]);
+	  this_file_error = 1;
+	}
+      else
+	{
+	  value = do_spec (input_file_compiler->spec);
+	  infiles[i].compiled = true;
+	  if (value < 0)
+	    this_file_error = 1;
+	}
+    }
+
+  /* If this file's name does not contain a recognized suffix,
+     record it as explicit linker input.  */
+
+  else
+    explicit_link_files[i] = 1;
+
+  /* Clear the delete-on-failure queue, deleting the files in it
+     if this compilation failed.  */
+
+  if (this_file_error)
+    {
+      delete_failure_queue ();
+      error_count++;
+    }
+  /* If this compilation succeeded, don't delete those files later.  */
+  clear_failure_queue ();
+}
+
+#ifdef HAVE_WORKING_FORK
+
+/* With -j, input files are compiled by children of the driver, each
+   running the compiler spec of one input just as the driver would.  A
+   child keeps its own queues of temporary files, and writes its
+   standard output and standard error to files of its own, which the
+   driver copies out in command-line order once the input is done.
+   The child also writes a result file, holding its greatest_status
+   and signal_count, its entry of OUTFILES and the temporary files it
+   would have deleted at exit; the driver takes those over, as the
+   link may still need them.  */
+
+struct compile_job
+{
+  /* The child compiling the input, or 0 once it has been waited for
+     or if the driver compiles the input itself.  */
+  pid_t pid;
+  int status;
+  bool forked;
+  /* The slot, out of MAX_JOBS, the child runs in.  */
+  int slot;
+  char *out_name;
+  char *err_name;
+  char *result_name;
+};
+
+static struct compile_job *jobs;
+
+/* Whether input file I has a compiler spec to run in a child.  Inputs
+   for the linker, and the error for a compiler that is not installed,
+   are left to the driver.  */
+
+static bool
+input_needs_job (int i)
+{
+  struct compiler *cp;
+
+  if (infiles[i].compiled)
+    return false;
+  if (infiles[i].language)
+    return infiles[i].language[0] != '*';
+  cp = lookup_compiler (infiles[i].name, strlen (infiles[i].name), NULL);
+  return cp != NULL && cp->spec[0] != '#';
+}
+
+/* Point file descriptor FD at the file NAME.  */
+
+static void
+redirect_job_output (int fd, const char *name)
+{
+  int new_fd = open (name, O_WRONLY | O_TRUNC | O_APPEND);
+
+  if (new_fd < 0 || dup2 (new_fd, fd) < 0)
+    pfatal_with_name (name);
+  close (new_fd);
+}
+
+/* Write the string S and its terminating null to F.  */
+
+static void
+write_job_string (FILE *f, const char *s)
+{
+  fputs (s, f);
+  putc ('\0', f);
+}
+
+/* Read a string written by write_job_string from F.  Return NULL at the
+   end of the file.  */
+
+static char *
+read_job_string (FILE *f)
+{
+  int c;
+
+  while ((c = getc (f)) != EOF && c != '\0')
+    obstack_1grow (&obstack, c);
+  if (c == EOF)
+    {
+      obstack_free (&obstack, obstack_finish (&obstack));
+      return NULL;
+    }
+  obstack_1grow (&obstack, '\0');
+  return XOBFINISH (&obstack, char *);
+}
+
+/* Start a child compiling input file I.  */
+
+static void
+start_job (int i)
+{
+  struct compile_job *job = &jobs[i];
+  struct temp_file *temp;
+  FILE *f;
+
+  job->out_name = make_temp_file (".out");
+  job->err_name = make_temp_file (".err");
+  job->result_name = make_temp_file (".res");
+  record_temp_file (job->out_name, 1, 0);
+  record_temp_file (job->err_name, 1, 0);
+  record_temp_file (job->result_name, 1, 0);
+
+  fflush (stdout);
+  fflush (stderr);
+  job->pid = fork ();
+  if (job->pid < 0)
+    pfatal_with_name ("fork");
+  job->forked = true;
+  if (job->pid > 0)
+    return;
+
+  /* In the child.  */
+  redirect_job_output (STDOUT_FILENO, job->out_name);
+  redirect_job_output (STDERR_FILENO, job->err_name);
+  use_shared_compile_server (job->slot, job->err_name);
+  always_delete_queue = NULL;
+  failure_delete_queue = NULL;
+  error_count = 0;
+
+  compile_input (i);
+
+  f = fopen (job->result_name, "w");
+  if (f == NULL)
+    pfatal_with_name (job->result_name);
+  fprintf (f, "%d %d\n", greatest_status, signal_count);
+  write_job_string (f, outfiles[i] ? outfiles[i] : "");
+  for (temp = always_delete_queue; temp; temp = temp->next)
+    write_job_string (f, temp->name);
+  if (fclose (f) != 0)
+    pfatal_with_name (job->result_name);
+
+  fflush (stdout);
+  fflush (stderr);
+  _exit (error_count != 0);
+}
+
+/* Copy the file NAME to TO.  */
+
+static void
+copy_job_output (const char *name, FILE *to)
+{
+  char buf[4096];
+  size_t n;
+  FILE *f = fopen (name, "rb");
+
+  if (f == NULL)
+    return;
+  while ((n = fread (buf, 1, sizeof (buf), f)) > 0)
+    fwrite (buf, 1, n, to);
+  fclose (f);
+}
+
+/* Print the output of the child that compiled input file I and take
+   over its results, or compile the input here if there was no child.  */
+
+static void
+finish_job (int i)
+{
+  struct compile_job *job = &jobs[i];
+  int status = job->status, child_greatest, child_signals;
+  char *name;
+  FILE *f;
+
+  if (!job->forked)
+    {
+      compile_input (i);
+      return;
+    }
+
+  copy_job_output (job->out_name, stdout);
+  fflush (stdout);
+  copy_job_output (job->err_name, stderr);
+  fflush (stderr);
+
+  infiles[i].compiled = true;
+  outfiles[i] = infiles[i].name;
+
+  /* A child that died or called fatal has written no results, and has
+     deleted its temporary files itself.  */
+  f = fopen (job->result_name, "r");
+  if (f != NULL
+      && fscanf (f, "%d %d", &child_greatest, &child_signals) == 2
+      && getc (f) == '\n'
+      && (name = read_job_string (f)) != NULL)
+    {
+      if (child_greatest > greatest_status)
+	greatest_status = child_greatest;
+      signal_count += child_signals;
+      outfiles[i] = *name ? name : NULL;
+      while ((name = read_job_string (f)) != NULL)
+	record_temp_file (name, 1, 0);
+    }
+  else if (WIFEXITED (status) && WEXITSTATUS (status) > greatest_status)
+    greatest_status = WEXITSTATUS (status);
+  if (f != NULL)
+    fclose (f);
+
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    error_count++;
+
+  delete_if_ordinary (job->out_name);
+  delete_if_ordinary (job->err_name);
+  delete_if_ordinary (job->result_name);
+}
+
+/* Compile the input files, running up to MAX_JOBS children at a time.  */
+
+static void
+compile_inputs_in_parallel (void)
+{
+  int next = 0, done = 0, running = 0, n_jobs = 0;
+  int i;
+  bool *slot_used;
+
+  for (i = 0; i < n_infiles; i++)
+    n_jobs += input_needs_job (i);
+  if (n_jobs < 2)
+    {
+      for (i = 0; i < n_infiles; i++)
+	compile_input (i);
+      stop_compile_server ();
+      return;
+    }
+
+  if (use_compile_server)
+    start_shared_compile_server ();
+
+  jobs = XCNEWVEC (struct compile_job, n_infiles);
+  slot_used = XCNEWVEC (bool, max_jobs);
+  while (done < n_infiles)
+    {
+      pid_t pid;
+      int status;
+
+      while (next < n_infiles && running < max_jobs)
+	{
+	  if (input_needs_job (next))
+	    {
+	      for (i = 0; slot_used[i]; i++)
+		;
+	      slot_used[i] = true;
+	      jobs[next].slot = i;
+	      start_job (next);
+	      running++;
+	    }
+	  next++;
+	}
+
+      /* Report the inputs that are done, in command-line order.  */
+      while (done < next && jobs[done].pid == 0)
+	finish_job (done++);
+      if (done == n_infiles)
+	break;
+
+      pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  pfatal_with_name ("waitpid");
+	}
+      for (i = done; i < next; i++)
+	if (jobs[i].pid == pid)
+	  {
+	    jobs[i].pid = 0;
+	    jobs[i].status = status;
+	    slot_used[jobs[i].slot] = false;
+	    running--;
+	    break;
+	  }
+    }
+  stop_shared_compile_server ();
+  free (slot_used);
+  free (jobs);
+  jobs = NULL;
+}
+
+#endif /* HAVE_WORKING_FORK */
+
+#ifdef HAVE_WORKING_FORK
+
+/* With -server, the compiler proper is started with -server and the
+   options that are the same for all the input files, and is sent the
+   name of each file to compile along with the options that name the
+   files made from it and those for the dependencies written for it
+   (see decode_server_request in opts.c).  It sends back the wait
+   status of the compilation.  A new server is started when the options
+   change.  */
+
+static struct compile_server
+{
+  pid_t pid;
+  FILE *to;
+  FILE *from;
+  /* The arguments it was started with, but -server.  */
+  char **argv;
+  int argc;
+} compile_server;
+
+/* If ARG is an option for the compiler proper that differs from one
+   input file to the next, because it names a file made from the input
+   file or is for the dependencies written for it, return the number of
+   arguments it takes, counting a separate argument after it.  Return 0
+   for any other argument.  */
+
+static int
+compile_server_file_option (const char *arg)
+{
+  if (strcmp (arg, "-o") == 0
+      || strcmp (arg, "-dumpbase") == 0
+      || strcmp (arg, "-auxbase") == 0
+      || strcmp (arg, "-auxbase-strip") == 0
+      || strcmp (arg, "-MD") == 0
+      || strcmp (arg, "-MMD") == 0
+      || strcmp (arg, "-MF") == 0
+      || strcmp (arg, "-MQ") == 0
+      || strcmp (arg, "-MT") == 0)
+    return 2;
+  if (strncmp (arg, "-o", 2) == 0
+      || strncmp (arg, "-MF", 3) == 0
+      || strncmp (arg, "-MQ", 3) == 0
+      || strncmp (arg, "-MT", 3) == 0
+      || strcmp (arg, "-MG") == 0
+      || strcmp (arg, "-MP") == 0)
+    return 1;
+  return 0;
+}
+
+/* Tell the compile server, if any, to exit, and wait for it.  */
+
+static void
+stop_compile_server (void)
+{
+  int i, status;
+
+  if (compile_server.pid == 0)
+    return;
+
+  fclose (compile_server.to);
+  fclose (compile_server.from);
+  waitpid (compile_server.pid, &status, 0);
+  compile_server.pid = 0;
+
+  for (i = 0; i < compile_server.argc; i++)
+    free (compile_server.argv[i]);
+  free (compile_server.argv);
+}
+
+/* Start a compile server with the ARGC arguments ARGV, the program
+   first.  Return false if that is not possible.  */
+
+static bool
+start_compile_server (const char **argv, int argc)
+{
+  int to_server[2], from_server[2];
+  pid_t pid;
+  int i;
+
+  if (pipe (to_server) < 0)
+    return false;
+  if (pipe (from_server) < 0)
+    {
+      close (to_server[0]);
+      close (to_server[1]);
+      return false;
+    }
+
+  fflush (stdout);
+  fflush (stderr);
+  pid = fork ();
+  if (pid < 0)
+    {
+      close (to_server[0]);
+      close (to_server[1]);
+      close (from_server[0]);
+      close (from_server[1]);
+      return false;
+    }
+
+  if (pid == 0)
+    {
+      const char **args = XNEWVEC (const char *, argc + 2);
+
+      if (dup2 (to_server[0], STDIN_FILENO) < 0
+	  || dup2 (from_server[1], STDOUT_FILENO) < 0)
+	_exit (1);
+      close (to_server[0]);
+      close (to_server[1]);
+      close (from_server[0]);
+      close (from_server[1]);
+
+      memcpy (args, argv, argc * sizeof (const char *));
+      args[argc] = "-server";
+      args[argc + 1] = NULL;
+      execvp (args[0], CONST_CAST (char **, args));
+
+      /* Leave the temporary files alone: they are the driver's.  */
+      error ("cannot execute '%s': %s", args[0], xstrerror (errno));
+      _exit (1);
+    }
+
+  close (to_server[0]);
+  close (from_server[1]);
+  compile_server.pid = pid;
+  compile_server.to = fdopen (to_server[1], "w");
+  compile_server.from = fdopen (from_server[0], "r");
+  compile_server.argc = argc;
+  compile_server.argv = XNEWVEC (char *, argc);
+  for (i = 0; i < argc; i++)
+    compile_server.argv[i] = xstrdup (argv[i]);
+  return true;
+}
+
+/* With -j, the children of the driver that compile the input files
+   share one compile server.  Before starting them, the driver starts a
+   process that waits for the first request, which carries the
+   arguments to run the server with, and then becomes the server.  The
+   children take turns to write their requests to its standard input,
+   and each gets the replies on a pipe of the job slot it runs in (see
+   serve_compile_requests in toplev.c).  A child whose options are not
+   the ones the server was started with compiles its input file the
+   usual way.  Only the server holds the write ends of the pipes for
+   the replies, so that a child reads the end of the file rather than
+   waiting for ever if the server has gone.  */
+
+static struct shared_compile_server
+{
+  /* The process that runs the server.  */
+  pid_t pid;
+  /* The write end of the server's standard input, or -1.  */
+  int request_fd;
+  /* A pipe holding a single byte while no child is writing to the
+     server, which is zero until the server has been sent the
+     arguments to run it with.  */
+  int turn[2];
+  /* The pipes for the replies, one for each of the MAX_JOBS job
+     slots.  The driver has closed the write ends, but keeps their
+     numbers to tell the server.  */
+  int (*reply)[2];
+  /* In a child, the job slot it runs in, or -1, and the file its
+     standard error goes to.  */
+  int slot;
+  const char *err_name;
+} shared_server = { 0, -1, { -1, -1 }, NULL, -1, NULL };
+
+/* Write the string S and its terminating null to FD.  Return false if
+   that fails.  */
+
+static bool
+write_server_string (int fd, const char *s)
+{
+  size_t len = strlen (s) + 1;
+  ssize_t n;
+
+  while (len > 0)
+    {
+      n = write (fd, s, len);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	return false;
+      s += n;
+      len -= n;
+    }
+  return true;
+}
+
+/* Start the process that becomes the compile server shared by the
+   children of the driver.  If that is not possible, each child
+   compiles its input file the usual way.  */
+
+static void
+start_shared_compile_server (void)
+{
+  int request[2], (*reply)[2];
+  char c = 0;
+  int i, n;
+  pid_t pid;
+
+  reply = (int (*)[2]) xmalloc (max_jobs * sizeof (*reply));
+  for (n = 0; n < max_jobs; n++)
+    if (pipe (reply[n]) < 0)
+      break;
+  if (n < max_jobs
+      || pipe (request) < 0)
+    goto fail;
+  if (pipe (shared_server.turn) < 0)
+    {
+      close (request[0]);
+      close (request[1]);
+      goto fail;
+    }
+
+  fflush (stdout);
+  fflush (stderr);
+  pid = fork ();
+  if (pid < 0)
+    {
+      close (shared_server.turn[0]);
+      close (shared_server.turn[1]);
+      close (request[0]);
+      close (request[1]);
+      goto fail;
+    }
+
+  if (pid == 0)
+    {
+      const char **args = NULL;
+      int n_args = 0;
+      char *arg;
+
+      if (dup2 (request[0], STDIN_FILENO) < 0)
+	_exit (1);
+      close (request[0]);
+      close (request[1]);
+      close (shared_server.turn[0]);
+      close (shared_server.turn[1]);
+      for (i = 0; i < max_jobs; i++)
+	close (reply[i][0]);
+
+      /* Read the arguments up to an empty one, a byte at a time so as
+	 to leave the requests after them to the server.  */
+      do
+	{
+	  while ((n = read (STDIN_FILENO, &c, 1)) != 0)
+	    {
+	      if (n < 0 && errno == EINTR)
+		continue;
+	      if (n < 0)
+		_exit (1);
+	      obstack_1grow (&obstack, c);
+	      if (c == '\0')
+		break;
+	    }
+	  if (n == 0)
+	    _exit (0);
+	  arg = XOBFINISH (&obstack, char *);
+	  args = XRESIZEVEC (const char *, args, n_args + 2);
+	  args[n_args++] = arg;
+	}
+      while (*arg != '\0');
+
+      args[n_args - 1] = "-server";
+      args[n_args] = NULL;
+      execvp (args[0], CONST_CAST (char **, args));
+
+      /* Leave the temporary files alone: they are the driver's.  */
+      error ("cannot execute '%s': %s", args[0], xstrerror (errno));
+      _exit (1);
+    }
+
+  close (request[0]);
+  for (i = 0; i < max_jobs; i++)
+    close (reply[i][1]);
+  shared_server.reply = reply;
+  shared_server.pid = pid;
+  shared_server.request_fd = request[1];
+  if (write (shared_server.turn[1], &c, 1) != 1)
+    pfatal_with_name ("write");
+  return;
+
+ fail:
+  for (i = 0; i < n; i++)
+    {
+      close (reply[i][0]);
+      close (reply[i][1]);
+    }
+  free (reply);
+}
+
+/* Let the shared compile server, if any, finish the requests it has
+   been sent and exit, and wait for it.  */
+
+static void
+stop_shared_compile_server (void)
+{
+  int i, status;
+
+  if (shared_server.request_fd < 0)
+    return;
+
+  close (shared_server.request_fd);
+  close (shared_server.turn[0]);
+  close (shared_server.turn[1]);
+  for (i = 0; i < max_jobs; i++)
+    close (shared_server.reply[i][0]);
+  free (shared_server.reply);
+  shared_server.reply = NULL;
+  shared_server.request_fd = -1;
+
+  /* The driver may have collected it already, if it exited early.  */
+  waitpid (shared_server.pid, &status, 0);
+  shared_server.pid = 0;
+}
+
+/* In a child of the driver, which runs in job slot SLOT with its
+   standard error going to the file ERR_NAME, send the input file to
+   the shared compile server if there is one, or else compile it the
+   usual way.  */
+
+static void
+use_shared_compile_server (int slot, const char *err_name)
+{
+  if (shared_server.request_fd < 0)
+    {
+      use_compile_server = 0;
+      return;
+    }
+  shared_server.slot = slot;
+  shared_server.err_name = err_name;
+}
+
+/* Compile the input file in the shared compile server.  COMMON holds
+   the N_COMMON arguments the server must have been started with, the
+   program first, and FILE the N_FILE arguments for the input file.
+   Set *STATUS to the wait status of the compilation and return true,
+   or return false if the server did not compile the file.  */
+
+static bool
+run_in_shared_compile_server (const char **common, int n_common,
+			      const char **file, int n_file, int *status)
+{
+  int fd = shared_server.request_fd;
+  int *reply = shared_server.reply[shared_server.slot];
+  char started, buf[32];
+  bool ok = true;
+  int i, len;
+  ssize_t n;
+  void (*old_handler) (int);
+
+  /* Wait for the turn to write to the server.  */
+  while (read (shared_server.turn[0], &started, 1) != 1)
+    if (errno != EINTR)
+      return false;
+
+  /* A server that has died must not take the driver with it.  */
+#ifdef SIGPIPE
+  old_handler = signal (SIGPIPE, SIG_IGN);
+#endif
+  if (!started)
+    {
+      for (i = 0; ok && i < n_common; i++)
+	ok = write_server_string (fd, common[i]);
+      ok = ok && write_server_string (fd, "");
+      started = 1;
+    }
+  ok = ok && write_server_string (fd, "-server-reply");
+  sprintf (buf, "%d", reply[1]);
+  ok = ok && write_server_string (fd, buf);
+  ok = ok && write_server_string (fd, shared_server.err_name);
+  sprintf (buf, "%d", n_common - 1);
+  ok = ok && write_server_string (fd, buf);
+  for (i = 1; ok && i < n_common; i++)
+    ok = write_server_string (fd, common[i]);
+  for (i = 0; ok && i < n_file; i++)
+    ok = write_server_string (fd, file[i]);
+  ok = ok && write_server_string (fd, "");
+#ifdef SIGPIPE
+  signal (SIGPIPE, old_handler);
+#endif
+
+  if (write (shared_server.turn[1], &started, 1) != 1)
+    pfatal_with_name ("write");
+  if (!ok)
+    return false;
+
+  /* The pipe is used by the children that run in the same slot after
+     this one, so read no more than the reply.  */
+  len = 0;
+  for (;;)
+    {
+      n = read (reply[0], buf + len, 1);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0 || len == (int) sizeof (buf) - 1)
+	return false;
+      if (buf[len] == '\n')
+	break;
+      len++;
+    }
+  buf[len] = '\0';
+  *status = atoi (buf);
+  return *status >= 0;
+}
+
+/* Compile the input file with the compiler proper PROG, run with the
+   arguments ARGV, by sending it to a compile server, started if there
+   is none for those arguments, and set *STATUS to the wait status of
+   the compilation.  Return false if the command is not one a compile
+   server can run.  */
+
+static bool
+run_in_compile_server (const char *prog, const char **argv, int *status)
+{
+  const char **common, **file;
+  int argc, n_common, n_file, n_inputs, i;
+  void (*old_handler) (int);
+
+  /* Only the C front end can run as a server.  */
+  if (strcmp (prog, "cc1") != 0)
+    return false;
+
+  for (argc = 0; argv[argc] != NULL; argc++)
+    ;
+  common = XALLOCAVEC (const char *, argc);
+  file = XALLOCAVEC (const char *, argc);
+  n_common = n_file = n_inputs = 0;
+
+  common[n_common++] = argv[0];
+  for (i = 1; i < argc; i++)
+    if (compile_server_file_option (argv[i]) == 2 && i + 1 < argc)
+      {
+	file[n_file++] = argv[i];
+	file[n_file++] = argv[++i];
+      }
+    else if (compile_server_file_option (argv[i]) == 1)
+      file[n_file++] = argv[i];
+    else if (argv[i][0] != '-' && strcmp (argv[i], input_filename) == 0)
+      {
+	file[n_file++] = argv[i];
+	n_inputs++;
+      }
+    else if (strcmp (argv[i], "-E") == 0)
+      return false;
+    else
+      common[n_common++] = argv[i];
+
+  if (n_inputs != 1)
+    return false;
+
+  if (shared_server.slot >= 0)
+    return run_in_shared_compile_server (common, n_common, file, n_file,
+					 status);
+
+  if (compile_server.pid != 0)
+    {
+      bool same = compile_server.argc == n_common;
+
+      for (i = 0; same && i < n_common; i++)
+	same = strcmp (compile_server.argv[i], common[i]) == 0;
+      if (!same)
+	stop_compile_server ();
+    }
+  if (compile_server.pid == 0
+      && !start_compile_server (common, n_common))
+    return false;
+
+  /* A server that has died must not take the driver with it.  */
+#ifdef SIGPIPE
+  old_handler = signal (SIGPIPE, SIG_IGN);
+#endif
+  for (i = 0; i < n_file; i++)
+    {
+      fputs (file[i], compile_server.to);
+      putc ('\0', compile_server.to);
+    }
+  putc ('\0', compile_server.to);
+  fflush (compile_server.to);
+#ifdef SIGPIPE
+  signal (SIGPIPE, old_handler);
+#endif
+
+  /* If the server has exited, as it does when the options are wrong,
+     its own status stands for that of the compilation.  */
+  if (ferror (compile_server.to)
+      || fscanf (compile_server.from, "%d", status) != 1
+      || getc (compile_server.from) != '\n')
+    {
+      pid_t pid = compile_server.pid;
+
+      compile_server.pid = 0;
+      fclose (compile_server.to);
+      fclose (compile_server.from);
+      for (i = 0; i < compile_server.argc; i++)
+	free (compile_server.argv[i]);
+      free (compile_server.argv);
+      if (waitpid (pid, status, 0) != pid)
+	pfatal_with_name (prog);
+    }
+  return true;
+}
+
+#endif /* HAVE_WORKING_FORK */
+
 extern int main (int, char **);
 
 int
@@ -6220,7 +7142,6 @@ main (int argc, char **argv)
   int linker_was_run = 0;
   int lang_n_infiles = 0;
   int num_linker_inputs = 0;
-  char *explicit_link_files;
   char *specs_file;
   const char *p;
   struct user_specs *uptr;
@@ -6755,66 +7676,17 @@ main (int argc, char **argv)
       combine_inputs = save_combine_inputs;
     }
 
-  for (i = 0; (int) i < n_infiles; i++)
+#ifdef HAVE_WORKING_FORK
+  if (max_jobs > 1 && !combine_inputs)
+    compile_inputs_in_parallel ();
+  else
+#endif
     {
-      int this_file_error = 0;
-
-      /* Tell do_spec what to substitute for %i.  */
-
-      input_file_number = i;
-      set_input (infiles[i].name);
-
-      if (infiles[i].compiled)
-	continue;
-
-      /* Use the same thing in %o, unless cp->spec says otherwise.  */
-
-      outfiles[i] = input_filename;
-
-      /* Figure out which compiler from the file's suffix.  */
-
-      if (! combine_inputs)
-	input_file_compiler
-	  = lookup_compiler (infiles[i].name, input_filename_length,
-			     infiles[i].language);
-      else
-	input_file_compiler = infiles[i].incompiler;
-
-      if (input_file_compiler)
-	{
-	  /* Ok, we found an applicable compiler.  Run its spec.  */
-
-	  if (input_file_compiler->spec[0] == '#')
-	    {
-	      error ("%s: %s compiler not installed on this system",
-		     input_filename, &input_file_compiler->spec[1]);
-	      this_file_error = 1;
-	    }
-	  else
-	    {
-	      value = do_spec (input_file_compiler->spec);
-	      infiles[i].compiled = true;
-	      if (value < 0)
-		this_file_error = 1;
-	    }
-	}
-
-      /* If this file's name does not contain a recognized suffix,
-	 record it as explicit linker input.  */
-
-      else
-	explicit_link_files[i] = 1;
-
-      /* Clear the delete-on-failure queue, deleting the files in it
-	 if this compilation failed.  */
-
-      if (this_file_error)
-	{
-	  delete_failure_queue ();
-	  error_count++;
-	}
-      /* If this compilation succeeded, don't delete those files later.  */
-      clear_failure_queue ();
+      for (i = 0; (int) i < n_infiles; i++)
+	compile_input (i);
+#ifdef HAVE_WORKING_FORK
+      stop_compile_server ();
+#endif
     }
 
   /* Reset the input file name to the first compile/object file name, for use
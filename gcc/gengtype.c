@@ -1872,6 +1872,7 @@ struct walk_type_data
   const char *reorder_fn;
   bool needs_cast_p;
   bool fn_wants_lvalue;
+  bool in_nested_ptr;
 };
 
 /* Print a mangled name representing T to OF.  */
@@ -2107,6 +2108,7 @@ walk_type (type_p t, struct walk_type_data *d)
 		  }
 
 		d->prev_val[2] = d->val;
+		d->in_nested_ptr = true;
 		oprintf (d->of, "%*s{\n", d->indent, "");
 		d->indent += 2;
 		d->val = xasprintf ("x%d", d->counter++);
@@ -2122,6 +2124,7 @@ walk_type (type_p t, struct walk_type_data *d)
 		oprintf (d->of, ";\n");
 
 		d->process_field (nested_ptr_d->type, d);
+		d->in_nested_ptr = false;
 
 		if (d->fn_wants_lvalue)
 		  {
@@ -2779,7 +2782,14 @@ write_types_local_process_field (type_p f, const struct walk_type_data *d)
     case TYPE_STRING:
       oprintf (d->of, "%*sif ((void *)(%s) == this_obj)\n", d->indent, "",
 	       d->prev_val[3]);
-      oprintf (d->of, "%*s  op (&(%s), cookie);\n", d->indent, "", d->val);
+      /* A pointer converted for a nested_ptr option is stored back
+	 into the field after OP is applied to it.  */
+      if (d->in_nested_ptr)
+	oprintf (d->of, "%*s  op (&(%s), &(%s), cookie);\n", d->indent, "",
+		 d->val, d->prev_val[2]);
+      else
+	oprintf (d->of, "%*s  op (&(%s), NULL, cookie);\n", d->indent, "",
+		 d->val);
       break;
 
     case TYPE_SCALAR:
@@ -57,6 +57,8 @@ bool ggc_protect_identifiers = true;
 static ggc_statistics *ggc_stats;
 
 struct traversal_state;
+struct pch_relocs;
+struct ptr_data;
 
 static int ggc_htab_delete (void **, void *);
 static hashval_t saving_htab_hash (const void *);
@@ -64,9 +66,23 @@ static int saving_htab_eq (const void *, const void *);
 static int call_count (void **, void *);
 static int call_alloc (void **, void *);
 static int compare_ptr_data (const void *, const void *);
-static void relocate_ptrs (void *, void *);
+static void relocate_ptrs (void *, void *, void *);
 static void write_pch_globals (const struct ggc_root_tab * const *tab,
 			       struct traversal_state *state);
+static int compare_relocs (const void *, const void *);
+static void write_pch_relocs (FILE *, struct pch_relocs *);
+static void write_pch_layer_changes (struct traversal_state *, unsigned int,
+				     struct ptr_data **, size_t);
+static void write_pch_reorders (FILE *, struct ptr_data **, size_t);
+static unsigned int pch_layer_of (const void *);
+static ptrdiff_t pch_pointer_bias (const char *);
+static void relocate_pch_globals (const struct ggc_root_tab * const *tab);
+static void relocate_pch (FILE *, char *, ptrdiff_t);
+static void read_pch_layer_changes (FILE *, unsigned int, unsigned int);
+static void keep_pch_pointer (void *, void *, void *);
+static void read_pch_reorders (FILE *, bool);
+static void *map_pch_elsewhere (size_t, int, size_t);
+static void restore_pch_image (FILE *);
 static double ggc_rlimit_bound (double);
 
 /* Maintain global roots that are preserved during GC.  */
@@ -239,10 +255,50 @@ struct ptr_data
   size_t size;
   void *new_addr;
   enum gt_types_enum type;
+  /* The index in pch_layers of the layer the object is in, or
+     n_pch_layers if it is to be written out.  */
+  unsigned int layer;
 };
 
 #define POINTER_HASH(x) (hashval_t)((long)x >> 3)
 
+/* The objects read in from PCH files, in the order they were read.
+   Each PCH file is layered on all those read before it: it holds only
+   the objects that are not in them, and the pages of them that were
+   changed.  A PCH file written after some have been read is likewise
+   layered on them.  */
+
+struct pch_layer
+{
+  /* Where the objects are, and where they were written for.  */
+  char *base;
+  char *preferred_base;
+  size_t size;
+
+  /* A descriptor for the PCH file and the offset of the objects in it,
+     to find the pages that changed when the next layer is written.  */
+  int fd;
+  size_t offset;
+};
+
+static struct pch_layer *pch_layers;
+static unsigned int n_pch_layers;
+
+/* Return the index in pch_layers of the layer OBJ is in, or
+   n_pch_layers if it is in none of them.  */
+
+static unsigned int
+pch_layer_of (const void *obj)
+{
+  unsigned int i;
+
+  for (i = 0; i < n_pch_layers; i++)
+    if ((const char *) obj >= pch_layers[i].base
+	&& (const char *) obj < pch_layers[i].base + pch_layers[i].size)
+      break;
+  return i;
+}
+
 /* Register an object in the hash table.  */
 
 int
@@ -274,6 +330,14 @@ gt_pch_note_object (void *obj, void *note_ptr_cookie,
   else
     (*slot)->size = ggc_get_size (obj);
   (*slot)->type = type;
+
+  /* An object in a layer stays where it is, relative to the layer.  */
+  (*slot)->layer = pch_layer_of (obj);
+  if ((*slot)->layer < n_pch_layers)
+    {
+      struct pch_layer *l = &pch_layers[(*slot)->layer];
+      (*slot)->new_addr = l->preferred_base + ((char *) obj - l->base);
+    }
   return 1;
 }
 
@@ -309,6 +373,16 @@ saving_htab_eq (const void *p1, const void *p2)
   return ((const struct ptr_data *)p1)->obj == p2;
 }
 
+/* The offsets of pointers in the objects written to a PCH file, so
+   that the objects can be read back in at a different address.  */
+
+struct pch_relocs
+{
+  size_t *offsets;
+  size_t count;
+  size_t size;
+};
+
 /* Handy state for the traversal functions.  */
 
 struct traversal_state
@@ -318,6 +392,21 @@ struct traversal_state
   size_t count;
   struct ptr_data **ptrs;
   size_t ptrs_i;
+
+  /* The same for the objects in the layers.  */
+  size_t layer_count;
+  struct ptr_data **layer_ptrs;
+  size_t layer_ptrs_i;
+
+  /* The address the objects are being written for, and the object
+     whose pointers are being relocated, if any.  */
+  char *base;
+  struct ptr_data *current;
+
+  /* The offsets from BASE of the pointers written, separately for
+     those into each layer and, last, for those into the objects
+     written.  */
+  struct pch_relocs *relocs;
 };
 
 /* Callbacks for htab_traverse.  */
@@ -328,6 +417,12 @@ call_count (void **slot, void *state_p)
   struct ptr_data *d = (struct ptr_data *)*slot;
   struct traversal_state *state = (struct traversal_state *)state_p;
 
+  if (d->layer < n_pch_layers)
+    {
+      state->layer_count++;
+      return 1;
+    }
+
   ggc_pch_count_object (state->d, d->obj, d->size,
 			d->note_ptr_fn == gt_pch_p_S,
 			d->type);
@@ -341,6 +436,12 @@ call_alloc (void **slot, void *state_p)
   struct ptr_data *d = (struct ptr_data *)*slot;
   struct traversal_state *state = (struct traversal_state *)state_p;
 
+  if (d->layer < n_pch_layers)
+    {
+      state->layer_ptrs[state->layer_ptrs_i++] = d;
+      return 1;
+    }
+
   d->new_addr = ggc_pch_alloc_object (state->d, d->obj, d->size,
 				      d->note_ptr_fn == gt_pch_p_S,
 				      d->type);
@@ -362,11 +463,10 @@ compare_ptr_data (const void *p1_p, const void *p2_p)
 /* Callbacks for note_ptr_fn.  */
 
 static void
-relocate_ptrs (void *ptr_p, void *state_p)
+relocate_ptrs (void *ptr_p, void *real_ptr_p, void *state_p)
 {
   void **ptr = (void **)ptr_p;
-  struct traversal_state *state ATTRIBUTE_UNUSED
-    = (struct traversal_state *)state_p;
+  struct traversal_state *state = (struct traversal_state *)state_p;
   struct ptr_data *result;
 
   if (*ptr == NULL || *ptr == (void *)1)
@@ -376,6 +476,23 @@ relocate_ptrs (void *ptr_p, void *state_p)
     htab_find_with_hash (saving_htab, *ptr, POINTER_HASH (*ptr));
   gcc_assert (result);
   *ptr = result->new_addr;
+
+  /* Remember where the pointer ends up in the PCH image.  */
+  if (state->current != NULL)
+    {
+      struct pch_relocs *r = &state->relocs[result->layer];
+      size_t offset = ((char *) (real_ptr_p ? real_ptr_p : ptr_p)
+		       - (char *) state->current->obj);
+
+      gcc_assert (offset < state->current->size);
+      if (r->count == r->size)
+	{
+	  r->size = r->size * 2 + 4096;
+	  r->offsets = XRESIZEVEC (size_t, r->offsets, r->size);
+	}
+      r->offsets[r->count++]
+	= (char *) state->current->new_addr + offset - state->base;
+    }
 }
 
 /* Write out, after relocation, the pointers in TAB.  */
@@ -410,6 +527,64 @@ write_pch_globals (const struct ggc_root_tab * const *tab,
 	}
 }
 
+/* Callback for qsort.  */
+
+static int
+compare_relocs (const void *p1_p, const void *p2_p)
+{
+  const size_t r1 = *(const size_t *) p1_p;
+  const size_t r2 = *(const size_t *) p2_p;
+  return (r1 > r2) - (r1 < r2);
+}
+
+/* Describe the relocations that follow the objects in a PCH file.  */
+
+struct reloc_info
+{
+  /* The number of pointers to relocate.  */
+  size_t count;
+  /* The size of their encoding: the distance of each pointer from the
+     previous one, as unsigned LEB128 numbers.  */
+  size_t size;
+};
+
+/* Write out the relocations R to F.  */
+static void
+write_pch_relocs (FILE *f, struct pch_relocs *r)
+{
+  struct reloc_info ri;
+  unsigned char *buf, *p;
+  size_t i, prev;
+
+  qsort (r->offsets, r->count, sizeof (size_t), compare_relocs);
+
+  /* Each number takes at most one byte per seven bits.  */
+  buf = XNEWVEC (unsigned char,
+		 r->count * ((sizeof (size_t) * CHAR_BIT + 6) / 7) + 1);
+  for (i = 0, prev = 0, p = buf; i < r->count; i++)
+    {
+      size_t delta = r->offsets[i] - prev;
+
+      prev = r->offsets[i];
+      do
+	{
+	  *p = delta & 0x7f;
+	  delta >>= 7;
+	  if (delta != 0)
+	    *p |= 0x80;
+	  p++;
+	}
+      while (delta != 0);
+    }
+
+  ri.count = r->count;
+  ri.size = p - buf;
+  if (fwrite (&ri, sizeof (ri), 1, f) != 1
+      || fwrite (buf, 1, ri.size, f) != ri.size)
+    fatal_error ("can't write PCH file: %m");
+  free (buf);
+}
+
 /* Hold the information we need to mmap the file back in.  */
 
 struct mmap_info
@@ -419,6 +594,175 @@ struct mmap_info
   void *preferred_base;
 };
 
+/* Describe the pages of a layer that a PCH file layered on it
+   changed, which follow its relocations in the file: the page numbers
+   first, then their contents, then the relocations for them.  */
+
+struct layer_changes_info
+{
+  size_t count;
+  size_t pagesize;
+};
+
+/* Write out the pages of layer K that hold objects that have changed
+   since it was read in, with their pointers relocated in the same way
+   as those of the objects written, so that the layer need not be
+   written out again.  PTRS are the COUNT objects in the layers that
+   are reachable; pages with none of them in are left alone.  */
+
+static void
+write_pch_layer_changes (struct traversal_state *state, unsigned int k,
+			 struct ptr_data **ptrs, size_t count)
+{
+  struct pch_layer *l = &pch_layers[k];
+  struct layer_changes_info lci;
+  struct pch_relocs *relocs, *saved_relocs;
+  char *saved_base;
+  char *image, *on_disk, *this_object = NULL;
+  size_t this_object_size = 0;
+  unsigned char *page_state;
+  size_t *changed;
+  size_t npages, i, j, p;
+
+  lci.pagesize = getpagesize ();
+  npages = CEIL (l->size, lci.pagesize);
+
+  /* Make a copy of the layer as it would have been written now.  */
+  image = XNEWVEC (char, l->size);
+  memcpy (image, l->base, l->size);
+  page_state = XCNEWVEC (unsigned char, npages);
+  relocs = XCNEWVEC (struct pch_relocs, n_pch_layers + 1);
+
+  saved_relocs = state->relocs;
+  saved_base = state->base;
+  state->relocs = relocs;
+  state->base = l->preferred_base;
+  for (i = 0; i < count; i++)
+    {
+      struct ptr_data *d = ptrs[i];
+      size_t offset = (char *) d->obj - l->base;
+
+      if (d->layer != k)
+	continue;
+
+      if (d->note_ptr_fn != gt_pch_p_S)
+	{
+	  if (this_object_size < d->size)
+	    {
+	      this_object_size = d->size;
+	      this_object = XRESIZEVAR (char, this_object, this_object_size);
+	    }
+	  memcpy (this_object, d->obj, d->size);
+	  if (d->reorder_fn != NULL)
+	    d->reorder_fn (d->obj, d->note_ptr_cookie, relocate_ptrs, state);
+	  state->current = d;
+	  d->note_ptr_fn (d->obj, d->note_ptr_cookie, relocate_ptrs, state);
+	  state->current = NULL;
+	  memcpy (image + offset, d->obj, d->size);
+	  memcpy (d->obj, this_object, d->size);
+	}
+
+      for (p = offset / lci.pagesize;
+	   p <= (offset + d->size - 1) / lci.pagesize;
+	   p++)
+	page_state[p] = 1;
+    }
+  state->relocs = saved_relocs;
+  state->base = saved_base;
+  free (this_object);
+
+  /* Compare the pages that matter with the file.  */
+  on_disk = XNEWVEC (char, lci.pagesize);
+  changed = XNEWVEC (size_t, npages);
+  lci.count = 0;
+  for (p = 0; p < npages; p++)
+    if (page_state[p])
+      {
+	size_t len = MIN (lci.pagesize, l->size - p * lci.pagesize);
+
+	if (lseek (l->fd, l->offset + p * lci.pagesize, SEEK_SET) == -1
+	    || read (l->fd, on_disk, len) != (ssize_t) len)
+	  fatal_error ("can't read PCH file: %m");
+	if (memcmp (on_disk, image + p * lci.pagesize, len) != 0)
+	  {
+	    changed[lci.count++] = p;
+	    page_state[p] = 2;
+	  }
+      }
+  free (on_disk);
+
+  if (fwrite (&lci, sizeof (lci), 1, state->f) != 1
+      || fwrite (changed, sizeof (size_t), lci.count, state->f) != lci.count)
+    fatal_error ("can't write PCH file: %m");
+  for (i = 0; i < lci.count; i++)
+    {
+      size_t len = MIN (lci.pagesize, l->size - changed[i] * lci.pagesize);
+
+      if (fwrite (image + changed[i] * lci.pagesize, len, 1, state->f) != 1)
+	fatal_error ("can't write PCH file: %m");
+    }
+
+  /* The pointers in the other pages are relocated by the layer
+     itself.  */
+  for (i = 0; i <= n_pch_layers; i++)
+    {
+      struct pch_relocs *r = &relocs[i];
+      size_t n = 0;
+
+      for (j = 0; j < r->count; j++)
+	if (page_state[r->offsets[j] / lci.pagesize] == 2)
+	  r->offsets[n++] = r->offsets[j];
+      r->count = n;
+      write_pch_relocs (state->f, r);
+      free (r->offsets);
+    }
+
+  free (relocs);
+  free (changed);
+  free (page_state);
+  free (image);
+}
+
+/* The objects whose pointers are sorted by address, which must be
+   sorted again if the layers move relative to each other.  */
+
+struct pch_reorder
+{
+  void *obj;
+  void *note_ptr_cookie;
+  gt_handle_reorder reorder_fn;
+};
+
+/* Write out those of the COUNT objects PTRS that have a reorder
+   function to F.  */
+static void
+write_pch_reorders (FILE *f, struct ptr_data **ptrs, size_t count)
+{
+  struct pch_reorder r;
+  size_t i, n;
+
+  for (i = 0, n = 0; i < count; i++)
+    if (ptrs[i]->reorder_fn != NULL)
+      n++;
+  if (fwrite (&n, sizeof (n), 1, f) != 1)
+    fatal_error ("can't write PCH file: %m");
+
+  for (i = 0; i < count; i++)
+    if (ptrs[i]->reorder_fn != NULL)
+      {
+	struct ptr_data *cookie = (struct ptr_data *)
+	  htab_find_with_hash (saving_htab, ptrs[i]->note_ptr_cookie,
+			       POINTER_HASH (ptrs[i]->note_ptr_cookie));
+
+	gcc_assert (cookie);
+	r.obj = ptrs[i]->new_addr;
+	r.note_ptr_cookie = cookie->new_addr;
+	r.reorder_fn = ptrs[i]->reorder_fn;
+	if (fwrite (&r, sizeof (r), 1, f) != 1)
+	  fatal_error ("can't write PCH file: %m");
+      }
+}
+
 /* Write out the state of the compiler to F.  */
 
 void
@@ -451,6 +795,7 @@ gt_pch_save (FILE *f)
   state.f = f;
   state.d = init_ggc_pch();
   state.count = 0;
+  state.layer_count = 0;
   htab_traverse (saving_htab, call_count, &state);
 
   mmi.size = ggc_pch_total_size (state.d);
@@ -461,13 +806,46 @@ gt_pch_save (FILE *f)
      (The extra work goes in HOST_HOOKS_GT_PCH_GET_ADDRESS and
      HOST_HOOKS_GT_PCH_USE_ADDRESS.)  */
   mmi.preferred_base = host_hooks.gt_pch_get_address (mmi.size, fileno (f));
+
+  /* The objects can be relocated when they are read, but they cannot
+     start at address zero, since a pointer to the first one would
+     then be taken for a null pointer.  */
+  if (mmi.preferred_base == NULL)
+    mmi.preferred_base = (void *) mmap_offset_alignment;
+
+  /* Nor can they be written for addresses that the objects of a layer
+     were written for, since a pointer to one could then not be told
+     from a pointer to the other.  */
+  for (i = 0; i < n_pch_layers; i++)
+    if ((char *) mmi.preferred_base < pch_layers[i].preferred_base
+				      + pch_layers[i].size
+	&& pch_layers[i].preferred_base
+	   < (char *) mmi.preferred_base + mmi.size)
+      {
+	size_t end = 0, j;
+
+	for (j = 0; j < n_pch_layers; j++)
+	  end = MAX (end, ((size_t) pch_layers[j].preferred_base
+			   + pch_layers[j].size));
+	mmi.preferred_base
+	  = (void *) (CEIL (end, mmap_offset_alignment)
+		      * mmap_offset_alignment);
+	break;
+      }
       
   ggc_pch_this_base (state.d, mmi.preferred_base);
+  state.base = (char *) mmi.preferred_base;
+  state.current = NULL;
+  state.relocs = XCNEWVEC (struct pch_relocs, n_pch_layers + 1);
 
   state.ptrs = XNEWVEC (struct ptr_data *, state.count);
   state.ptrs_i = 0;
+  state.layer_ptrs = XNEWVEC (struct ptr_data *, state.layer_count);
+  state.layer_ptrs_i = 0;
   htab_traverse (saving_htab, call_alloc, &state);
   qsort (state.ptrs, state.count, sizeof (*state.ptrs), compare_ptr_data);
+  qsort (state.layer_ptrs, state.layer_count, sizeof (*state.layer_ptrs),
+	 compare_ptr_data);
 
   /* Write out all the scalar variables.  */
   for (rt = gt_pch_scalar_rtab; *rt; rt++)
@@ -479,6 +857,20 @@ gt_pch_save (FILE *f)
   write_pch_globals (gt_ggc_rtab, &state);
   write_pch_globals (gt_pch_cache_rtab, &state);
 
+  /* Write out which layers the objects are layered on.  */
+  if (fwrite (&n_pch_layers, sizeof (n_pch_layers), 1, f) != 1)
+    fatal_error ("can't write PCH file: %m");
+  for (i = 0; i < n_pch_layers; i++)
+    {
+      struct mmap_info layer_mmi;
+
+      layer_mmi.offset = pch_layers[i].offset;
+      layer_mmi.size = pch_layers[i].size;
+      layer_mmi.preferred_base = pch_layers[i].preferred_base;
+      if (fwrite (&layer_mmi, sizeof (layer_mmi), 1, f) != 1)
+	fatal_error ("can't write PCH file: %m");
+    }
+
   /* Pad the PCH file so that the mmapped area starts on an allocation
      granularity (usually page) boundary.  */
   {
@@ -512,9 +904,13 @@ gt_pch_save (FILE *f)
 	state.ptrs[i]->reorder_fn (state.ptrs[i]->obj,
 				   state.ptrs[i]->note_ptr_cookie,
 				   relocate_ptrs, &state);
+      /* Only the pointers relocated in the object itself are recorded;
+	 the reorder function merely asks for new values.  */
+      state.current = state.ptrs[i];
       state.ptrs[i]->note_ptr_fn (state.ptrs[i]->obj,
 				  state.ptrs[i]->note_ptr_cookie,
 				  relocate_ptrs, &state);
+      state.current = NULL;
       ggc_pch_write_object (state.d, state.f, state.ptrs[i]->obj,
 			    state.ptrs[i]->new_addr, state.ptrs[i]->size,
 			    state.ptrs[i]->note_ptr_fn == gt_pch_p_S);
@@ -522,12 +918,278 @@ gt_pch_save (FILE *f)
 	memcpy (state.ptrs[i]->obj, this_object, state.ptrs[i]->size);
     }
   ggc_pch_finish (state.d, state.f);
+  for (i = 0; i <= n_pch_layers; i++)
+    {
+      write_pch_relocs (state.f, &state.relocs[i]);
+      free (state.relocs[i].offsets);
+    }
+  free (state.relocs);
+
+  for (i = 0; i < n_pch_layers; i++)
+    write_pch_layer_changes (&state, i, state.layer_ptrs, state.layer_count);
+  write_pch_reorders (state.f, state.ptrs, state.count);
+  write_pch_reorders (state.f, state.layer_ptrs, state.layer_count);
+
   gt_pch_fixup_stringpool ();
 
   free (state.ptrs);
+  free (state.layer_ptrs);
   htab_delete (saving_htab);
 }
 
+/* Return the amount by which a pointer P read from a PCH file must be
+   adjusted: the distance of the layer it points into from where that
+   layer was written for.  */
+static ptrdiff_t
+pch_pointer_bias (const char *p)
+{
+  unsigned int i;
+
+  for (i = 0; i < n_pch_layers; i++)
+    if (p >= pch_layers[i].preferred_base
+	&& p < pch_layers[i].preferred_base + pch_layers[i].size)
+      return pch_layers[i].base - pch_layers[i].preferred_base;
+  gcc_unreachable ();
+}
+
+/* Adjust the pointers in TAB, which were read from a PCH file some of
+   whose layers could not be mapped where they were written for.  */
+static void
+relocate_pch_globals (const struct ggc_root_tab * const *tab)
+{
+  const struct ggc_root_tab *const *rt;
+  const struct ggc_root_tab *rti;
+  size_t i;
+
+  for (rt = tab; *rt; rt++)
+    for (rti = *rt; rti->base != NULL; rti++)
+      for (i = 0; i < rti->nelt; i++)
+	{
+	  char **ptr = (char **)((char *)rti->base + rti->stride * i);
+	  if (*ptr != NULL && *ptr != (char *)1)
+	    *ptr += pch_pointer_bias (*ptr);
+	}
+}
+
+/* Read the relocations written by write_pch_relocs from F, and if BIAS
+   is not zero, add it to each pointer in the objects mapped at BASE.  */
+static void
+relocate_pch (FILE *f, char *base, ptrdiff_t bias)
+{
+  struct reloc_info ri;
+  unsigned char *buf, *p, *end;
+  size_t i, offset;
+
+  if (fread (&ri, sizeof (ri), 1, f) != 1)
+    fatal_error ("can't read PCH file: %m");
+
+  if (bias == 0)
+    {
+      if (fseek (f, ri.size, SEEK_CUR) != 0)
+	fatal_error ("can't read PCH file: %m");
+      return;
+    }
+
+  buf = XNEWVEC (unsigned char, ri.size);
+  if (fread (buf, 1, ri.size, f) != ri.size)
+    fatal_error ("can't read PCH file: %m");
+
+  for (i = 0, offset = 0, p = buf, end = buf + ri.size; i < ri.count; i++)
+    {
+      size_t delta = 0;
+      int shift = 0;
+
+      do
+	{
+	  gcc_assert (p < end);
+	  delta |= (size_t) (*p & 0x7f) << shift;
+	  shift += 7;
+	}
+      while (*p++ & 0x80);
+      offset += delta;
+      *(char **) (base + offset) += bias;
+    }
+
+  free (buf);
+}
+
+/* Read the pages of layer K written by write_pch_layer_changes from F,
+   for a PCH file that is layer N, and put them in place.  */
+static void
+read_pch_layer_changes (FILE *f, unsigned int k, unsigned int n)
+{
+  struct pch_layer *l = &pch_layers[k];
+  struct layer_changes_info lci;
+  size_t *changed;
+  size_t i;
+
+  if (fread (&lci, sizeof (lci), 1, f) != 1)
+    fatal_error ("can't read PCH file: %m");
+  changed = XNEWVEC (size_t, lci.count);
+  if (fread (changed, sizeof (size_t), lci.count, f) != lci.count)
+    fatal_error ("can't read PCH file: %m");
+  for (i = 0; i < lci.count; i++)
+    {
+      size_t len = MIN (lci.pagesize, l->size - changed[i] * lci.pagesize);
+
+      if (fread (l->base + changed[i] * lci.pagesize, len, 1, f) != 1)
+	fatal_error ("can't read PCH file: %m");
+    }
+  free (changed);
+
+  for (i = 0; i <= n; i++)
+    relocate_pch (f, l->base, pch_layers[i].base - pch_layers[i].preferred_base);
+}
+
+/* The pointer operator for reorder functions once the pointers are
+   where they belong.  */
+static void
+keep_pch_pointer (void *ptr ATTRIBUTE_UNUSED, void *real_ptr ATTRIBUTE_UNUSED,
+		  void *cookie ATTRIBUTE_UNUSED)
+{
+}
+
+/* Read the objects written by write_pch_reorders from F, and if RESORT,
+   sort their pointers again.  */
+static void
+read_pch_reorders (FILE *f, bool resort)
+{
+  struct pch_reorder r;
+  size_t n, i;
+
+  if (fread (&n, sizeof (n), 1, f) != 1)
+    fatal_error ("can't read PCH file: %m");
+  if (!resort)
+    {
+      if (fseek (f, n * sizeof (r), SEEK_CUR) != 0)
+	fatal_error ("can't read PCH file: %m");
+      return;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      char *obj, *cookie;
+
+      if (fread (&r, sizeof (r), 1, f) != 1)
+	fatal_error ("can't read PCH file: %m");
+      obj = (char *) r.obj;
+      cookie = (char *) r.note_ptr_cookie;
+      r.reorder_fn (obj + pch_pointer_bias (obj),
+		    cookie + pch_pointer_bias (cookie),
+		    keep_pch_pointer, NULL);
+    }
+}
+
+/* Map SIZE bytes of FD at OFFSET wherever there is room, for a PCH file
+   that could not be loaded at the address it was written for.  Return
+   the address, or NULL if that is not possible.  The mapping is
+   private, so pages that need no relocation stay shared with other
+   processes using the same file.  */
+static void *
+map_pch_elsewhere (size_t size ATTRIBUTE_UNUSED, int fd ATTRIBUTE_UNUSED,
+		   size_t offset ATTRIBUTE_UNUSED)
+{
+#if HAVE_MMAP_FILE
+  void *addr;
+
+  addr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, offset);
+  if (addr != (void *) MAP_FAILED)
+    return addr;
+#endif
+  return NULL;
+}
+
+/* Read in the objects saved by gt_pch_save from F, which is positioned
+   just after the global pointers, as a new layer.  */
+
+static void
+restore_pch_image (FILE *f)
+{
+  unsigned int n, i;
+  struct mmap_info mmi;
+  int result;
+  char *base;
+  struct pch_layer *l;
+  bool resort;
+
+  /* Check that the layers it is layered on are the ones read in.  */
+  if (fread (&n, sizeof (n), 1, f) != 1)
+    fatal_error ("can't read PCH file: %m");
+  if (n != n_pch_layers)
+    fatal_error ("PCH file was layered on different PCH files");
+  for (i = 0; i < n; i++)
+    {
+      if (fread (&mmi, sizeof (mmi), 1, f) != 1)
+	fatal_error ("can't read PCH file: %m");
+      if ((char *) mmi.preferred_base != pch_layers[i].preferred_base
+	  || mmi.size != pch_layers[i].size)
+	fatal_error ("PCH file was layered on different PCH files");
+    }
+
+  if (fread (&mmi, sizeof (mmi), 1, f) != 1)
+    fatal_error ("can't read PCH file: %m");
+
+  base = (char *) mmi.preferred_base;
+  result = host_hooks.gt_pch_use_address (base, mmi.size,
+					  fileno (f), mmi.offset);
+
+  /* If the layer below had to be moved, this one probably has to be
+     moved by the same amount.  */
+  if (result < 0
+      && n > 0
+      && pch_layers[n - 1].base != pch_layers[n - 1].preferred_base)
+    {
+      base = ((char *) mmi.preferred_base
+	      + (pch_layers[n - 1].base - pch_layers[n - 1].preferred_base));
+      result = host_hooks.gt_pch_use_address (base, mmi.size,
+					      fileno (f), mmi.offset);
+    }
+  if (result < 0)
+    {
+      /* The space is taken; put the objects somewhere else, and
+	 relocate them below.  */
+      base = (char *) map_pch_elsewhere (mmi.size, fileno (f), mmi.offset);
+      if (base == NULL)
+	fatal_error ("had to relocate PCH");
+      result = 1;
+    }
+  if (result == 0)
+    {
+      if (fseek (f, mmi.offset, SEEK_SET) != 0
+	  || fread (base, mmi.size, 1, f) != 1)
+	fatal_error ("can't read PCH file: %m");
+    }
+  else if (fseek (f, mmi.offset + mmi.size, SEEK_SET) != 0)
+    fatal_error ("can't read PCH file: %m");
+
+  pch_layers = XRESIZEVEC (struct pch_layer, pch_layers, n + 1);
+  l = &pch_layers[n];
+  l->base = base;
+  l->preferred_base = (char *) mmi.preferred_base;
+  l->size = mmi.size;
+  l->fd = dup (fileno (f));
+  l->offset = mmi.offset;
+  n_pch_layers = n + 1;
+
+  ggc_pch_read (f, base);
+
+  for (i = 0; i <= n; i++)
+    relocate_pch (f, base, pch_layers[i].base - pch_layers[i].preferred_base);
+  for (i = 0; i < n; i++)
+    read_pch_layer_changes (f, i, n);
+
+  /* Pointers in some objects are sorted by address (see
+     gt_pch_note_reorder); if the layers did not all move by the same
+     amount, the order may have changed.  */
+  resort = false;
+  for (i = 0; i < n; i++)
+    if (pch_layers[i].base - pch_layers[i].preferred_base
+	!= base - l->preferred_base)
+      resort = true;
+  read_pch_reorders (f, resort);
+  read_pch_reorders (f, resort);
+}
+
 /* Read the state of the compiler back in from F.  */
 
 void
@@ -536,8 +1198,6 @@ gt_pch_restore (FILE *f)
   const struct ggc_root_tab *const *rt;
   const struct ggc_root_tab *rti;
   size_t i;
-  struct mmap_info mmi;
-  int result;
 
   /* Delete any deletable objects.  This makes ggc_pch_read much
      faster, as it can be sure that no GCable objects remain other
@@ -567,27 +1227,50 @@ gt_pch_restore (FILE *f)
 		   sizeof (void *), 1, f) != 1)
 	  fatal_error ("can't read PCH file: %m");
 
-  if (fread (&mmi, sizeof (mmi), 1, f) != 1)
-    fatal_error ("can't read PCH file: %m");
-
-  result = host_hooks.gt_pch_use_address (mmi.preferred_base, mmi.size,
-					  fileno (f), mmi.offset);
-  if (result < 0)
-    fatal_error ("had to relocate PCH");
-  if (result == 0)
-    {
-      if (fseek (f, mmi.offset, SEEK_SET) != 0
-	  || fread (mmi.preferred_base, mmi.size, 1, f) != 1)
-	fatal_error ("can't read PCH file: %m");
-    }
-  else if (fseek (f, mmi.offset + mmi.size, SEEK_SET) != 0)
-    fatal_error ("can't read PCH file: %m");
+  restore_pch_image (f);
 
-  ggc_pch_read (f, mmi.preferred_base);
+  for (i = 0; i < n_pch_layers; i++)
+    if (pch_layers[i].base != pch_layers[i].preferred_base)
+      {
+	relocate_pch_globals (gt_ggc_rtab);
+	relocate_pch_globals (gt_pch_cache_rtab);
+	break;
+      }
 
   gt_pch_restore_stringpool ();
 }
 
+/* Read the objects saved in F, but not the global pointers, which
+   come from the PCH file layered on F.  */
+
+void
+gt_pch_restore_layer (FILE *f)
+{
+  const struct ggc_root_tab *const *rt;
+  const struct ggc_root_tab *rti;
+  long skip = 0;
+
+  /* Delete any deletable objects, as in gt_pch_restore.  */
+  for (rt = gt_ggc_deletable_rtab; *rt; rt++)
+    for (rti = *rt; rti->base != NULL; rti++)
+      memset (rti->base, 0, rti->stride);
+
+  /* Skip the scalar variables and the global pointers.  */
+  for (rt = gt_pch_scalar_rtab; *rt; rt++)
+    for (rti = *rt; rti->base != NULL; rti++)
+      skip += rti->stride;
+  for (rt = gt_ggc_rtab; *rt; rt++)
+    for (rti = *rt; rti->base != NULL; rti++)
+      skip += rti->nelt * sizeof (void *);
+  for (rt = gt_pch_cache_rtab; *rt; rt++)
+    for (rti = *rt; rti->base != NULL; rti++)
+      skip += rti->nelt * sizeof (void *);
+  if (fseek (f, skip, SEEK_CUR) != 0)
+    fatal_error ("can't read PCH file: %m");
+
+  restore_pch_image (f);
+}
+
 /* Default version of HOST_HOOKS_GT_PCH_GET_ADDRESS when mmap is not present.
    Select no address whatsoever, and let gt_pch_save choose what it will with
    malloc, presumably.  */
@@ -665,7 +1348,11 @@ mmap_gt_pch_use_address (void *base, size_t size, int fd, size_t offset)
   addr = mmap ((caddr_t) base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
 	       fd, offset);
 
-  return addr == base ? 1 : -1;
+  if (addr == base)
+    return 1;
+  if (addr != (void *) MAP_FAILED)
+    munmap ((caddr_t) addr, size);
+  return -1;
 }
 #endif /* HAVE_MMAP_FILE */
 
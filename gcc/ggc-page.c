@@ -463,6 +463,17 @@ static struct globals
 # endif
 #endif
 
+/* With --param ggc-huge-pages, single pages are carved out of chunks
+   of this size instead, which the kernel can back with transparent
+   huge pages.  All the pages of a chunk start out with the order they
+   were allocated for.  */
+#define GGC_HUGE_PAGE_SIZE ((size_t) 2 * 1024 * 1024)
+
+/* How many entries of the free page list alloc_page looks at for a page
+   of the right order, with --param ggc-huge-pages, once it has found
+   one of the right size.  */
+#define GGC_FREE_PAGE_SCAN 64
+
 /* Initial guess as to how many page table entries we might need.  */
 #define INITIAL_PTE_COUNT 128
 
@@ -486,6 +497,12 @@ static void ggc_recalculate_in_use_p (page_entry *);
 static void compute_inverse (unsigned);
 static inline void adjust_depth (void);
 static void move_ptes_to_front (int, int);
+#ifdef USING_MMAP
+static int compare_page_addresses (const void *, const void *);
+static inline bool huge_pages_p (void);
+static char *alloc_huge_chunk (void);
+static void release_free_page_runs (void);
+#endif
 
 void debug_print_page_list (int);
 static void push_depth (unsigned int);
@@ -676,6 +693,52 @@ alloc_anon (char *pref ATTRIBUTE_UNUSED, size_t size)
 
   return page;
 }
+
+/* Allocate a chunk of GGC_HUGE_PAGE_SIZE bytes of anonymous memory,
+   aligned to its size so that the kernel can back it with a single
+   transparent huge page.  */
+
+static char *
+alloc_huge_chunk (void)
+{
+  size_t size = GGC_HUGE_PAGE_SIZE;
+  char *allocation = alloc_anon (NULL, 2 * size);
+  char *chunk = (char *) (((size_t) allocation + size - 1) & -size);
+
+  /* Give back the slop on either side.  */
+  if (chunk != allocation)
+    munmap (allocation, chunk - allocation);
+  if (chunk + size != allocation + 2 * size)
+    munmap (chunk + size, allocation + size - chunk);
+  G.bytes_mapped -= size;
+
+#ifdef MADV_HUGEPAGE
+  madvise (chunk, size, MADV_HUGEPAGE);
+#endif
+
+  return chunk;
+}
+
+/* Return true if pages are to be carved out of huge chunks.  */
+
+static inline bool
+huge_pages_p (void)
+{
+  /* The first pages are allocated before the parameters are set up.  */
+  return compiler_params != NULL && PARAM_VALUE (GGC_HUGE_PAGES) != 0;
+}
+
+/* Compare the addresses of the pages of two page entries, for
+   qsort.  */
+
+static int
+compare_page_addresses (const void *a, const void *b)
+{
+  const page_entry *const pa = *(const page_entry *const *) a;
+  const page_entry *const pb = *(const page_entry *const *) b;
+
+  return pa->page < pb->page ? -1 : pa->page > pb->page;
+}
 #endif
 #ifdef USING_MALLOC_PAGE_GROUPS
 /* Compute the index for this page into the page group.  */
@@ -714,6 +777,11 @@ alloc_page (unsigned order)
   size_t bitmap_size;
   size_t page_entry_size;
   size_t entry_size;
+#ifdef USING_MMAP
+  bool huge = huge_pages_p ();
+  struct page_entry **fallback = NULL;
+  int scan = 0;
+#endif
 #ifdef USING_MALLOC_PAGE_GROUPS
   page_group *group;
 #endif
@@ -731,7 +799,30 @@ alloc_page (unsigned order)
   /* Check the list of free pages for one we can use.  */
   for (pp = &G.free_pages, p = *pp; p; pp = &p->next, p = *pp)
     if (p->bytes == entry_size)
-      break;
+      {
+#ifdef USING_MMAP
+	/* With huge pages, keep objects of one size together by
+	   looking a little further for a page that was carved out for
+	   this order.  */
+	if (huge && p->order != order)
+	  {
+	    if (fallback == NULL)
+	      fallback = pp;
+	    if (++scan < GGC_FREE_PAGE_SCAN)
+	      continue;
+	    pp = fallback;
+	    p = *pp;
+	  }
+#endif
+	break;
+      }
+#ifdef USING_MMAP
+  if (p == NULL && fallback != NULL)
+    {
+      pp = fallback;
+      p = *pp;
+    }
+#endif
 
   if (p != NULL)
     {
@@ -759,13 +850,19 @@ alloc_page (unsigned order)
 	 extras on the freelist.  (Can only do this optimization with
 	 mmap for backing store.)  */
       struct page_entry *e, *f = G.free_pages;
-      int i;
+      int i, quire = GGC_QUIRE_SIZE;
 
-      page = alloc_anon (NULL, G.pagesize * GGC_QUIRE_SIZE);
+      if (huge)
+	{
+	  page = alloc_huge_chunk ();
+	  quire = GGC_HUGE_PAGE_SIZE >> G.lg_pagesize;
+	}
+      else
+	page = alloc_anon (NULL, G.pagesize * GGC_QUIRE_SIZE);
 
       /* This loop counts down so that the chain will be in ascending
 	 memory order.  */
-      for (i = GGC_QUIRE_SIZE - 1; i >= 1; i--)
+      for (i = quire - 1; i >= 1; i--)
 	{
 	  e = XCNEWVAR (struct page_entry, page_entry_size);
 	  e->order = order;
@@ -946,6 +1043,83 @@ free_page (page_entry *entry)
   G.free_pages = entry;
 }
 
+#ifdef USING_MMAP
+/* Release the free page cache to the system the way release_pages
+   does with --param ggc-huge-pages.  Unmapping a part of a huge page
+   splits it, and unmapping every run of free pages at each collection
+   takes many system calls, so only the whole chunks that are free are
+   unmapped, unless the cache holds more than a quarter of the memory
+   mapped; then it is released in bulk.  The pages that stay are kept
+   in ascending order.  */
+
+static void
+release_free_page_runs (void)
+{
+  page_entry *p, **pages, **tail;
+  size_t i, j, k, n = 0, free_bytes = 0;
+  bool bulk;
+
+  for (p = G.free_pages; p; p = p->next)
+    {
+      n++;
+      free_bytes += p->bytes;
+    }
+  if (n == 0)
+    return;
+  bulk = free_bytes > G.bytes_mapped / 4;
+
+  pages = XNEWVEC (page_entry *, n);
+  for (i = 0, p = G.free_pages; p; p = p->next)
+    pages[i++] = p;
+  qsort (pages, n, sizeof (page_entry *), compare_page_addresses);
+
+  tail = &G.free_pages;
+  for (i = 0; i < n; i = j)
+    {
+      char *start = pages[i]->page, *end = start + pages[i]->bytes;
+      char *lo, *hi;
+
+      for (j = i + 1; j < n && pages[j]->page == end; j++)
+	end += pages[j]->bytes;
+
+      if (bulk)
+	lo = start, hi = end;
+      else
+	{
+	  lo = (char *) (((size_t) start + GGC_HUGE_PAGE_SIZE - 1)
+			 & -GGC_HUGE_PAGE_SIZE);
+	  hi = (char *) ((size_t) end & -GGC_HUGE_PAGE_SIZE);
+
+	  /* Do not cut through the pages of a large object.  */
+	  for (k = i; k < j && pages[k]->page < lo; k++)
+	    ;
+	  lo = k < j ? pages[k]->page : end;
+	  for (k = j; k > i && pages[k - 1]->page + pages[k - 1]->bytes > hi;
+	       k--)
+	    ;
+	  hi = k > i ? pages[k - 1]->page + pages[k - 1]->bytes : start;
+	}
+      if (lo < hi)
+	{
+	  munmap (lo, hi - lo);
+	  G.bytes_mapped -= hi - lo;
+	}
+
+      for (; i < j; i++)
+	if (pages[i]->page >= lo && pages[i]->page + pages[i]->bytes <= hi)
+	  free (pages[i]);
+	else
+	  {
+	    *tail = pages[i];
+	    tail = &pages[i]->next;
+	  }
+    }
+  *tail = NULL;
+
+  free (pages);
+}
+#endif
+
 /* Release the free page cache to the system.  */
 
 static void
@@ -956,6 +1130,12 @@ release_pages (void)
   char *start;
   size_t len;
 
+  if (huge_pages_p ())
+    {
+      release_free_page_runs ();
+      return;
+    }
+
   /* Gather up adjacent pages so they are unmapped together.  */
   p = G.free_pages;
 
@@ -1917,6 +2097,8 @@ ggc_collect (void)
 
   float min_expand = allocated_last_gc * PARAM_VALUE (GGC_MIN_EXPAND) / 100;
 
+  size_t allocated_before;
+
   if (G.allocated < allocated_last_gc + min_expand && !ggc_force_collect)
     return;
 
@@ -1928,6 +2110,7 @@ ggc_collect (void)
 
   /* Zero the total allocated bytes.  This will be recalculated in the
      sweep phase.  */
+  allocated_before = G.allocated;
   G.allocated = 0;
 
   /* Release the pages we freed the last time we collected, but didn't
@@ -1950,6 +2133,11 @@ ggc_collect (void)
 
   timevar_pop (TV_GC);
 
+  /* Credit what was released to the phase that asked for the
+     collection rather than to TV_GC.  */
+  if (allocated_before > G.allocated)
+    timevar_ggc_freed_total += allocated_before - G.allocated;
+
   if (!quiet_flag)
     fprintf (stderr, "%luk}", (unsigned long) G.allocated / 1024);
   if (GGC_DEBUG_LEVEL >= 2)
@@ -2255,10 +2443,15 @@ move_ptes_to_front (int count_old_page_tables, int count_new_page_tables)
 
   /* And last, we update the depth pointers in G.depth.  The first
      entry is already 0, and context 0 entries always start at index
-     0, so there is nothing to update in the first slot.  We need a
-     second slot, only if we have old ptes, and if we do, they start
-     at index count_new_page_tables.  */
-  if (count_old_page_tables)
+     0, so there is nothing to update in the first slot.  If there is
+     a second slot already, the pages of an earlier PCH file were put
+     in front of it, and so must the new ones be.  Otherwise we need a
+     second slot, only if we have old ptes in context 1, and if we do,
+     they start at index count_new_page_tables.  */
+  if (G.depth_in_use > 1)
+    G.depth[1] += count_new_page_tables;
+  else if (count_old_page_tables
+	   && G.by_depth[G.by_depth_in_use - 1]->context_depth != 0)
     push_depth (count_new_page_tables);
 }
 
@@ -2270,6 +2463,7 @@ ggc_pch_read (FILE *f, void *addr)
   char *offs = (char *) addr;
   unsigned long count_old_page_tables;
   unsigned long count_new_page_tables;
+  size_t pch_bytes = 0;
 
   count_old_page_tables = G.by_depth_in_use;
 
@@ -2285,14 +2479,32 @@ ggc_pch_read (FILE *f, void *addr)
 
   /* No object read from a PCH file should ever be freed.  So, set the
      context depth to 1, and set the depth of all the currently-allocated
-     pages to be 1 too.  PCH pages will have depth 0.  */
-  gcc_assert (!G.context_depth);
-  G.context_depth = 1;
-  for (i = 0; i < NUM_ORDERS; i++)
+     pages to be 1 too.  PCH pages will have depth 0.  If this PCH file
+     is layered on others read earlier, their pages already have depth
+     0; those objects stay allocated.  */
+  if (G.context_depth == 0)
     {
-      page_entry *p;
-      for (p = G.pages[i]; p != NULL; p = p->next)
-	p->context_depth = G.context_depth;
+      G.context_depth = 1;
+      for (i = 0; i < NUM_ORDERS; i++)
+	{
+	  page_entry *p;
+	  for (p = G.pages[i]; p != NULL; p = p->next)
+	    p->context_depth = G.context_depth;
+	}
+    }
+  else
+    {
+      gcc_assert (G.context_depth == 1);
+      for (i = 0; i < NUM_ORDERS; i++)
+	{
+	  page_entry *p;
+	  for (p = G.pages[i]; p != NULL; p = p->next)
+	    if (p->context_depth == 0)
+	      {
+		ggc_recalculate_in_use_p (p);
+		pch_bytes += p->bytes;
+	      }
+	}
     }
 
   /* Allocate the appropriate page-table entries for the pages read from
@@ -2356,5 +2568,5 @@ ggc_pch_read (FILE *f, void *addr)
   move_ptes_to_front (count_old_page_tables, count_new_page_tables);
 
   /* Update the statistics.  */
-  G.allocated = G.allocated_last_gc = offs - (char *)addr;
+  G.allocated = G.allocated_last_gc = pch_bytes + (offs - (char *)addr);
 }
@@ -2004,6 +2004,7 @@ ggc_collect (void)
 {
   struct alloc_zone *zone;
   bool marked = false;
+  size_t allocated_before = 0, allocated_after = 0;
 
   timevar_push (TV_GC);
 
@@ -2029,6 +2030,9 @@ ggc_collect (void)
 	}
     }
 
+  for (zone = G.zones; zone; zone = zone->next_zone)
+    allocated_before += zone->allocated;
+
   /* Start by possibly collecting the main zone.  */
   main_zone.was_collected = false;
   marked |= ggc_collect_1 (&main_zone, true);
@@ -2094,6 +2098,13 @@ ggc_collect (void)
     }
 
   timevar_pop (TV_GC);
+
+  /* Credit what was released to the phase that asked for the
+     collection rather than to TV_GC.  */
+  for (zone = G.zones; zone; zone = zone->next_zone)
+    allocated_after += zone->allocated;
+  if (allocated_before > allocated_after)
+    timevar_ggc_freed_total += allocated_before - allocated_after;
 }
 
 /* Print allocation statistics.  */
@@ -2467,6 +2478,11 @@ ggc_pch_read (FILE *f, void *addr)
   struct page_entry *pch_page;
   char *p;
 
+  /* There is only one PCH zone, so a PCH file can't be layered on
+     another.  */
+  if (pch_zone.bytes)
+    fatal_error ("can't read PCH file: layered PCH files are not supported");
+
   if (fread (&d, sizeof (d), 1, f) != 1)
     fatal_error ("can't read PCH file: %m");
 
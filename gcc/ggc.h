@@ -33,8 +33,10 @@ extern const char digit_vector[];	/* "0" .. "9" */
 /* Internal functions and data structures used by the GTY
    machinery.  */
 
-/* The first parameter is a pointer to a pointer, the second a cookie.  */
-typedef void (*gt_pointer_operator) (void *, void *);
+/* The first parameter is a pointer to a pointer, the second the
+   location the pointer is stored back into afterwards, or NULL if that
+   is the first parameter, and the third a cookie.  */
+typedef void (*gt_pointer_operator) (void *, void *, void *);
 
 #include "gtype-desc.h"
 
@@ -251,6 +253,9 @@ extern void dump_ggc_loc_statistics (bool);
 #define htab_create_ggc(SIZE, HASH, EQ, DEL) \
   htab_create_alloc (SIZE, HASH, EQ, DEL, ggc_calloc, ggc_free)
 
+#define htab_create_grouped_ggc(SIZE, HASH, EQ, DEL) \
+  htab_create_grouped_alloc (SIZE, HASH, EQ, DEL, ggc_calloc, ggc_free)
+
 #define splay_tree_new_ggc(COMPARE)					 \
   splay_tree_new_with_allocator (COMPARE, NULL, NULL,			 \
                                  &ggc_splay_alloc, &ggc_splay_dont_free, \
@@ -278,6 +283,11 @@ extern void gt_pch_save (FILE *f);
 
 /* Read objects previously saved with gt_pch_save from F.  */
 extern void gt_pch_restore (FILE *f);
+
+/* Read the objects saved with gt_pch_save in F, but not the global
+   pointers to them, because the PCH file about to be restored is
+   layered on F.  */
+extern void gt_pch_restore_layer (FILE *f);
 
 /* Statistics.  */
 
@@ -271,6 +271,14 @@ struct lang_hooks
      immediately and the finish hook is not called.  */
   bool (*post_options) (const char **);
 
+  /* Called instead in a compile server (-server), once a file to
+     compile has been sent to it, to start reading the file, after
+     post_options and init have been called without it.  Sets the
+     original filename as post_options does, and returns false if the
+     file cannot be read.  NULL if the front end does not support
+     -server.  */
+  bool (*read_main_file) (const char **);
+
   /* Called after post_options to initialize the front end.  Return
      false to indicate that no further compilation be performed, in
      which case the finish hook is called immediately.  */
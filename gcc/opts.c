@@ -771,6 +771,78 @@ handle_options (unsigned int argc, const char **argv, unsigned int lang_mask)
     }
 }
 
+/* The languages whose options the front end accepts, from its
+   init_options hook.  */
+static unsigned int initial_lang_mask;
+
+/* Decode the ARGC arguments ARGV sent to a compile server with a file
+   to compile: the file name, the options that name the files made
+   from it, and the options for the dependencies written for it.  Those
+   are the only options that can be changed once the compiler has been
+   initialized.  ARGV[ARGC] must be NULL.  Return false, after an
+   error, if anything else is sent.  */
+bool
+decode_server_request (unsigned int argc, const char **argv)
+{
+  unsigned int i, n;
+
+  main_input_filename = NULL;
+  num_in_fnames = 0;
+
+  for (i = 0; i < argc; i += n)
+    {
+      const char *opt = argv[i];
+      size_t opt_index;
+
+      if (opt[0] != '-')
+	{
+	  if (main_input_filename != NULL)
+	    {
+	      error ("only one file can be compiled at a time with -server");
+	      return false;
+	    }
+	  main_input_filename = opt;
+	  main_input_baselength
+	    = base_of_path (main_input_filename, &main_input_basename);
+	  add_input_filename (opt);
+	  n = 1;
+	  continue;
+	}
+
+      opt_index = find_opt (opt + 1, initial_lang_mask | CL_COMMON);
+      if (opt_index != OPT_o
+	  && opt_index != OPT_dumpbase
+	  && opt_index != OPT_auxbase
+	  && opt_index != OPT_auxbase_strip
+	  && opt_index != OPT_MD
+	  && opt_index != OPT_MMD
+	  && opt_index != OPT_MF
+	  && opt_index != OPT_MG
+	  && opt_index != OPT_MP
+	  && opt_index != OPT_MQ
+	  && opt_index != OPT_MT)
+	{
+	  error ("%qs cannot be sent to a compile server", opt);
+	  return false;
+	}
+
+      /* The front end has finished with its options by now, so only
+	 the common handling of the common ones is wanted.  It sets up
+	 the dependencies as it reads the file.  */
+      n = handle_option (argv + i, (cl_options[opt_index].flags & CL_COMMON
+				    ? 0 : initial_lang_mask));
+      if (!n)
+	return false;
+    }
+
+  if (main_input_filename == NULL)
+    {
+      error ("no input file sent to the compile server");
+      return false;
+    }
+  return true;
+}
+
 /* Parse command line options and set default flag values.  Do minimal
    options processing.  */
 void
@@ -782,7 +854,6 @@ decode_options (unsigned int argc, const char **argv)
   static int initial_min_crossjump_insns;
   static int initial_max_fields_for_field_sensitive;
   static int initial_loop_invariant_max_bbs_in_loop;
-  static unsigned int initial_lang_mask;
 
   unsigned int i, lang_mask;
   int opt1;
@@ -1947,6 +2018,10 @@ common_handle_option (size_t scode, const char *arg, int value,
       vect_set_verbosity_level (arg);
       break;
 
+    case OPT_ftime_report_json_:
+      time_report_json_file = arg;
+      break;
+
     case OPT_ftls_model_:
       if (!strcmp (arg, "global-dynamic"))
 	flag_tls_default = TLS_MODEL_GLOBAL_DYNAMIC;
@@ -31,6 +31,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "intl.h"
 #include "rtl.h"
 #include "toplev.h"
+#include "obstack.h"
 
 #ifndef HAVE_CLOCK_T
 typedef int clock_t;
@@ -118,11 +119,25 @@ bool timevar_enable;
 
 size_t timevar_ggc_mem_total;
 
+/* Total amount of memory released by garbage collections.  */
+
+size_t timevar_ggc_freed_total;
+
+/* Memory currently held by alloc-pool blocks and by the chunks of
+   bitmap obstacks.  */
+
+HOST_WIDE_INT timevar_pool_mem_total;
+HOST_WIDE_INT timevar_obstack_mem_total;
+
 /* The amount of memory that will cause us to report the timevar even
    if the time spent is not significant.  */
 
 #define GGC_MEM_BOUND (1 << 20)
 
+/* Likewise for the memory usage table, in kilobytes.  */
+
+#define MEM_KB_BOUND 256
+
 /* See timevar.h for an explanation of timing variables.  */
 
 /* A timing variable.  */
@@ -180,6 +195,10 @@ static void get_time (struct timevar_time_def *);
 static void timevar_accumulate (struct timevar_time_def *,
 				struct timevar_time_def *,
 				struct timevar_time_def *);
+static void timevar_update (void);
+static void print_json_string (FILE *, const char *);
+static void print_json_entry (FILE *, const char *,
+			      struct timevar_time_def *);
 
 /* Fill the current times into TIME.  The definition of this function
    also defines any or all of the HAVE_USER_TIME, HAVE_SYS_TIME, and
@@ -192,10 +211,23 @@ get_time (struct timevar_time_def *now)
   now->sys  = 0;
   now->wall = 0;
   now->ggc_mem = timevar_ggc_mem_total;
+  now->ggc_freed = timevar_ggc_freed_total;
+  now->pool_mem = timevar_pool_mem_total;
+  now->obstack_mem = timevar_obstack_mem_total;
+  now->rss = 0;
+  now->rss_peak = 0;
 
   if (!timevar_enable)
     return;
 
+#ifdef HAVE_GETRUSAGE
+  {
+    struct rusage rusage;
+    getrusage (RUSAGE_SELF, &rusage);
+    now->rss = now->rss_peak = rusage.ru_maxrss;
+  }
+#endif
+
   {
 #ifdef USE_TIMES
     struct tms tms;
@@ -226,6 +258,32 @@ timevar_accumulate (struct timevar_time_def *timer,
   timer->sys += stop_time->sys - start_time->sys;
   timer->wall += stop_time->wall - start_time->wall;
   timer->ggc_mem += stop_time->ggc_mem - start_time->ggc_mem;
+  timer->ggc_freed += stop_time->ggc_freed - start_time->ggc_freed;
+  timer->pool_mem += stop_time->pool_mem - start_time->pool_mem;
+  timer->obstack_mem += stop_time->obstack_mem - start_time->obstack_mem;
+  timer->rss += stop_time->rss - start_time->rss;
+  if (timer->rss_peak < stop_time->rss_peak)
+    timer->rss_peak = stop_time->rss_peak;
+}
+
+/* Allocate and free obstack chunks, keeping track of the memory held
+   so it can be attributed to the running timing variable.  An obstack
+   is counted if it is created with these as its chunk functions.  */
+
+void *
+timevar_obstack_chunk_alloc (long size)
+{
+  timevar_obstack_mem_total += size;
+  return xmalloc (size);
+}
+
+void
+timevar_obstack_chunk_free (void *p)
+{
+  struct _obstack_chunk *chunk = (struct _obstack_chunk *) p;
+
+  timevar_obstack_mem_total -= chunk->limit - (char *) chunk;
+  free (chunk);
 }
 
 /* Initialize timing variables.  */
@@ -375,6 +433,28 @@ timevar_stop (timevar_id_t timevar)
   timevar_accumulate (&tv->elapsed, &tv->start_time, &now);
 }
 
+/* Attribute the time elapsed since the last push or pop to the
+   topmost element of the timing stack, so that the elapsed times can
+   be reported.  */
+
+static void
+timevar_update (void)
+{
+  struct timevar_time_def now;
+
+  /* What time is it?  */
+  get_time (&now);
+
+  /* If the stack isn't empty, attribute the current elapsed time to
+     the old topmost element.  */
+  if (stack)
+    timevar_accumulate (&stack->timevar->elapsed, &start_time, &now);
+
+  /* Reset the start time; from now on, time is attributed to
+     TIMEVAR.  */
+  start_time = now;
+}
+
 /* Summarize timing variables to FP.  The timing variable TV_TOTAL has
    a special meaning -- it's considered to be the total elapsed time,
    for normalizing the others, and is displayed last.  */
@@ -386,7 +466,6 @@ timevar_print (FILE *fp)
 #if defined (HAVE_USER_TIME) || defined (HAVE_SYS_TIME) || defined (HAVE_WALL_TIME)
   unsigned int /* timevar_id_t */ id;
   struct timevar_time_def *total = &timevars[TV_TOTAL].elapsed;
-  struct timevar_time_def now;
 
   if (!timevar_enable)
     return;
@@ -396,17 +475,7 @@ timevar_print (FILE *fp)
   if (fp == 0)
     fp = stderr;
 
-  /* What time is it?  */
-  get_time (&now);
-
-  /* If the stack isn't empty, attribute the current elapsed time to
-     the old topmost element.  */
-  if (stack)
-    timevar_accumulate (&stack->timevar->elapsed, &start_time, &now);
-
-  /* Reset the start time; from now on, time is attributed to
-     TIMEVAR.  */
-  start_time = now;
+  timevar_update ();
 
   fputs (_("\nExecution times (seconds)\n"), fp);
   for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
@@ -478,6 +547,44 @@ timevar_print (FILE *fp)
 #endif
   fprintf (fp, "%8u kB\n", (unsigned) (total->ggc_mem >> 10));
 
+  /* Print where the memory went.  GGC memory is what was allocated
+     and what collections released while the variable was on top of
+     the stack; pools and obstacks show the net growth of the memory
+     they hold, which is negative when it was released; RSS shows how
+     far the high-water mark of the resident set rose.  */
+  fputs (_("\nMemory usage (kB)\n"), fp);
+  fputs (_("                         ggc alloc ggc freed     pools  obstacks"
+	   "  rss rise  rss peak\n"), fp);
+  for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
+    {
+      struct timevar_def *tv = &timevars[(timevar_id_t) id];
+
+      if ((timevar_id_t) id == TV_TOTAL || !tv->used)
+	continue;
+
+      /* Don't print variables that hardly used any memory.  */
+      if ((tv->elapsed.ggc_mem >> 10) < MEM_KB_BOUND
+	  && (tv->elapsed.ggc_freed >> 10) < MEM_KB_BOUND
+	  && labs ((long) (tv->elapsed.pool_mem / 1024)) < MEM_KB_BOUND
+	  && labs ((long) (tv->elapsed.obstack_mem / 1024)) < MEM_KB_BOUND
+	  && tv->elapsed.rss < MEM_KB_BOUND)
+	continue;
+
+      fprintf (fp, " %-22s:%10lu%10lu%10ld%10ld%10ld%10ld\n", tv->name,
+	       (unsigned long) (tv->elapsed.ggc_mem >> 10),
+	       (unsigned long) (tv->elapsed.ggc_freed >> 10),
+	       (long) (tv->elapsed.pool_mem / 1024),
+	       (long) (tv->elapsed.obstack_mem / 1024),
+	       tv->elapsed.rss, tv->elapsed.rss_peak);
+    }
+  fputs (_(" TOTAL                 :"), fp);
+  fprintf (fp, "%10lu%10lu%10ld%10ld%10ld%10ld\n",
+	   (unsigned long) (total->ggc_mem >> 10),
+	   (unsigned long) (total->ggc_freed >> 10),
+	   (long) (total->pool_mem / 1024),
+	   (long) (total->obstack_mem / 1024),
+	   total->rss, total->rss_peak);
+
 #ifdef ENABLE_CHECKING
   fprintf (fp, "Extra diagnostic checks enabled; compiler may run slowly.\n");
   fprintf (fp, "Configure with --enable-checking=release to disable checks.\n");
@@ -491,6 +598,89 @@ timevar_print (FILE *fp)
 	  || defined (HAVE_WALL_TIME) */
 }
 
+/* Print STR to FP as a JSON string.  */
+
+static void
+print_json_string (FILE *fp, const char *str)
+{
+  putc ('"', fp);
+  for (; *str; str++)
+    {
+      if (*str == '"' || *str == '\\')
+	putc ('\\', fp);
+      putc (*str, fp);
+    }
+  putc ('"', fp);
+}
+
+/* Print the times and memory usage in ELAPSED to FP as a JSON object
+   for the variable called NAME.  Memory amounts are in bytes, except
+   for the resident set size which the host reports in kilobytes.  */
+
+static void
+print_json_entry (FILE *fp, const char *name,
+		  struct timevar_time_def *elapsed)
+{
+  fputs ("    { \"name\": ", fp);
+  print_json_string (fp, name);
+  fprintf (fp, ", \"user\": %.3f, \"sys\": %.3f, \"wall\": %.3f,\n",
+	   elapsed->user, elapsed->sys, elapsed->wall);
+  fprintf (fp, "      \"ggc_allocated\": " HOST_WIDE_INT_PRINT_UNSIGNED
+	   ", \"ggc_freed\": " HOST_WIDE_INT_PRINT_UNSIGNED ",\n",
+	   (unsigned HOST_WIDE_INT) elapsed->ggc_mem,
+	   (unsigned HOST_WIDE_INT) elapsed->ggc_freed);
+  fprintf (fp, "      \"pool_growth\": " HOST_WIDE_INT_PRINT_DEC
+	   ", \"obstack_growth\": " HOST_WIDE_INT_PRINT_DEC ",\n",
+	   elapsed->pool_mem, elapsed->obstack_mem);
+  fprintf (fp, "      \"rss_rise_kb\": %ld, \"rss_peak_kb\": %ld }",
+	   elapsed->rss, elapsed->rss_peak);
+}
+
+/* Write the times and memory usage of all the timing variables that
+   were used to FILENAME as a JSON document, for tools that want to
+   find out which pass is responsible for the memory a compilation
+   uses.  TV_TOTAL is written separately as "total".  */
+
+void
+timevar_print_json (const char *filename)
+{
+  unsigned int /* timevar_id_t */ id;
+  bool first = true;
+  FILE *fp;
+
+  if (!timevar_enable)
+    return;
+
+  fp = fopen (filename, "w");
+  if (!fp)
+    {
+      error ("can%'t open %s for writing: %m", filename);
+      return;
+    }
+
+  timevar_update ();
+
+  fputs ("{\n  \"phases\": [\n", fp);
+  for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
+    {
+      struct timevar_def *tv = &timevars[(timevar_id_t) id];
+
+      if ((timevar_id_t) id == TV_TOTAL || !tv->used)
+	continue;
+
+      if (!first)
+	fputs (",\n", fp);
+      first = false;
+      print_json_entry (fp, tv->name, &tv->elapsed);
+    }
+  fputs ("\n  ],\n  \"total\":\n", fp);
+  print_json_entry (fp, timevars[TV_TOTAL].name, &timevars[TV_TOTAL].elapsed);
+  fputs ("\n}\n", fp);
+
+  if (fclose (fp))
+    error ("error writing to %s: %m", filename);
+}
+
 /* Prints a message to stderr stating that time elapsed in STR is
    TOTAL (given in microseconds).  */
 
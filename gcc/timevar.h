@@ -62,7 +62,21 @@ struct timevar_time_def
   double wall;
 
   /* Garbage collector memory.  */
-  unsigned ggc_mem;
+  size_t ggc_mem;
+
+  /* Garbage collector memory released by collections.  */
+  size_t ggc_freed;
+
+  /* Net growth of the memory held by alloc-pools and by bitmap
+     obstacks.  */
+  HOST_WIDE_INT pool_mem;
+  HOST_WIDE_INT obstack_mem;
+
+  /* The resident set size high-water mark, in kilobytes.  For an
+     elapsed time, RSS is the amount the high-water mark rose and
+     RSS_PEAK the highest mark seen when leaving the variable.  */
+  long rss;
+  long rss_peak;
 };
 
 /* An enumeration of timing variable identifiers.  Constructed from
@@ -89,6 +103,9 @@ extern void timevar_pop_1 (timevar_id_t);
 extern void timevar_start (timevar_id_t);
 extern void timevar_stop (timevar_id_t);
 extern void timevar_print (FILE *);
+extern void timevar_print_json (const char *);
+extern void *timevar_obstack_chunk_alloc (long);
+extern void timevar_obstack_chunk_free (void *);
 
 /* Provided for backward compatibility.  */
 extern void print_time (const char *, long);
@@ -96,5 +113,8 @@ extern void print_time (const char *, long);
 extern bool timevar_enable;
 
 extern size_t timevar_ggc_mem_total;
+extern size_t timevar_ggc_freed_total;
+extern HOST_WIDE_INT timevar_pool_mem_total;
+extern HOST_WIDE_INT timevar_obstack_mem_total;
 
 #endif /* ! GCC_TIMEVAR_H */
@@ -105,7 +105,10 @@ along with GCC; see the file COPYING3.  If not see
 static void general_init (const char *);
 static void do_compile (void);
 static void process_options (void);
+static void set_default_aux_base_name (void);
 static void backend_init (void);
+static int read_server_request (const char ***);
+static bool serve_compile_requests (void);
 static int lang_dependent_init (const char *);
 static void init_asm_output (const char *);
 static void finalize (void);
@@ -180,6 +183,11 @@ enum graph_dump_types graph_dump_format;
 
 const char *asm_file_name;
 
+/* Name of the file to write the -ftime-report data to in JSON form,
+   or NULL.  */
+
+const char *time_report_json_file;
+
 /* Nonzero means do optimizations.  -O.
    Particular numeric values stand for particular amounts of optimization;
    thus, -O2 stores 2 here.  However, the optimizations beyond the basic
@@ -1696,18 +1704,7 @@ process_options (void)
   if (flag_short_enums == 2)
     flag_short_enums = targetm.default_short_enums ();
 
-  /* Set aux_base_name if not already set.  */
-  if (aux_base_name)
-    ;
-  else if (main_input_filename)
-    {
-      char *name = xstrdup (lbasename (main_input_filename));
-
-      strip_off_ending (name, strlen (name));
-      aux_base_name = name;
-    }
-  else
-    aux_base_name = "gccaux";
+  set_default_aux_base_name ();
 
 #ifndef HAVE_cloog
   if (flag_graphite
@@ -2062,6 +2059,239 @@ lang_dependent_init_target (void)
   expand_dummy_function_end ();
 }
 
+/* Set aux_base_name from the main input file if not already set.  */
+static void
+set_default_aux_base_name (void)
+{
+  if (aux_base_name)
+    ;
+  else if (main_input_filename)
+    {
+      char *name = xstrdup (lbasename (main_input_filename));
+
+      strip_off_ending (name, strlen (name));
+      aux_base_name = name;
+    }
+  else
+    aux_base_name = "gccaux";
+}
+
+/* Read the arguments of a request to a compile server from standard
+   input: null-terminated strings, the last of them empty.  Return the
+   number of arguments, and set *ARGVP to point to them, followed by
+   NULL; or return -1 at the end of the input.  */
+static int
+read_server_request (const char ***argvp)
+{
+  static char *buf;
+  static size_t buf_size;
+  static const char **argv;
+  static size_t argv_size;
+  size_t len = 0, start = 0, argc = 0, i;
+  int c;
+
+  for (;;)
+    {
+      c = getchar ();
+      if (c == EOF)
+	return -1;
+      if (len == buf_size)
+	{
+	  buf_size = buf_size * 2 + 256;
+	  buf = XRESIZEVEC (char, buf, buf_size);
+	}
+      buf[len++] = c;
+      if (c == '\0')
+	{
+	  if (len - 1 == start)
+	    break;
+	  argc++;
+	  start = len;
+	}
+    }
+
+  if (argv_size < argc + 1)
+    {
+      argv_size = argc + 1;
+      argv = XRESIZEVEC (const char *, argv, argv_size);
+    }
+  for (i = 0, start = 0; i < argc; i++)
+    {
+      argv[i] = buf + start;
+      start += strlen (argv[i]) + 1;
+    }
+  argv[argc] = NULL;
+  *argvp = argv;
+  return argc;
+}
+
+#ifdef HAVE_WORKING_FORK
+
+/* Whether the N arguments ARGS are the ones the compile server was
+   started with, but for the program name and the -server after
+   them.  */
+static bool
+server_options_match_p (int n, const char **args)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    if (save_argv[i + 1] == NULL || strcmp (save_argv[i + 1], args[i]) != 0)
+      return false;
+  return (save_argv[n + 1] != NULL
+	  && strcmp (save_argv[n + 1], "-server") == 0
+	  && save_argv[n + 2] == NULL);
+}
+
+/* Write the wait status STATUS to FD, as a decimal number on a line of
+   its own.  */
+static void
+write_server_status (int fd, int status)
+{
+  char buf[32];
+  int len = sprintf (buf, "%d\n", status);
+
+  if (write (fd, buf, len) != len)
+    error ("can%'t reply to the driver: %m");
+}
+
+/* In a child of the compile server, decode the ARGC arguments ARGV of
+   the request it is for and start reading the file to compile.  Its
+   standard output and standard error go to the file ERR_NAME if that
+   is not NULL.  Exit if the request is wrong.  */
+static void
+start_server_child (int argc, const char **argv, const char *err_name)
+{
+  if (err_name != NULL)
+    {
+      int fd = open (err_name, O_WRONLY | O_APPEND);
+
+      if (fd < 0 || dup2 (fd, STDERR_FILENO) < 0)
+	fatal_error ("can%'t open %s: %m", err_name);
+      close (fd);
+    }
+
+  /* Standard output is for the server's replies.  */
+  if (dup2 (STDERR_FILENO, STDOUT_FILENO) < 0)
+    fatal_error ("can%'t redirect standard output: %m");
+
+  aux_base_name = NULL;
+  if (!decode_server_request (argc, argv)
+      || !lang_hooks.read_main_file (&main_input_filename))
+    exit (FATAL_EXIT_CODE);
+  set_default_aux_base_name ();
+}
+
+#endif /* HAVE_WORKING_FORK */
+
+/* With -server, once the options have been processed, the back end
+   initialized and the front end has created its builtin declarations,
+   wait for requests on standard input.  Each names a file to compile
+   (see decode_server_request for the other arguments it can have),
+   which a child of the server compiles from there on, so that nothing
+   it does is seen by the next.  The wait status of the child is
+   written to standard output as a decimal number on a line of its
+   own.
+
+   The children of a driver run with -j share one server.  Their
+   requests start with "-server-reply", the file descriptor to reply
+   on, the file to write diagnostics to, and the number of options
+   after it that the server must have been started with.  Such a
+   request is answered by a process of its own once the file has been
+   compiled, so that the server can take the next one meanwhile; or
+   at once with -1, if the options are not the server's.
+
+   Return true in the child, and false in the server once standard
+   input is exhausted.  */
+static bool
+serve_compile_requests (void)
+{
+#ifdef HAVE_WORKING_FORK
+  location_t save_loc = input_location;
+  const char **argv;
+  int argc, status;
+  pid_t pid;
+
+  if (lang_hooks.read_main_file == NULL)
+    {
+      error ("-server is not supported for this language");
+      return false;
+    }
+
+  input_location = BUILTINS_LOCATION;
+  if (lang_hooks.init () == 0)
+    return false;
+  input_location = save_loc;
+
+  while ((argc = read_server_request (&argv)) >= 0)
+    {
+      const char *err_name = NULL;
+      int reply_fd = -1;
+
+      if (argc >= 4 && strcmp (argv[0], "-server-reply") == 0)
+	{
+	  int n = atoi (argv[3]);
+
+	  reply_fd = atoi (argv[1]);
+	  err_name = argv[2];
+	  if (n < 0 || n > argc - 4 || !server_options_match_p (n, argv + 4))
+	    {
+	      write_server_status (reply_fd, -1);
+	      continue;
+	    }
+	  argv += 4 + n;
+	  argc -= 4 + n;
+	}
+
+      fflush (stdout);
+      fflush (stderr);
+      pid = fork ();
+      if (pid < 0)
+	fatal_error ("can%'t fork: %m");
+
+      if (pid == 0)
+	{
+	  if (reply_fd < 0)
+	    {
+	      start_server_child (argc, argv, NULL);
+	      return true;
+	    }
+
+	  /* Compile in a child of this process, which waits for it and
+	     replies.  */
+	  pid = fork ();
+	  if (pid == 0)
+	    {
+	      start_server_child (argc, argv, err_name);
+	      return true;
+	    }
+	  if (pid < 0 || waitpid (pid, &status, 0) != pid)
+	    status = -1;
+	  write_server_status (reply_fd, status);
+	  _exit (0);
+	}
+
+      if (reply_fd < 0)
+	{
+	  if (waitpid (pid, &status, 0) != pid)
+	    fatal_error ("can%'t wait for the compiler: %m");
+	  printf ("%d\n", status);
+	  fflush (stdout);
+	}
+
+      /* Collect the processes that have replied.  */
+      while (waitpid (-1, &status, WNOHANG) > 0)
+	;
+    }
+
+  while (waitpid (-1, &status, 0) > 0)
+    ;
+#else
+  error ("-server is not supported on this host");
+#endif
+  return false;
+}
+
 /* Language-dependent initialization.  Returns nonzero on success.  */
 static int
 lang_dependent_init (const char *name)
@@ -2070,11 +2300,15 @@ lang_dependent_init (const char *name)
   if (dump_base_name == 0)
     dump_base_name = name && name[0] ? name : "gccdump";
 
-  /* Other front-end initialization.  */
-  input_location = BUILTINS_LOCATION;
-  if (lang_hooks.init () == 0)
-    return 0;
-  input_location = save_loc;
+  /* Other front-end initialization, which a compile server has done
+     before the file was sent to it.  */
+  if (!flag_compile_server)
+    {
+      input_location = BUILTINS_LOCATION;
+      if (lang_hooks.init () == 0)
+	return 0;
+      input_location = save_loc;
+    }
 
   init_asm_output (name);
 
@@ -2174,7 +2408,8 @@ do_compile (void)
 {
   /* Initialize timing first.  The C front ends read the main file in
      the post_options hook, and C++ does file timings.  */
-  if (time_report || !quiet_flag  || flag_detailed_statistics)
+  if (time_report || !quiet_flag  || flag_detailed_statistics
+      || time_report_json_file)
     timevar_init ();
   timevar_start (TV_TOTAL);
 
@@ -2192,16 +2427,24 @@ do_compile (void)
       if (!no_backend)
 	backend_init ();
 
-      /* Language-dependent initialization.  Returns true on success.  */
-      if (lang_dependent_init (main_input_filename))
-	compile_file ();
+      /* A compile server stops here, and carries on in a child for each
+	 file sent to it.  */
+      if (!flag_compile_server || serve_compile_requests ())
+	{
+	  /* Language-dependent initialization.  Returns true on success.  */
+	  if (lang_dependent_init (main_input_filename))
+	    compile_file ();
 
-      finalize ();
+	  finalize ();
+	}
     }
 
   /* Stop timing and print the times.  */
   timevar_stop (TV_TOTAL);
-  timevar_print (stderr);
+  if (time_report || !quiet_flag  || flag_detailed_statistics)
+    timevar_print (stderr);
+  if (time_report_json_file)
+    timevar_print_json (time_report_json_file);
 }
 
 /* Entry point of cc1, cc1plus, jc1, f771, etc.
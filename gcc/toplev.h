@@ -119,6 +119,7 @@ extern const char *aux_base_name;
 extern const char *aux_info_file_name;
 extern const char *profile_data_prefix;
 extern const char *asm_file_name;
+extern const char *time_report_json_file;
 extern bool exit_after_options;
 
 /* True if the user has tagged the function with the 'section'
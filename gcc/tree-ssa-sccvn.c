@@ -2748,10 +2748,14 @@ continue_walking:
 static void
 allocate_vn_table (vn_tables_t table)
 {
-  table->phis = htab_create (23, vn_phi_hash, vn_phi_eq, free_phi);
-  table->nary = htab_create (23, vn_nary_op_hash, vn_nary_op_eq, NULL);
-  table->references = htab_create (23, vn_reference_hash, vn_reference_eq,
-				   free_reference);
+  table->phis = htab_create_grouped_alloc (23, vn_phi_hash, vn_phi_eq,
+					   free_phi, xcalloc, free);
+  table->nary = htab_create_grouped_alloc (23, vn_nary_op_hash,
+					   vn_nary_op_eq, NULL, xcalloc, free);
+  table->references = htab_create_grouped_alloc (23, vn_reference_hash,
+						 vn_reference_eq,
+						 free_reference, xcalloc,
+						 free);
 
   gcc_obstack_init (&table->nary_obstack);
   table->phis_pool = create_alloc_pool ("VN phis",
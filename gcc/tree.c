@@ -264,8 +264,8 @@ void
 init_ttree (void)
 {
   /* Initialize the hash table of types.  */
-  type_hash_table = htab_create_ggc (TYPE_HASH_INITIAL_SIZE, type_hash_hash,
-				     type_hash_eq, 0);
+  type_hash_table = htab_create_grouped_ggc (TYPE_HASH_INITIAL_SIZE,
+					     type_hash_hash, type_hash_eq, 0);
 
   debug_expr_for_decl = htab_create_ggc (512, tree_map_hash,
 					 tree_map_eq, 0);
@@ -879,7 +879,7 @@ int_cst_hash_hash (const void *x)
   const_tree const t = (const_tree) x;
 
   return (TREE_INT_CST_HIGH (t) ^ TREE_INT_CST_LOW (t)
-	  ^ htab_hash_pointer (TREE_TYPE (t)));
+	  ^ TYPE_UID (TREE_TYPE (t)));
 }
 
 /* Return nonzero if the value represented by *X (an INTEGER_CST tree node)
@@ -4336,7 +4336,13 @@ tree_map_base_eq (const void *va, const void *vb)
 unsigned int
 tree_map_base_hash (const void *item)
 {
-  return htab_hash_pointer (((const struct tree_map_base *)item)->from);
+  const_tree from = ((const struct tree_map_base *)item)->from;
+
+  /* Hash decls by their UID rather than their address, which changes
+     when a PCH is loaded somewhere else.  */
+  if (DECL_P (from))
+    return DECL_UID (from);
+  return htab_hash_pointer (from);
 }
 
 /* Return true if this tree map structure is marked for garbage collection
@@ -4443,7 +4449,7 @@ decl_restrict_base_lookup (tree from)
 
   in.base.from = from;
   h = (struct tree_map *) htab_find_with_hash (restrict_base_for_decl, &in,
-					       htab_hash_pointer (from));
+					       DECL_UID (from));
   return h ? h->to : NULL_TREE;
 }
 
@@ -4456,7 +4462,7 @@ decl_restrict_base_insert (tree from, tree to)
   void **loc;
 
   h = GGC_NEW (struct tree_map);
-  h->hash = htab_hash_pointer (from);
+  h->hash = DECL_UID (from);
   h->base.from = from;
   h->to = to;
   loc = htab_find_slot_with_hash (restrict_base_for_decl, h, h->hash, INSERT);
@@ -4508,7 +4514,7 @@ decl_debug_expr_lookup (tree from)
   in.base.from = from;
 
   h = (struct tree_map *) htab_find_with_hash (debug_expr_for_decl, &in,
-					       htab_hash_pointer (from));
+					       DECL_UID (from));
   if (h)
     return h->to;
   return NULL_TREE;
@@ -4523,7 +4529,7 @@ decl_debug_expr_insert (tree from, tree to)
   void **loc;
 
   h = GGC_NEW (struct tree_map);
-  h->hash = htab_hash_pointer (from);
+  h->hash = DECL_UID (from);
   h->base.from = from;
   h->to = to;
   loc = htab_find_slot_with_hash (debug_expr_for_decl, h, h->hash, INSERT);
@@ -4539,7 +4545,7 @@ decl_value_expr_lookup (tree from)
   in.base.from = from;
 
   h = (struct tree_map *) htab_find_with_hash (value_expr_for_decl, &in,
-					       htab_hash_pointer (from));
+					       DECL_UID (from));
   if (h)
     return h->to;
   return NULL_TREE;
@@ -4554,7 +4560,7 @@ decl_value_expr_insert (tree from, tree to)
   void **loc;
 
   h = GGC_NEW (struct tree_map);
-  h->hash = htab_hash_pointer (from);
+  h->hash = DECL_UID (from);
   h->base.from = from;
   h->to = to;
   loc = htab_find_slot_with_hash (value_expr_for_decl, h, h->hash, INSERT);
@@ -5534,8 +5534,8 @@ init_varasm_once (void)
 				  section_entry_eq, NULL);
   object_block_htab = htab_create_ggc (31, object_block_entry_hash,
 				       object_block_entry_eq, NULL);
-  const_desc_htab = htab_create_ggc (1009, const_desc_hash,
-				     const_desc_eq, NULL);
+  const_desc_htab = htab_create_grouped_ggc (1009, const_desc_hash,
+					     const_desc_eq, NULL);
 
   const_alias_set = new_alias_set ();
   shared_constant_pool = create_constant_pool ();
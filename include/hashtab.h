@@ -90,6 +90,12 @@ typedef void (*htab_free_with_arg) (void *, void *);
 
 #define HTAB_DELETED_ENTRY  ((PTR) 1)
 
+/* This macro defines the number of slots of a table created by
+   htab_create_grouped_alloc whose control bytes are compared
+   together.  */
+
+#define HTAB_GROUP_SIZE 16
+
 /* Hash tables are of the following type.  The structure
    (implementation) of this type is not needed for using the hash
    tables.  All work with hash table should be executed only through
@@ -137,8 +143,12 @@ struct htab GTY(())
   htab_free_with_arg free_with_arg_f;
 
   /* Current size (in entries) of the hash table, as an index into the
-     table of primes.  */
+     table of primes; or for a grouped table, as the base-2 logarithm
+     of the number of groups.  */
   unsigned int size_prime_index;
+
+  /* Nonzero if the table was created by htab_create_grouped_alloc.  */
+  unsigned int grouped;
 };
 
 typedef struct htab *htab_t;
@@ -157,6 +167,16 @@ extern htab_t	htab_create_alloc_ex (size_t, htab_hash,
                                       void *, htab_alloc_with_arg,
                                       htab_free_with_arg);
 
+/* Like htab_create_alloc, but lay the table out in groups of
+   HTAB_GROUP_SIZE slots, with a control byte holding a few bits of the
+   hash of each element after the slots.  A search compares the control
+   bytes of a whole group at once and only calls the equality function
+   on elements whose hash bits match.  The callbacks and the functions
+   used on the table are the same as for any other table.  */
+extern htab_t	htab_create_grouped_alloc (size_t, htab_hash,
+					   htab_eq, htab_del,
+					   htab_alloc, htab_free);
+
 /* Backward-compatibility functions.  */
 extern htab_t htab_create (size_t, htab_hash, htab_eq, htab_del);
 extern htab_t htab_try_create (size_t, htab_hash, htab_eq, htab_del);
@@ -1634,6 +1634,14 @@ _cpp_interpret_identifier (cpp_reader *pfile, const uchar *id, size_t len)
 				  buf, bufp - buf, HT_ALLOC));
 }
 
+/* Return true if files in INPUT_CHARSET have to be converted to the
+   source character set by _cpp_convert_input.  */
+bool
+_cpp_input_needs_conversion (const char *input_charset)
+{
+  return strcasecmp (SOURCE_CHARSET, input_charset) != 0;
+}
+
 /* Convert an input buffer (containing the complete contents of one
    source file) from INPUT_CHARSET to the source character set.  INPUT
    points to the input buffer, SIZE is its allocated size, and LEN is
@@ -1647,7 +1655,9 @@ _cpp_interpret_identifier (cpp_reader *pfile, const uchar *id, size_t len)
    INPUT is expected to have been allocated with xmalloc.  This
    function will either set *BUFFER_START to INPUT, or free it and set
    *BUFFER_START to a pointer to another xmalloc-allocated block of
-   memory.  */
+   memory.  If _cpp_input_needs_conversion returns false for
+   INPUT_CHARSET and SIZE is LEN + 1, INPUT is neither freed nor
+   reallocated, so it may also be a mapping of the file.  */
 uchar * 
 _cpp_convert_input (cpp_reader *pfile, const char *input_charset,
 		    uchar *input, size_t size, size_t len,
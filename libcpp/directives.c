@@ -26,6 +26,7 @@ along with this program; see the file COPYING3.  If not see
 #include "internal.h"
 #include "mkdeps.h"
 #include "obstack.h"
+#include "hashtab.h"
 
 /* Stack of conditionals currently in progress
    (including both successful and failing conditionals).  */
@@ -541,7 +542,11 @@ lex_macro_node (cpp_reader *pfile, bool is_def_or_undef)
 	cpp_error (pfile, CPP_DL_ERROR,
 		   "\"defined\" cannot be used as a macro name");
       else if (! (node->flags & NODE_POISONED))
-	return node;
+	{
+	  if (node->flags & NODE_LAZY)
+	    _cpp_define_lazy_macro (pfile, node);
+	  return node;
+	}
     }
   else if (token->flags & NAMED_OP)
     cpp_error (pfile, CPP_DL_ERROR,
@@ -605,7 +610,7 @@ do_undef (cpp_reader *pfile)
 	  if (CPP_OPTION (pfile, warn_unused_macros))
 	    _cpp_warn_if_unused_macro (pfile, node, NULL);
 
-	  _cpp_free_definition (node);
+	  _cpp_free_definition (pfile, node);
 	}
     }
 
@@ -619,9 +624,17 @@ undefine_macros (cpp_reader *pfile ATTRIBUTE_UNUSED, cpp_hashnode *h,
 		 void *data_p ATTRIBUTE_UNUSED)
 {
   /* Body of _cpp_free_definition inlined here for speed.
-     Macros and assertions no longer have anything to free.  */
+     Apart from a kept expansion, macros and assertions no longer
+     have anything to free.  */
+  if (h->type == NT_MACRO && !(h->flags & NODE_BUILTIN)
+      && h->value.macro->expansion)
+    {
+      free (h->value.macro->expansion);
+      h->value.macro->expansion = NULL;
+    }
   h->type = NT_VOID;
-  h->flags &= ~(NODE_POISONED|NODE_BUILTIN|NODE_DISABLED|NODE_USED);
+  h->flags &= ~(NODE_POISONED|NODE_BUILTIN|NODE_DISABLED|NODE_USED
+		|NODE_IN_EXPANSION);
   return 1;
 }
 
@@ -631,6 +644,7 @@ void
 cpp_undef_all (cpp_reader *pfile)
 {
   cpp_forall_identifiers (pfile, undefine_macros, NULL);
+  pfile->expansion_epoch++;
 }
 
 
@@ -1430,10 +1444,12 @@ do_pragma_poison (cpp_reader *pfile)
       if (hp->flags & NODE_POISONED)
 	continue;
 
+      if (hp->flags & NODE_LAZY)
+	_cpp_define_lazy_macro (pfile, hp);
       if (hp->type == NT_MACRO)
 	cpp_error (pfile, CPP_DL_WARNING, "poisoning existing macro \"%s\"",
 		   NODE_NAME (hp));
-      _cpp_free_definition (hp);
+      _cpp_free_definition (pfile, hp);
       hp->flags |= NODE_POISONED | NODE_DIAGNOSTIC;
     }
   pfile->state.poisoned_ok = 0;
@@ -2119,7 +2135,7 @@ do_unassert (cpp_reader *pfile)
 	  check_eol (pfile);
 	}
       else
-	_cpp_free_definition (node);
+	_cpp_free_definition (pfile, node);
     }
 
   /* We don't commit the memory for the answer - it's temporary only.  */
@@ -2189,6 +2205,239 @@ _cpp_define_builtin (cpp_reader *pfile, const char *str)
   run_directive (pfile, T_DEFINE, buf, len);
 }
 
+/* A macro registered with cpp_define_lazily or cpp_define_computed
+   whose definition has not been needed yet.  */
+struct lazy_macro
+{
+  cpp_hashnode *node;
+
+  /* Where the macro was registered; its tokens get this location.  */
+  source_location line;
+
+  /* The expansion, or NULL if the compute_macro callback gives it.  */
+  char *expansion;
+};
+
+/* Hash table callbacks for pfile->lazy_macros.  */
+static hashval_t
+hash_lazy_macro (const void *p)
+{
+  return htab_hash_pointer (((const struct lazy_macro *) p)->node);
+}
+
+static int
+eq_lazy_macro (const void *p, const void *node)
+{
+  return ((const struct lazy_macro *) p)->node == node;
+}
+
+static void
+free_lazy_macro (void *p)
+{
+  struct lazy_macro *lm = (struct lazy_macro *) p;
+
+  free (lm->expansion);
+  free (lm);
+}
+
+/* Return the node of the macro NAME, of length LEN, if its definition
+   can be put off until it is needed, NULL if it has to be defined
+   now.  Function-like macros, redefinitions and anything -dD or
+   -traditional-cpp would see being defined are defined now.  */
+static cpp_hashnode *
+lazy_macro_node (cpp_reader *pfile, const char *name, size_t len)
+{
+  cpp_hashnode *node;
+  size_t i;
+
+  if (CPP_OPTION (pfile, traditional) || pfile->cb.define
+      || len == 0 || !is_idstart (name[0]))
+    return NULL;
+  for (i = 1; i < len; i++)
+    if (!is_idchar (name[i]))
+      return NULL;
+
+  node = cpp_lookup (pfile, (const uchar *) name, len);
+  if (node->flags & NODE_LAZY)
+    {
+      /* Let the #define of the new value check it against the old.  */
+      _cpp_define_lazy_macro (pfile, node);
+      return NULL;
+    }
+  if (node->type != NT_VOID || (node->flags & NODE_POISONED))
+    return NULL;
+
+  return node;
+}
+
+/* Remember EXPANSION, which is malloced, as the expansion of the
+   macro NODE until the macro is needed.  */
+static void
+register_lazy_macro (cpp_reader *pfile, cpp_hashnode *node, char *expansion)
+{
+  struct lazy_macro *lm = XNEW (struct lazy_macro);
+  void **slot;
+
+  if (pfile->lazy_macros == NULL)
+    pfile->lazy_macros = htab_create (128, hash_lazy_macro, eq_lazy_macro,
+				      free_lazy_macro);
+
+  lm->node = node;
+  lm->line = pfile->line_table->highest_line;
+  lm->expansion = expansion;
+  slot = htab_find_slot_with_hash (pfile->lazy_macros, node,
+				   htab_hash_pointer (node), INSERT);
+  *slot = lm;
+  node->flags |= NODE_LAZY;
+}
+
+/* Like cpp_define, but only lex the definition of STR, which has to
+   be an object-like macro, when the macro is first expanded or
+   tested.  Used for the many predefined macros that most translation
+   units never look at.  */
+void
+cpp_define_lazily (cpp_reader *pfile, const char *str)
+{
+  const char *eq = strchr (str, '=');
+  size_t len = eq ? (size_t) (eq - str) : strlen (str);
+  cpp_hashnode *node = lazy_macro_node (pfile, str, len);
+
+  if (node)
+    register_lazy_macro (pfile, node, xstrdup (eq ? eq + 1 : "1"));
+  else
+    cpp_define (pfile, str);
+}
+
+/* Define the object-like macro NAME, whose expansion the compute_macro
+   callback returns when the macro is first expanded or tested.  */
+void
+cpp_define_computed (cpp_reader *pfile, const char *name)
+{
+  size_t len = strlen (name);
+  cpp_hashnode *node = lazy_macro_node (pfile, name, len);
+
+  if (node)
+    register_lazy_macro (pfile, node, NULL);
+  else
+    {
+      const char *expansion
+	= pfile->cb.compute_macro (pfile, cpp_lookup (pfile,
+						      (const uchar *) name,
+						      len));
+      char *buf = (char *) alloca (len + strlen (expansion) + 2);
+
+      sprintf (buf, "%s=%s", name, expansion);
+      cpp_define (pfile, buf);
+    }
+}
+
+/* Define the lazy macro NODE, registered at LINE, to EXPANSION, or to
+   what the compute_macro callback returns if EXPANSION is NULL.  This
+   happens in the middle of lexing, perhaps of a directive, so unlike
+   run_directive this saves and restores the lexer state and keeps the
+   tokens out of the current token run.  */
+static void
+define_lazy_macro (cpp_reader *pfile, cpp_hashnode *node,
+		   source_location line, const char *expansion)
+{
+  struct lexer_state saved_state = pfile->state;
+  const directive *saved_directive = pfile->directive;
+  source_location saved_directive_line = pfile->directive_line;
+  source_location saved_highest_line = pfile->line_table->highest_line;
+  unsigned int saved_column_hint = pfile->line_table->max_column_hint;
+  cpp_token *saved_cur_token = pfile->cur_token;
+  tokenrun *saved_cur_run = pfile->cur_run;
+  unsigned int saved_lookaheads = pfile->lookaheads;
+  cpp_token tokens[4];
+  tokenrun run;
+  size_t len;
+  char *buf;
+
+  node->flags &= ~NODE_LAZY;
+  if (expansion == NULL)
+    expansion = pfile->cb.compute_macro (pfile, node);
+
+  /* The leading space keeps the macro object-like.  */
+  len = strlen (expansion);
+  buf = (char *) alloca (len + 2);
+  buf[0] = ' ';
+  memcpy (buf + 1, expansion, len);
+  buf[len + 1] = '\n';
+
+  run.base = tokens;
+  run.limit = tokens + ARRAY_SIZE (tokens);
+  run.next = run.prev = NULL;
+  pfile->cur_run = &run;
+  pfile->cur_token = run.base;
+  pfile->lookaheads = 0;
+
+  memset (&pfile->state, 0, sizeof pfile->state);
+  pfile->state.in_directive = 1;
+  pfile->directive = &dtable[T_DEFINE];
+  pfile->directive_line = line;
+
+  /* Give the tokens columns of LINE without extending the line map.  */
+  pfile->line_table->highest_line = line;
+  pfile->line_table->max_column_hint = len + 2;
+
+  cpp_push_buffer (pfile, (const uchar *) buf, len + 1,
+		   /* from_stage3 */ true);
+  _cpp_clean_line (pfile);
+  if (_cpp_create_definition (pfile, node))
+    /* It was registered before -Wunused-macros applied.  */
+    node->value.macro->used = 1;
+  _cpp_pop_buffer (pfile);
+
+  pfile->line_table->highest_line = saved_highest_line;
+  pfile->line_table->max_column_hint = saved_column_hint;
+  pfile->state = saved_state;
+  pfile->directive = saved_directive;
+  pfile->directive_line = saved_directive_line;
+  pfile->cur_token = saved_cur_token;
+  pfile->cur_run = saved_cur_run;
+  pfile->lookaheads = saved_lookaheads;
+}
+
+/* Define NODE, which is flagged NODE_LAZY, now that it is needed.  */
+void
+_cpp_define_lazy_macro (cpp_reader *pfile, cpp_hashnode *node)
+{
+  void **slot = htab_find_slot_with_hash (pfile->lazy_macros, node,
+					  htab_hash_pointer (node),
+					  NO_INSERT);
+  struct lazy_macro *lm = (struct lazy_macro *) *slot;
+  source_location line = lm->line;
+  char *expansion = lm->expansion;
+
+  lm->expansion = NULL;
+  htab_clear_slot (pfile->lazy_macros, slot);
+  define_lazy_macro (pfile, node, line, expansion);
+  free (expansion);
+}
+
+/* Callback for htab_traverse.  */
+static int
+define_lazy_macro_1 (void **slot, void *pfile)
+{
+  struct lazy_macro *lm = (struct lazy_macro *) *slot;
+
+  define_lazy_macro ((cpp_reader *) pfile, lm->node, lm->line,
+		     lm->expansion);
+  return 1;
+}
+
+/* Define all the lazy macros, for the callers that look at every
+   identifier.  */
+void
+_cpp_define_lazy_macros (cpp_reader *pfile)
+{
+  if (pfile->lazy_macros && htab_elements (pfile->lazy_macros))
+    {
+      htab_traverse (pfile->lazy_macros, define_lazy_macro_1, pfile);
+      htab_empty (pfile->lazy_macros);
+    }
+}
+
 /* Process MACRO as if it appeared as the body of an #undef.  */
 void
 cpp_undef (cpp_reader *pfile, const char *macro)
@@ -2247,8 +2496,9 @@ cpp_pop_definition (cpp_reader *pfile, const char *str, cpp_macro *dfn)
       if (CPP_OPTION (pfile, warn_unused_macros))
 	_cpp_warn_if_unused_macro (pfile, node, NULL);
     }
+  _cpp_invalidate_expansions (pfile, node);
   if (node->type != NT_VOID)
-    _cpp_free_definition (node);
+    _cpp_free_definition (pfile, node);
 
   if (dfn)
     {
@@ -632,6 +632,9 @@ parse_defined (cpp_reader *pfile)
 
   if (node)
     {
+      if (node->flags & NODE_LAZY)
+	_cpp_define_lazy_macro (pfile, node);
+
       if (pfile->context != initial_context && CPP_PEDANTIC (pfile))
 	cpp_error (pfile, CPP_DL_WARNING,
 		   "this use of \"defined\" may not be portable");
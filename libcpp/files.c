@@ -50,6 +50,16 @@ along with this program; see the file COPYING3.  If not see
 #  define set_stdin_to_binary_mode() /* Nothing */
 #endif
 
+/* Regular files at least this many pages long are mapped into memory
+   instead of being read into a private buffer.  Most headers are only
+   scanned once, so sharing their pages with the page cache saves a
+   copy and memory; for small files the mapping costs more than the
+   copy.  */
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H) && defined (_SC_PAGESIZE)
+# include <sys/mman.h>
+# define MMAP_THRESHOLD 2
+#endif
+
 /* This structure represents a file searched for by CPP, whether it
    exists or not.  An instance may be pointed to by more than one
    file_hash_entry; at present no reference count is kept.  */
@@ -78,6 +88,10 @@ struct _cpp_file
      BUFFER; when freeing, this this pointer must be used instead.  */
   const uchar *buffer_start;
 
+  /* If BUFFER_START was mapped rather than allocated, the length of
+     the mapping, otherwise zero.  */
+  size_t mapped_size;
+
   /* The macro, if any, preventing re-inclusion.  */
   const cpp_hashnode *cmacro;
 
@@ -112,6 +126,9 @@ struct _cpp_file
   bool buffer_valid;
 };
 
+/* The list of files read from a PCH file, if any.  */
+static struct pchf_data *pchf;
+
 /* A singly-linked list for all searches for a given file name, with
    its head pointed to by a slot in FILE_HASH.  The file name is what
    appeared between the quotes in a #include directive; it can be
@@ -168,7 +185,11 @@ struct file_hash_entry_pool
 
 static bool open_file (_cpp_file *file);
 static bool find_file_in_dir (cpp_reader *pfile, _cpp_file *file);
+#ifdef MMAP_THRESHOLD
+static uchar *map_file (cpp_reader *pfile, _cpp_file *file, ssize_t size);
+#endif
 static bool read_file_guts (cpp_reader *pfile, _cpp_file *file);
+static void free_file_buffer (_cpp_file *file);
 static bool read_file (cpp_reader *pfile, _cpp_file *file);
 static bool should_stack_file (cpp_reader *, _cpp_file *file, bool import);
 static struct cpp_dir *search_path_head (cpp_reader *, const char *fname,
@@ -192,6 +213,11 @@ static char *append_file_to_dir (const char *fname, cpp_dir *dir);
 static int pchf_save_compare (const void *e1, const void *e2);
 static int pchf_compare (const void *d_p, const void *e_p);
 static bool check_file_against_entries (cpp_reader *, _cpp_file *, bool);
+static bool include_cache_missing_p (cpp_reader *, const char *, hashval_t);
+static void include_cache_add_missing (cpp_reader *, const char *, hashval_t);
+static const cpp_hashnode *include_cache_guard (cpp_reader *, _cpp_file *);
+static void include_cache_add_guard (cpp_reader *, _cpp_file *);
+static void include_cache_free (cpp_reader *);
 
 /* Given a filename in FILE->PATH, with the empty string interpreted
    as <stdin>, open it.
@@ -289,8 +315,10 @@ find_file_in_dir (cpp_reader *pfile, _cpp_file *file)
       char *copy;
       void **pp;
 
-      if (htab_find_with_hash (pfile->nonexistent_file_hash, path, hv) != NULL)
+      if (htab_find_with_hash (pfile->nonexistent_file_hash, path, hv) != NULL
+	  || include_cache_missing_p (pfile, path, hv))
 	{
+	  free (path);
 	  file->err_no = ENOENT;
 	  return false;
 	}
@@ -315,6 +343,7 @@ find_file_in_dir (cpp_reader *pfile, _cpp_file *file)
       pp = htab_find_slot_with_hash (pfile->nonexistent_file_hash,
 				     copy, hv, INSERT);
       *pp = copy;
+      include_cache_add_missing (pfile, copy, hv);
 
       file->path = file->name;
     }
@@ -487,6 +516,38 @@ _cpp_find_file (cpp_reader *pfile, const char *fname, cpp_dir *start_dir, bool f
   return file;
 }
 
+#ifdef MMAP_THRESHOLD
+/* Map the regular file FILE, which is SIZE bytes long, if that is
+   worthwhile.  The mapping is private and writable: the terminating
+   newline is stored just past the end of the file, in the zero-filled
+   tail of its last page, and _cpp_clean_line only writes to lines that
+   need cleaning, so only the pages actually changed get copied.
+   Return NULL if the file should be read instead.  */
+static uchar *
+map_file (cpp_reader *pfile, _cpp_file *file, ssize_t size)
+{
+  long pagesize = sysconf (_SC_PAGESIZE);
+  void *addr;
+
+  /* A file that ends on a page boundary leaves no room for the
+     terminator, and the buffer of a file that needs conversion
+     is replaced and freed by _cpp_convert_input.  */
+  if (pagesize <= 0
+      || size < MMAP_THRESHOLD * pagesize
+      || size % pagesize == 0
+      || !STAT_SIZE_RELIABLE (file->st)
+      || _cpp_input_needs_conversion (CPP_OPTION (pfile, input_charset)))
+    return NULL;
+
+  addr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file->fd, 0);
+  if (addr == MAP_FAILED)
+    return NULL;
+
+  file->mapped_size = size;
+  return (uchar *) addr;
+}
+#endif
+
 /* Read a file into FILE->buffer, returning true on success.
 
    If FILE->fd is something weird, like a block device, we don't want
@@ -533,31 +594,44 @@ read_file_guts (cpp_reader *pfile, _cpp_file *file)
        the majority of C source files.  */
     size = 8 * 1024;
 
-  buf = XNEWVEC (uchar, size + 1);
-  total = 0;
-  while ((count = read (file->fd, buf + total, size - total)) > 0)
+#ifdef MMAP_THRESHOLD
+  if (regular && (buf = map_file (pfile, file, size)) != NULL)
+    {
+      /* Tell _cpp_convert_input that there is room for the
+	 terminator, so that it does not try to reallocate BUF.  */
+      total = size;
+      size = total + 1;
+    }
+  else
+#endif
     {
-      total += count;
+      buf = XNEWVEC (uchar, size + 1);
+      total = 0;
+      while ((count = read (file->fd, buf + total, size - total)) > 0)
+	{
+	  total += count;
 
-      if (total == size)
+	  if (total == size)
+	    {
+	      if (regular)
+		break;
+	      size *= 2;
+	      buf = XRESIZEVEC (uchar, buf, size + 1);
+	    }
+	}
+
+      if (count < 0)
 	{
-	  if (regular)
-	    break;
-	  size *= 2;
-	  buf = XRESIZEVEC (uchar, buf, size + 1);
+	  cpp_errno (pfile, CPP_DL_ERROR, file->path);
+	  free (buf);
+	  return false;
 	}
-    }
 
-  if (count < 0)
-    {
-      cpp_errno (pfile, CPP_DL_ERROR, file->path);
-      return false;
+      if (regular && total != size && STAT_SIZE_RELIABLE (file->st))
+	cpp_error (pfile, CPP_DL_WARNING,
+		   "%s is shorter than expected", file->path);
     }
 
-  if (regular && total != size && STAT_SIZE_RELIABLE (file->st))
-    cpp_error (pfile, CPP_DL_WARNING,
-	       "%s is shorter than expected", file->path);
-
   file->buffer = _cpp_convert_input (pfile,
 				     CPP_OPTION (pfile, input_charset),
 				     buf, size, total,
@@ -623,6 +697,32 @@ should_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
   if (file->cmacro && file->cmacro->type == NT_MACRO)
     return false;
 
+  /* If an earlier compilation found that the file has a header guard
+     and the macro is defined, there is no need to read the file.  It
+     is still stacked, with no contents, so that it shows up in
+     dependencies and line markers as usual.  #import, #pragma once and
+     PCH compare contents, so they get no such shortcut.  */
+  if (!import
+      && !file->stack_count
+      && !file->buffer_valid
+      && !file->pchname
+      && !pfile->seen_once_only
+      && pchf == NULL)
+    {
+      const cpp_hashnode *guard = include_cache_guard (pfile, file);
+
+      if (guard && guard->type == NT_MACRO)
+	{
+	  file->cmacro = guard;
+	  if (file->fd != -1)
+	    {
+	      close (file->fd);
+	      file->fd = -1;
+	    }
+	  return true;
+	}
+    }
+
   /* Handle PCH files immediately; don't stack them.  */
   if (file->pchname)
     {
@@ -726,14 +826,18 @@ _cpp_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
 	deps_add_dep (pfile->deps, file->path);
     }
 
+  /* Stack the buffer, or an empty one if should_stack_file found
+     that the file need not be read.  */
+  if (file->buffer_valid)
+    buffer = cpp_push_buffer (pfile, file->buffer, file->st.st_size,
+			      CPP_OPTION (pfile, preprocessed)
+			      && !CPP_OPTION (pfile, directives_only));
+  else
+    buffer = cpp_push_buffer (pfile, (const uchar *) "\n", 0, false);
+
   /* Clear buffer_valid since _cpp_clean_line messes it up.  */
   file->buffer_valid = false;
   file->stack_count++;
-
-  /* Stack the buffer.  */
-  buffer = cpp_push_buffer (pfile, file->buffer, file->st.st_size,
-			    CPP_OPTION (pfile, preprocessed)
-			    && !CPP_OPTION (pfile, directives_only));
   buffer->file = file;
   buffer->sysp = sysp;
 
@@ -891,12 +995,29 @@ make_cpp_file (cpp_reader *pfile, cpp_dir *dir, const char *fname)
   return file;
 }
 
+/* Release the contents of FILE, which read_file_guts has either
+   allocated or mapped.  */
+static void
+free_file_buffer (_cpp_file *file)
+{
+#ifdef MMAP_THRESHOLD
+  if (file->mapped_size)
+    {
+      munmap ((void *) file->buffer_start, file->mapped_size);
+      file->mapped_size = 0;
+    }
+  else
+#endif
+    free ((void *) file->buffer_start);
+  file->buffer_start = NULL;
+}
+
 /* Release a _cpp_file structure.  */
 static void
 destroy_cpp_file (_cpp_file *file)
 {
   if (file->buffer_start)
-    free ((void *) file->buffer_start);
+    free_file_buffer (file);
   free ((void *) file->name);
   free (file);
 }
@@ -1092,6 +1213,7 @@ _cpp_cleanup_files (cpp_reader *pfile)
   obstack_free (&pfile->nonexistent_file_ob, 0);
   free_file_hash_entries (pfile);
   destroy_all_cpp_files (pfile);
+  include_cache_free (pfile);
 }
 
 /* Make the parser forget about files it has seen.  This can be useful
@@ -1256,15 +1378,18 @@ _cpp_pop_file_buffer (cpp_reader *pfile, _cpp_file *file)
   /* Record the inclusion-preventing macro, which could be NULL
      meaning no controlling macro.  */
   if (pfile->mi_valid && file->cmacro == NULL)
-    file->cmacro = pfile->mi_cmacro;
+    {
+      file->cmacro = pfile->mi_cmacro;
+      if (file->cmacro)
+	include_cache_add_guard (pfile, file);
+    }
 
   /* Invalidate control macros in the #including file.  */
   pfile->mi_valid = false;
 
   if (file->buffer_start)
     {
-      free ((void *) file->buffer_start);
-      file->buffer_start = NULL;
+      free_file_buffer (file);
       file->buffer = NULL;
       file->buffer_valid = false;
     }
@@ -1521,8 +1646,6 @@ struct pchf_data {
   struct pchf_entry entries[1];
 };
 
-static struct pchf_data *pchf;
-
 /* A qsort ordering function for pchf_entry structures.  */
 
 static int
@@ -1543,6 +1666,8 @@ _cpp_save_file_entries (cpp_reader *pfile, FILE *fp)
 
   for (f = pfile->all_files; f; f = f->next_file)
     ++count;
+  if (pchf != NULL)
+    count += pchf->count;
 
   result_size = (sizeof (struct pchf_data)
 		 + sizeof (struct pchf_entry) * (count - 1));
@@ -1551,6 +1676,16 @@ _cpp_save_file_entries (cpp_reader *pfile, FILE *fp)
   result->count = 0;
   result->have_once_only = false;
 
+  /* If this PCH is layered on one read earlier, it must also remember
+     the files seen while that one was being built.  */
+  if (pchf != NULL)
+    {
+      memcpy (result->entries, pchf->entries,
+	      pchf->count * sizeof (struct pchf_entry));
+      result->count = pchf->count;
+      result->have_once_only = pchf->have_once_only;
+    }
+
   for (f = pfile->all_files; f; f = f->next_file)
     {
       size_t count;
@@ -1691,3 +1826,746 @@ check_file_against_entries (cpp_reader *pfile ATTRIBUTE_UNUSED,
   return bsearch (&d, pchf->entries, pchf->count, sizeof (struct pchf_entry),
 		  pchf_compare) != NULL;
 }
+
+/* The persistent include cache.
+
+   With -finclude-cache=FILE, the outcome of include lookups survives
+   from one compilation to the next in FILE.  Two kinds of entry are
+   kept, both keyed by path:
+
+   - a path that did not exist, which find_file_in_dir then does not
+     try to open again.  Such an entry stays valid while the deepest
+     existing directory on the path keeps its device, inode,
+     modification and change times, since creating anything below
+     that directory changes one of them;
+
+   - the multiple-include guard of a header, which lets
+     should_stack_file skip reading the header when the guard macro is
+     already defined.  Such an entry stays valid while the header keeps
+     its device, inode, modification and change times.
+
+   A directory or file changed less than a second before it was
+   examined is not recorded, because another change within the same
+   second would go unnoticed.  Relative paths are taken relative to the
+   current directory; an entry recorded in another directory is valid
+   only if the stamp still matches.
+
+   The file is mapped and searched in place.  It holds a header, the
+   directory stamps, the entries, an open-addressed hash table of entry
+   numbers and the strings, all in host format.  cpp_finish rewrites
+   it, through a temporary file and a rename, if this compilation
+   added entries or found some out of date.  Compilations running in
+   parallel may lose each other's additions but never see a partial
+   file.  */
+
+/* The identity of a file or directory as far as the cache is
+   concerned.  */
+struct include_cache_stamp
+{
+  dev_t dev;
+  ino_t ino;
+  time_t mtime;
+  time_t ctime;
+};
+
+#define INCLUDE_CACHE_MAGIC "GCCINC1"
+
+/* The value of the DIR field of an entry for a path that exists.  */
+#define INCLUDE_CACHE_NO_DIR ((unsigned int) -1)
+
+/* Start afresh rather than let the cache grow beyond this many
+   entries.  */
+#define INCLUDE_CACHE_MAX_ENTRIES 0x40000
+
+struct include_cache_header
+{
+  char magic[8];
+  /* The sizes of the structures below, so that a cache written by a
+     different kind of host is not misread.  */
+  unsigned int dir_size;
+  unsigned int entry_size;
+  unsigned int n_dirs;
+  unsigned int n_entries;
+  /* A power of two, more than N_ENTRIES.  */
+  unsigned int n_slots;
+  unsigned int strings_size;
+};
+
+struct include_cache_dir
+{
+  struct include_cache_stamp stamp;
+  /* The offset of the directory's path in the strings.  */
+  unsigned int path;
+};
+
+struct include_cache_entry
+{
+  /* For a header with a guard, the stamp of the header.  */
+  struct include_cache_stamp stamp;
+  /* The offset of the path in the strings, and its hash.  */
+  unsigned int path;
+  unsigned int hash;
+  /* For a path that did not exist, the index of the deepest directory
+     on it that did; otherwise INCLUDE_CACHE_NO_DIR.  */
+  unsigned int dir;
+  /* For a header with a guard, the offset of the guard macro's name;
+     otherwise zero.  */
+  unsigned int macro;
+};
+
+/* A directory whose stamp this compilation has taken.  */
+struct include_cache_stamped_dir
+{
+  const char *path;
+  struct include_cache_stamp stamp;
+  /* Zero if the path is a directory, otherwise the reason why not.  */
+  int err_no;
+  /* Whether entries may depend on this directory.  */
+  bool usable;
+  /* The index of the directory in the file being written.  */
+  unsigned int index;
+};
+
+/* An entry added by this compilation.  */
+struct include_cache_new_entry
+{
+  struct include_cache_new_entry *next;
+  const char *path;
+  hashval_t hash;
+  /* As in struct include_cache_entry.  */
+  struct include_cache_stamped_dir *dir;
+  const char *macro;
+  struct include_cache_stamp stamp;
+};
+
+struct include_cache
+{
+  /* The contents of the cache file, and whether they are mapped.
+     DATA is NULL if there was no usable file.  */
+  char *data;
+  size_t size;
+  bool mapped;
+
+  /* The parts of DATA.  */
+  const struct include_cache_header *header;
+  const struct include_cache_dir *dirs;
+  const struct include_cache_entry *entries;
+  const unsigned int *slots;
+  const char *strings;
+
+  /* For each directory in the file, zero if it has not been checked
+     yet, positive if it is unchanged and negative if it changed.  */
+  signed char *dir_state;
+
+  /* For each entry in the file, whether it was found out of date.  */
+  bool *stale;
+
+  /* The directories stamped by this compilation, by path.  */
+  htab_t stamped_dirs;
+
+  /* The entries added by this compilation, newest first.  */
+  struct include_cache_new_entry *new_entries;
+
+  /* Whether the file has to be rewritten.  */
+  bool dirty;
+
+  struct obstack ob;
+};
+
+/* Set STAMP from ST.  */
+static void
+include_cache_set_stamp (struct include_cache_stamp *stamp,
+			 const struct stat *st)
+{
+  memset (stamp, 0, sizeof (*stamp));
+  stamp->dev = st->st_dev;
+  stamp->ino = st->st_ino;
+  stamp->mtime = st->st_mtime;
+  stamp->ctime = st->st_ctime;
+}
+
+/* Return true if stamps A and B are the same.  */
+static bool
+include_cache_stamp_eq (const struct include_cache_stamp *a,
+			const struct include_cache_stamp *b)
+{
+  return (a->dev == b->dev
+	  && a->ino == b->ino
+	  && a->mtime == b->mtime
+	  && a->ctime == b->ctime);
+}
+
+/* Return true if ST was changed too recently to be recorded.  */
+static bool
+include_cache_racy_p (const struct stat *st)
+{
+  time_t now = time (NULL);
+
+  return st->st_mtime >= now - 1 || st->st_ctime >= now - 1;
+}
+
+static hashval_t
+stamped_dir_hash (const void *p)
+{
+  return htab_hash_string (((const struct include_cache_stamped_dir *) p)
+			   ->path);
+}
+
+static int
+stamped_dir_eq (const void *p, const void *q)
+{
+  return !strcmp (((const struct include_cache_stamped_dir *) p)->path,
+		  (const char *) q);
+}
+
+/* Return the stamp of directory PATH, taking it if this compilation has
+   not done so yet.  */
+static struct include_cache_stamped_dir *
+include_cache_stamp_dir (struct include_cache *cache, const char *path)
+{
+  struct include_cache_stamped_dir *sd;
+  struct stat st;
+  void **slot;
+
+  slot = htab_find_slot_with_hash (cache->stamped_dirs, path,
+				   htab_hash_string (path), INSERT);
+  if (*slot)
+    return (struct include_cache_stamped_dir *) *slot;
+
+  sd = XOBNEW (&cache->ob, struct include_cache_stamped_dir);
+  memset (sd, 0, sizeof (*sd));
+  sd->path = (const char *) obstack_copy0 (&cache->ob, path, strlen (path));
+  sd->index = INCLUDE_CACHE_NO_DIR;
+  if (stat (path, &st) != 0)
+    sd->err_no = errno;
+  else if (!S_ISDIR (st.st_mode))
+    sd->err_no = ENOTDIR;
+  else
+    {
+      include_cache_set_stamp (&sd->stamp, &st);
+      sd->usable = !include_cache_racy_p (&st);
+    }
+  *slot = sd;
+  return sd;
+}
+
+/* Read or map the cache file NAME into CACHE.  */
+static void
+include_cache_load (struct include_cache *cache, const char *name)
+{
+  const struct include_cache_header *h;
+  struct stat st;
+  size_t offset;
+  int fd;
+
+  fd = open (name, O_RDONLY | O_BINARY, 0);
+  if (fd == -1)
+    return;
+
+  if (fstat (fd, &st) == 0
+      && st.st_size >= (off_t) sizeof (struct include_cache_header)
+      && st.st_size <= INTTYPE_MAXIMUM (ssize_t))
+    {
+      cache->size = st.st_size;
+#ifdef MMAP_THRESHOLD
+      cache->data = (char *) mmap (NULL, cache->size, PROT_READ, MAP_PRIVATE,
+				   fd, 0);
+      if (cache->data == (char *) MAP_FAILED)
+	cache->data = NULL;
+      else
+	cache->mapped = true;
+#endif
+      if (cache->data == NULL)
+	{
+	  cache->data = XNEWVEC (char, cache->size);
+	  if (read (fd, cache->data, cache->size) != (ssize_t) cache->size)
+	    {
+	      free (cache->data);
+	      cache->data = NULL;
+	    }
+	}
+    }
+  close (fd);
+
+  if (cache->data == NULL)
+    return;
+
+  /* Check that the parts fit together; the contents of the entries
+     are checked as they are used.  */
+  h = (const struct include_cache_header *) cache->data;
+  offset = sizeof (struct include_cache_header);
+  if (memcmp (h->magic, INCLUDE_CACHE_MAGIC, sizeof (h->magic)) == 0
+      && h->dir_size == sizeof (struct include_cache_dir)
+      && h->entry_size == sizeof (struct include_cache_entry)
+      && h->n_dirs <= INCLUDE_CACHE_MAX_ENTRIES
+      && h->n_entries <= INCLUDE_CACHE_MAX_ENTRIES
+      && h->n_slots > h->n_entries
+      && h->n_slots <= 4 * INCLUDE_CACHE_MAX_ENTRIES
+      && (h->n_slots & (h->n_slots - 1)) == 0
+      && h->strings_size > 0
+      && (offset + h->n_dirs * sizeof (struct include_cache_dir)
+	  + h->n_entries * sizeof (struct include_cache_entry)
+	  + h->n_slots * sizeof (unsigned int)
+	  + h->strings_size) == cache->size)
+    {
+      cache->header = h;
+      cache->dirs = (const struct include_cache_dir *) (cache->data + offset);
+      offset += h->n_dirs * sizeof (struct include_cache_dir);
+      cache->entries
+	= (const struct include_cache_entry *) (cache->data + offset);
+      offset += h->n_entries * sizeof (struct include_cache_entry);
+      cache->slots = (const unsigned int *) (cache->data + offset);
+      offset += h->n_slots * sizeof (unsigned int);
+      cache->strings = cache->data + offset;
+      if (cache->strings[h->strings_size - 1] == '\0')
+	{
+	  cache->dir_state = XCNEWVEC (signed char, h->n_dirs);
+	  cache->stale = XCNEWVEC (bool, h->n_entries);
+	  return;
+	}
+      cache->header = NULL;
+    }
+
+  /* Not a cache file we can use; replace it.  */
+  cache->dirty = true;
+}
+
+/* Return the include cache of PFILE, or NULL if there is none.  */
+static struct include_cache *
+include_cache_get (cpp_reader *pfile)
+{
+  struct include_cache *cache = pfile->include_cache;
+
+  if (cache == NULL && CPP_OPTION (pfile, include_cache))
+    {
+      cache = XCNEW (struct include_cache);
+      _obstack_begin (&cache->ob, 0, 0,
+		      (void *(*) (long)) xmalloc,
+		      (void (*) (void *)) free);
+      cache->stamped_dirs = htab_create_alloc (37, stamped_dir_hash,
+					       stamped_dir_eq,
+					       NULL, xcalloc, free);
+      include_cache_load (cache, CPP_OPTION (pfile, include_cache));
+      pfile->include_cache = cache;
+    }
+
+  return cache;
+}
+
+/* Return the entry of the cache file for PATH, whose hash is HASH, and
+   set *INDEX to its number, or return NULL if there is none.  */
+static const struct include_cache_entry *
+include_cache_lookup (struct include_cache *cache, const char *path,
+		      hashval_t hash, unsigned int *index)
+{
+  const struct include_cache_header *h = cache->header;
+  unsigned int mask, i, n, slot;
+
+  if (h == NULL)
+    return NULL;
+
+  mask = h->n_slots - 1;
+  for (i = hash & mask, n = 0; n < h->n_slots; i = (i + 1) & mask, n++)
+    {
+      const struct include_cache_entry *e;
+
+      slot = cache->slots[i];
+      if (slot == 0 || slot > h->n_entries)
+	break;
+
+      e = &cache->entries[slot - 1];
+      if (e->hash == hash
+	  && e->path < h->strings_size
+	  && !strcmp (cache->strings + e->path, path))
+	{
+	  *index = slot - 1;
+	  return e;
+	}
+    }
+
+  return NULL;
+}
+
+/* Return true if directory INDEX of the cache file is unchanged.  */
+static bool
+include_cache_dir_valid_p (struct include_cache *cache, unsigned int index)
+{
+  const struct include_cache_dir *d;
+  struct include_cache_stamped_dir *sd;
+
+  if (index >= cache->header->n_dirs)
+    return false;
+
+  if (cache->dir_state[index] == 0)
+    {
+      d = &cache->dirs[index];
+      cache->dir_state[index] = -1;
+      if (d->path < cache->header->strings_size)
+	{
+	  sd = include_cache_stamp_dir (cache, cache->strings + d->path);
+	  if (sd->usable && include_cache_stamp_eq (&d->stamp, &sd->stamp))
+	    cache->dir_state[index] = 1;
+	}
+      if (cache->dir_state[index] < 0)
+	cache->dirty = true;
+    }
+
+  return cache->dir_state[index] > 0;
+}
+
+/* Return true if the include cache says that PATH, whose hash is HASH,
+   does not exist.  */
+static bool
+include_cache_missing_p (cpp_reader *pfile, const char *path, hashval_t hash)
+{
+  struct include_cache *cache = include_cache_get (pfile);
+  const struct include_cache_entry *e;
+  unsigned int index;
+
+  if (cache == NULL)
+    return false;
+
+  e = include_cache_lookup (cache, path, hash, &index);
+  return (e != NULL
+	  && e->dir != INCLUDE_CACHE_NO_DIR
+	  && include_cache_dir_valid_p (cache, e->dir));
+}
+
+/* Record in the include cache that PATH, whose hash is HASH, does not
+   exist.  PATH must live as long as PFILE.  */
+static void
+include_cache_add_missing (cpp_reader *pfile, const char *path,
+			   hashval_t hash)
+{
+  struct include_cache *cache = include_cache_get (pfile);
+  struct include_cache_stamped_dir *sd;
+  struct include_cache_new_entry *ne;
+  char *dir;
+  size_t len;
+
+  if (cache == NULL)
+    return;
+
+  /* Find the deepest existing directory on PATH.  */
+  dir = xstrdup (path);
+  len = strlen (dir);
+  for (;;)
+    {
+      while (len > 0 && !IS_DIR_SEPARATOR (dir[len - 1]))
+	len--;
+      while (len > 1 && IS_DIR_SEPARATOR (dir[len - 1]))
+	len--;
+      if (len == 0)
+	sd = include_cache_stamp_dir (cache, ".");
+      else
+	{
+	  dir[len] = '\0';
+	  sd = include_cache_stamp_dir (cache, dir);
+	}
+      if (sd->err_no == 0
+	  || (sd->err_no != ENOENT && sd->err_no != ENOTDIR)
+	  || len == 0
+	  || (len == 1 && IS_DIR_SEPARATOR (dir[0])))
+	break;
+    }
+  free (dir);
+
+  if (sd->err_no != 0 || !sd->usable)
+    return;
+
+  ne = XOBNEW (&cache->ob, struct include_cache_new_entry);
+  memset (ne, 0, sizeof (*ne));
+  ne->path = path;
+  ne->hash = hash;
+  ne->dir = sd;
+  ne->next = cache->new_entries;
+  cache->new_entries = ne;
+}
+
+/* Return the multiple-include guard of FILE recorded in the include
+   cache, or NULL if there is none.  */
+static const cpp_hashnode *
+include_cache_guard (cpp_reader *pfile, _cpp_file *file)
+{
+  struct include_cache *cache = include_cache_get (pfile);
+  const struct include_cache_entry *e;
+  struct include_cache_stamp stamp;
+  const char *name;
+  unsigned int index;
+
+  if (cache == NULL || file->path[0] == '\0')
+    return NULL;
+
+  e = include_cache_lookup (cache, file->path,
+			    htab_hash_string (file->path), &index);
+  if (e == NULL
+      || e->dir != INCLUDE_CACHE_NO_DIR
+      || e->macro == 0
+      || e->macro >= cache->header->strings_size)
+    return NULL;
+
+  include_cache_set_stamp (&stamp, &file->st);
+  if (!include_cache_stamp_eq (&e->stamp, &stamp))
+    {
+      cache->stale[index] = true;
+      cache->dirty = true;
+      return NULL;
+    }
+
+  name = cache->strings + e->macro;
+  return cpp_lookup (pfile, (const unsigned char *) name, strlen (name));
+}
+
+/* Record the multiple-include guard of FILE in the include cache.  */
+static void
+include_cache_add_guard (cpp_reader *pfile, _cpp_file *file)
+{
+  struct include_cache *cache = include_cache_get (pfile);
+  struct include_cache_new_entry *ne;
+  const char *name;
+
+  if (cache == NULL
+      || file->path[0] == '\0'
+      || include_cache_racy_p (&file->st))
+    return;
+
+  name = (const char *) NODE_NAME (file->cmacro);
+  ne = XOBNEW (&cache->ob, struct include_cache_new_entry);
+  memset (ne, 0, sizeof (*ne));
+  ne->path = (const char *) obstack_copy0 (&cache->ob, file->path,
+					   strlen (file->path));
+  ne->hash = htab_hash_string (ne->path);
+  ne->macro = (const char *) obstack_copy0 (&cache->ob, name, strlen (name));
+  include_cache_set_stamp (&ne->stamp, &file->st);
+  ne->next = cache->new_entries;
+  cache->new_entries = ne;
+}
+
+static hashval_t
+new_entry_hash (const void *p)
+{
+  return ((const struct include_cache_new_entry *) p)->hash;
+}
+
+static int
+new_entry_eq (const void *p, const void *q)
+{
+  return !strcmp (((const struct include_cache_new_entry *) p)->path,
+		  (const char *) q);
+}
+
+/* Append the string S to the strings being written in OB, returning
+   its offset.  */
+static unsigned int
+include_cache_add_string (struct obstack *ob, const char *s)
+{
+  unsigned int offset = obstack_object_size (ob);
+
+  obstack_grow0 (ob, s, strlen (s));
+  return offset;
+}
+
+/* Assign an index in the file being written to directory SD, and
+   append it to OB.  */
+static unsigned int
+include_cache_add_dir (struct obstack *ob, struct obstack *strings,
+		       struct include_cache_stamped_dir *sd)
+{
+  struct include_cache_dir d;
+
+  if (sd->index == INCLUDE_CACHE_NO_DIR)
+    {
+      memset (&d, 0, sizeof (d));
+      d.stamp = sd->stamp;
+      d.path = include_cache_add_string (strings, sd->path);
+      sd->index = obstack_object_size (ob) / sizeof (d);
+      obstack_grow (ob, &d, sizeof (d));
+    }
+
+  return sd->index;
+}
+
+/* Write the include cache of PFILE back to its file, if it has
+   changed.  */
+void
+_cpp_save_include_cache (cpp_reader *pfile)
+{
+  struct include_cache *cache = pfile->include_cache;
+  const struct include_cache_header *h;
+  struct include_cache_header nh;
+  struct include_cache_new_entry *ne;
+  struct include_cache_entry *entries;
+  struct obstack dirs, strings;
+  unsigned int *slots;
+  unsigned int i, n, n_entries;
+  htab_t added;
+  char *tmp;
+  FILE *f;
+  int fd;
+  bool ok;
+
+  if (cache == NULL || (!cache->dirty && cache->new_entries == NULL))
+    return;
+
+  /* Entries added by this compilation replace those for the same
+     path in the file.  */
+  added = htab_create_alloc (127, new_entry_hash, new_entry_eq,
+			     NULL, xcalloc, free);
+  n = 0;
+  for (ne = cache->new_entries; ne; ne = ne->next)
+    {
+      void **slot = htab_find_slot_with_hash (added, ne->path, ne->hash,
+					      INSERT);
+      if (*slot == NULL)
+	{
+	  *slot = ne;
+	  n++;
+	}
+    }
+
+  h = cache->header;
+  if (h != NULL && n + h->n_entries > INCLUDE_CACHE_MAX_ENTRIES)
+    h = NULL;
+
+  _obstack_begin (&dirs, 0, 0,
+		  (void *(*) (long)) xmalloc,
+		  (void (*) (void *)) free);
+  _obstack_begin (&strings, 0, 0,
+		  (void *(*) (long)) xmalloc,
+		  (void (*) (void *)) free);
+  obstack_1grow (&strings, '\0');
+  entries = XCNEWVEC (struct include_cache_entry,
+		      n + (h ? h->n_entries : 0));
+  n_entries = 0;
+
+  /* Keep the entries of the file that are still valid.  Entries for
+     missing paths are only kept if their directory is unchanged,
+     which has to be checked now if nothing else did.  */
+  for (i = 0; h != NULL && i < h->n_entries; i++)
+    {
+      const struct include_cache_entry *e = &cache->entries[i];
+      struct include_cache_entry *out = &entries[n_entries];
+      const char *path = cache->strings + e->path;
+
+      if (cache->stale[i]
+	  || e->path >= h->strings_size
+	  || e->macro >= h->strings_size
+	  || htab_find_with_hash (added, path, e->hash) != NULL)
+	continue;
+
+      *out = *e;
+      if (e->dir != INCLUDE_CACHE_NO_DIR)
+	{
+	  if (!include_cache_dir_valid_p (cache, e->dir))
+	    continue;
+	  out->dir = include_cache_add_dir (&dirs, &strings,
+					    include_cache_stamp_dir
+					    (cache, cache->strings
+					     + cache->dirs[e->dir].path));
+	}
+      out->path = include_cache_add_string (&strings, path);
+      if (e->macro)
+	out->macro = include_cache_add_string (&strings,
+					       cache->strings + e->macro);
+      n_entries++;
+    }
+
+  for (ne = cache->new_entries; ne; ne = ne->next)
+    {
+      struct include_cache_entry *out = &entries[n_entries];
+
+      if (htab_find_with_hash (added, ne->path, ne->hash) != ne)
+	continue;
+
+      out->stamp = ne->stamp;
+      out->path = include_cache_add_string (&strings, ne->path);
+      out->hash = ne->hash;
+      out->dir = (ne->dir
+		  ? include_cache_add_dir (&dirs, &strings, ne->dir)
+		  : INCLUDE_CACHE_NO_DIR);
+      out->macro = ne->macro ? include_cache_add_string (&strings,
+							 ne->macro) : 0;
+      n_entries++;
+    }
+  htab_delete (added);
+
+  memset (&nh, 0, sizeof (nh));
+  memcpy (nh.magic, INCLUDE_CACHE_MAGIC, sizeof (nh.magic));
+  nh.dir_size = sizeof (struct include_cache_dir);
+  nh.entry_size = sizeof (struct include_cache_entry);
+  nh.n_dirs = obstack_object_size (&dirs) / sizeof (struct include_cache_dir);
+  nh.n_entries = n_entries;
+  for (nh.n_slots = 16; nh.n_slots < 2 * n_entries; nh.n_slots *= 2)
+    ;
+  nh.strings_size = obstack_object_size (&strings);
+
+  slots = XCNEWVEC (unsigned int, nh.n_slots);
+  for (i = 0; i < n_entries; i++)
+    {
+      unsigned int j = entries[i].hash & (nh.n_slots - 1);
+
+      while (slots[j] != 0)
+	j = (j + 1) & (nh.n_slots - 1);
+      slots[j] = i + 1;
+    }
+
+  /* Write a temporary file next to the cache and rename it into
+     place.  Failures are silent; the cache is only an optimization.  */
+  tmp = XNEWVEC (char, strlen (CPP_OPTION (pfile, include_cache)) + 32);
+  sprintf (tmp, "%s.%ld", CPP_OPTION (pfile, include_cache),
+	   (long) getpid ());
+  fd = open (tmp, O_WRONLY | O_CREAT | O_TRUNC | O_EXCL | O_BINARY, 0666);
+  f = fd == -1 ? NULL : fdopen (fd, "wb");
+  if (f != NULL)
+    {
+      ok = (fwrite (&nh, sizeof (nh), 1, f) == 1
+	    && fwrite (obstack_base (&dirs), 1, obstack_object_size (&dirs), f)
+	       == (size_t) obstack_object_size (&dirs)
+	    && fwrite (entries, sizeof (struct include_cache_entry),
+		       n_entries, f) == n_entries
+	    && fwrite (slots, sizeof (unsigned int), nh.n_slots, f)
+	       == nh.n_slots
+	    && fwrite (obstack_base (&strings), 1, nh.strings_size, f)
+	       == nh.strings_size);
+      if (fclose (f) != 0
+	  || !ok
+	  || rename (tmp, CPP_OPTION (pfile, include_cache)) != 0)
+	unlink (tmp);
+    }
+  else if (fd != -1)
+    {
+      close (fd);
+      unlink (tmp);
+    }
+
+  free (tmp);
+  free (slots);
+  free (entries);
+  obstack_free (&dirs, 0);
+  obstack_free (&strings, 0);
+  cache->dirty = false;
+  cache->new_entries = NULL;
+}
+
+/* Release the include cache of PFILE.  */
+static void
+include_cache_free (cpp_reader *pfile)
+{
+  struct include_cache *cache = pfile->include_cache;
+
+  if (cache == NULL)
+    return;
+
+#ifdef MMAP_THRESHOLD
+  if (cache->mapped)
+    munmap (cache->data, cache->size);
+  else
+#endif
+    free (cache->data);
+  free (cache->dir_state);
+  free (cache->stale);
+  htab_delete (cache->stamped_dirs);
+  obstack_free (&cache->ob, 0);
+  free (cache);
+  pfile->include_cache = NULL;
+}
@@ -102,6 +102,8 @@ cpp_defined (cpp_reader *pfile, const unsigned char *str, int len)
   cpp_hashnode *node;
 
   node = CPP_HASHNODE (ht_lookup (pfile->hash_table, str, len, HT_NO_INSERT));
+  if (node && (node->flags & NODE_LAZY))
+    _cpp_define_lazy_macro (pfile, node);
 
   /* If it's of type NT_MACRO, it cannot be poisoned.  */
   return node && node->type == NT_MACRO;
@@ -113,9 +115,11 @@ cpp_defined (cpp_reader *pfile, const unsigned char *str, int len)
 extern char proxy_assertion_broken[offsetof (struct cpp_hashnode, ident) == 0 ? 1 : -1];
 
 /* For all nodes in the hashtable, callback CB with parameters PFILE,
-   the node, and V.  */
+   the node, and V.  Lazy macros are defined first, so that CB sees
+   every macro.  */
 void
 cpp_forall_identifiers (cpp_reader *pfile, cpp_cb cb, void *v)
 {
+  _cpp_define_lazy_macros (pfile);
   ht_forall (pfile->hash_table, (ht_cb) cb, v);
 }
@@ -75,4 +75,8 @@ struct cpp_macro GTY(())
 
   /* Indicate which field of 'exp' is in use.  */
   unsigned int traditional : 1;
+
+  /* The full expansion of an object-like macro, kept from an earlier
+     use; see enter_macro_context.  Not saved in a PCH.  */
+  struct cpp_expansion * GTY ((skip)) expansion;
 };
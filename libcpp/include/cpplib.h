@@ -420,6 +420,10 @@ struct cpp_options
   /* Holds the name of the input character set.  */
   const char *input_charset;
 
+  /* The file in which to keep the results of include lookups between
+     compilations, or NULL.  */
+  const char *include_cache;
+
   /* The minimum permitted level of normalization before a warning
      is generated.  */
   enum cpp_normalize_level warn_normalize;
@@ -517,6 +521,10 @@ struct cpp_callbacks
   /* Called before #define and #undef or other macro definition
      changes are processed.  */
   void (*before_define) (cpp_reader *);
+
+  /* Returns the expansion of a macro registered with
+     cpp_define_computed, the first time the macro is needed.  */
+  const char *(*compute_macro) (cpp_reader *, cpp_hashnode *);
 };
 
 /* Chain of directories to look for include files in.  */
@@ -581,6 +589,8 @@ extern const char *progname;
 #define NODE_USED	(1 << 7)	/* Dumped with -dU.  */
 #define NODE_CONDITIONAL (1 << 8)	/* Conditional macro */
 #define NODE_TUP 	(1 << 9)	/* Node checked with tup */
+#define NODE_IN_EXPANSION (1 << 10)	/* Seen by a kept macro expansion.  */
+#define NODE_LAZY	(1 << 11)	/* Macro defined when first needed.  */
 
 /* Different flavors of hash node.  */
 enum node_type
@@ -653,7 +663,7 @@ struct cpp_hashnode GTY(())
 					   Otherwise, a NODE_OPERATOR.  */
   unsigned char rid_code;		/* Rid code - for front ends.  */
   ENUM_BITFIELD(node_type) type : 7;	/* CPP node type.  */
-  unsigned int flags : 10;		/* CPP flags.  */
+  unsigned int flags : 12;		/* CPP flags.  */
 
   union _cpp_hashnode_value GTY ((desc ("CPP_HASHNODE_VALUE_IDX (%1)"))) value;
 };
@@ -761,6 +771,8 @@ extern cppchar_t cpp_host_to_exec_charset (cpp_reader *, cppchar_t);
 extern void cpp_define (cpp_reader *, const char *);
 extern void cpp_define_formatted (cpp_reader *pfile, 
 				  const char *fmt, ...) ATTRIBUTE_PRINTF_2;
+extern void cpp_define_lazily (cpp_reader *, const char *);
+extern void cpp_define_computed (cpp_reader *, const char *);
 extern void cpp_assert (cpp_reader *, const char *);
 extern void cpp_undef (cpp_reader *, const char *);
 extern void cpp_unassert (cpp_reader *, const char *);
@@ -929,6 +941,7 @@ extern void cpp_scan_nooutput (cpp_reader *);
 extern int  cpp_sys_macro_p (cpp_reader *);
 extern unsigned char *cpp_quote_string (unsigned char *, const unsigned char *,
 					unsigned int);
+extern void cpp_dump_statistics (cpp_reader *);
 
 /* In files.c */
 extern bool cpp_included (cpp_reader *, const char *);
@@ -25,6 +25,7 @@ along with this program; see the file COPYING3.  If not see
 #include "cpplib.h"
 #include "internal.h"
 #include "mkdeps.h"
+#include "hashtab.h"
 
 static void init_library (void);
 static void mark_named_operators (cpp_reader *);
@@ -131,6 +132,9 @@ init_library (void)
 	 initializers.  */
       init_trigraph_map ();
 
+      /* Choose the scanners used by the lexer.  */
+      _cpp_init_lexer ();
+
 #ifdef ENABLE_NLS
        (void) bindtextdomain (PACKAGE, LOCALEDIR);
 #endif
@@ -266,6 +270,8 @@ cpp_destroy (cpp_reader *pfile)
     deps_free (pfile->deps);
   obstack_free (&pfile->buffer_ob, 0);
 
+  if (pfile->lazy_macros)
+    htab_delete (pfile->lazy_macros);
   _cpp_destroy_hashtable (pfile);
   _cpp_cleanup_files (pfile);
   _cpp_destroy_iconv (pfile);
@@ -635,6 +641,9 @@ cpp_finish (cpp_reader *pfile, FILE *deps_stream)
   while (pfile->buffer)
     _cpp_pop_buffer (pfile);
 
+  /* Keep what we learnt about the include path for next time.  */
+  _cpp_save_include_cache (pfile);
+
   /* Don't write the deps file if there are errors.  */
   if (CPP_OPTION (pfile, deps.style) != DEPS_NONE
       && deps_stream && pfile->errors == 0)
@@ -367,6 +367,9 @@ struct cpp_reader
   struct htab *nonexistent_file_hash;
   struct obstack nonexistent_file_ob;
 
+  /* The persistent include cache, if it has been opened.  */
+  struct include_cache *include_cache;
+
   /* Nonzero means don't look for #include "foo" the source-file
      directory.  */
   bool quote_ignores_source_dir;
@@ -472,6 +475,19 @@ struct cpp_reader
   /* Next value of __COUNTER__ macro. */
   unsigned int counter;
 
+  /* Bumped when a macro whose definition a kept expansion depends on
+     is defined or undefined, which makes every kept expansion stale.
+     See enter_macro_context.  */
+  unsigned int expansion_epoch;
+
+  /* Number of object-like macro expansions kept, and used again.  */
+  unsigned int expansions_kept;
+  unsigned int expansions_reused;
+
+  /* Macros registered with cpp_define_lazily or cpp_define_computed
+     and not defined yet, keyed by their node.  */
+  struct htab *lazy_macros;
+
   /* Table of comments, when state.save_comments is true.  */
   cpp_comment_table comments;
 };
@@ -522,7 +538,9 @@ cpp_in_primary_file (cpp_reader *pfile)
 }
 
 /* In macro.c */
-extern void _cpp_free_definition (cpp_hashnode *);
+extern void _cpp_free_definition (cpp_reader *, cpp_hashnode *);
+extern void _cpp_invalidate_expansions (cpp_reader *, cpp_hashnode *);
+extern void _cpp_forget_expansions (cpp_reader *);
 extern bool _cpp_create_definition (cpp_reader *, cpp_hashnode *);
 extern void _cpp_pop_context (cpp_reader *);
 extern void _cpp_push_text_context (cpp_reader *, cpp_hashnode *,
@@ -559,12 +577,14 @@ extern void _cpp_pop_file_buffer (cpp_reader *, struct _cpp_file *);
 extern bool _cpp_save_file_entries (cpp_reader *pfile, FILE *f);
 extern bool _cpp_read_file_entries (cpp_reader *, FILE *);
 extern struct stat *_cpp_get_file_stat (_cpp_file *);
+extern void _cpp_save_include_cache (cpp_reader *);
 
 /* In expr.c */
 extern bool _cpp_parse_expr (cpp_reader *, bool);
 extern struct op *_cpp_expand_op_stack (cpp_reader *);
 
 /* In lex.c */
+extern void _cpp_init_lexer (void);
 extern void _cpp_process_line_notes (cpp_reader *, int);
 extern void _cpp_clean_line (cpp_reader *);
 extern bool _cpp_get_fresh_line (cpp_reader *);
@@ -582,6 +602,8 @@ extern void _cpp_maybe_push_include_file (cpp_reader *);
 extern int _cpp_test_assertion (cpp_reader *, unsigned int *);
 extern int _cpp_handle_directive (cpp_reader *, int);
 extern void _cpp_define_builtin (cpp_reader *, const char *);
+extern void _cpp_define_lazy_macro (cpp_reader *, cpp_hashnode *);
+extern void _cpp_define_lazy_macros (cpp_reader *);
 extern char ** _cpp_save_pragma_names (cpp_reader *);
 extern void _cpp_restore_pragma_names (cpp_reader *, char **);
 extern int _cpp_do__Pragma (cpp_reader *);
@@ -642,6 +664,7 @@ extern cppchar_t _cpp_valid_ucn (cpp_reader *, const unsigned char **,
 				 const unsigned char *, int,
 				 struct normalize_state *state);
 extern void _cpp_destroy_iconv (cpp_reader *);
+extern bool _cpp_input_needs_conversion (const char *);
 extern unsigned char *_cpp_convert_input (cpp_reader *, const char *,
 					  unsigned char *, size_t, size_t,
 					  const unsigned char **, off_t *);
@@ -97,6 +97,161 @@ add_line_note (cpp_buffer *buffer, const uchar *pos, unsigned int type)
   buffer->notes_used++;
 }
 
+/* Fast scanning for the next interesting character.
+
+   _cpp_clean_line stops at '\n', '\r', '\\' and '?', and
+   _cpp_skip_block_comment at '/' and '\n'.  In typical code these
+   are many bytes apart, so both first skip to the next such character
+   with a scanner that looks at a whole word or vector at a time.
+   Every line ends in a newline, so the scanners need no end pointer.
+   They read only aligned words, which may extend past the end of the
+   buffer but never into another page.  */
+
+enum search_kind
+{
+  SEARCH_LINE,
+  SEARCH_COMMENT,
+  SEARCH_MAX
+};
+
+/* The characters each kind of search stops at, repeated to make
+   up four.  */
+static const uchar search_chars[SEARCH_MAX][4] = {
+  { '\n', '\r', '\\', '?' },
+  { '\n', '/', '/', '/' }
+};
+
+/* Return true if C is one of the characters in CHARS.  */
+static inline bool
+search_char_p (uchar c, const uchar *chars)
+{
+  return c == chars[0] || c == chars[1] || c == chars[2] || c == chars[3];
+}
+
+#if GCC_VERSION >= 3003
+typedef unsigned long search_word __attribute__ ((__may_alias__));
+#else
+typedef unsigned long search_word;
+#endif
+
+/* SEARCH_CHARS, each replicated to all bytes of a word.  */
+static search_word search_words[SEARCH_MAX][4];
+
+#define SEARCH_ONES (~(search_word) 0 / 0xff)
+#define SEARCH_HAS_ZERO(X) (((X) - SEARCH_ONES) & ~(X) & (SEARCH_ONES << 7))
+
+/* Return the first character of kind KIND at or after S, looking at a
+   word at a time.  A byte of a word is zero iff it matches after an
+   exclusive or with the replicated character; SEARCH_HAS_ZERO never
+   misses a zero byte and never reports one in a word without one.  */
+static const uchar *
+search_acc_char (const uchar *s, enum search_kind kind)
+{
+  const uchar *chars = search_chars[kind];
+  const search_word *repl = search_words[kind];
+  const search_word *p;
+  search_word val;
+
+  while ((size_t) s % sizeof (search_word) != 0)
+    {
+      if (search_char_p (*s, chars))
+	return s;
+      s++;
+    }
+
+  for (p = (const search_word *) s; ; p++)
+    {
+      val = *p;
+      if (SEARCH_HAS_ZERO (val ^ repl[0]) | SEARCH_HAS_ZERO (val ^ repl[1])
+	  | SEARCH_HAS_ZERO (val ^ repl[2]) | SEARCH_HAS_ZERO (val ^ repl[3]))
+	break;
+    }
+
+  for (s = (const uchar *) p; !search_char_p (*s, chars); s++)
+    ;
+  return s;
+}
+
+#if (defined (__i386__) || defined (__x86_64__)) \
+    && (defined (__SSE2__) || GCC_VERSION >= 4004)
+#define HAVE_SEARCH_SSE2 1
+#ifndef __SSE2__
+#include "../gcc/config/i386/cpuid.h"
+#endif
+
+typedef char search_v16qi __attribute__ ((__vector_size__ (16)));
+
+/* SEARCH_CHARS, each replicated to all bytes of a vector.  */
+static search_v16qi search_vectors[SEARCH_MAX][4];
+
+/* Likewise, looking at 16 bytes at a time with SSE2 byte compares.  */
+static const uchar *
+#ifndef __SSE2__
+__attribute__ ((__target__ ("sse2")))
+#endif
+search_sse2 (const uchar *s, enum search_kind kind)
+{
+  const search_v16qi *repl = search_vectors[kind];
+  unsigned int misalign = (size_t) s & 15;
+  const search_v16qi *p = (const search_v16qi *) (s - misalign);
+  search_v16qi t;
+  unsigned int found;
+
+  /* Ignore the bytes before S in the first block.  */
+  t = __builtin_ia32_pcmpeqb128 (*p, repl[0]);
+  t |= __builtin_ia32_pcmpeqb128 (*p, repl[1]);
+  t |= __builtin_ia32_pcmpeqb128 (*p, repl[2]);
+  t |= __builtin_ia32_pcmpeqb128 (*p, repl[3]);
+  found = __builtin_ia32_pmovmskb128 (t) & (-1U << misalign);
+
+  while (found == 0)
+    {
+      p++;
+      t = __builtin_ia32_pcmpeqb128 (*p, repl[0]);
+      t |= __builtin_ia32_pcmpeqb128 (*p, repl[1]);
+      t |= __builtin_ia32_pcmpeqb128 (*p, repl[2]);
+      t |= __builtin_ia32_pcmpeqb128 (*p, repl[3]);
+      found = __builtin_ia32_pmovmskb128 (t);
+    }
+
+  return (const uchar *) p + __builtin_ctz (found);
+}
+#endif
+
+/* The scanner to use, chosen by _cpp_init_lexer.  */
+static const uchar *(*search_fast) (const uchar *, enum search_kind)
+  = search_acc_char;
+
+/* Set up the scanners and pick the fastest one this host supports.  */
+void
+_cpp_init_lexer (void)
+{
+  unsigned int kind, i;
+
+  for (kind = 0; kind < SEARCH_MAX; kind++)
+    for (i = 0; i < 4; i++)
+      {
+	search_words[kind][i] = search_chars[kind][i] * SEARCH_ONES;
+#ifdef HAVE_SEARCH_SSE2
+	memset (&search_vectors[kind][i], search_chars[kind][i],
+		sizeof (search_v16qi));
+#endif
+      }
+
+#ifdef HAVE_SEARCH_SSE2
+#ifdef __SSE2__
+  search_fast = search_sse2;
+#else
+  {
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid (1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2))
+      search_fast = search_sse2;
+  }
+#endif
+#endif
+}
+
 /* Returns with a logical line that contains no escaped newlines or
    trigraphs.  This is a time-critical inner loop.  */
 void
@@ -121,7 +276,8 @@ _cpp_clean_line (cpp_reader *pfile)
 	 data back to memory until we have to.  */
       for (;;)
 	{
-	  c = *++s;
+	  s = search_fast (s + 1, SEARCH_LINE);
+	  c = *s;
 	  if (__builtin_expect (c == '\n', false)
 	      || __builtin_expect (c == '\r', false))
 	    {
@@ -227,7 +383,10 @@ _cpp_clean_line (cpp_reader *pfile)
     }
 
  done:
-  *d = '\n';
+  /* Most lines already end in a plain newline; not storing it again
+     keeps the pages of a mapped file shared.  */
+  if (*d != '\n')
+    *d = '\n';
   /* A sentinel note that should never be processed.  */
   add_line_note (buffer, d + 1, '\n');
   buffer->next_line = s + 1;
@@ -340,6 +499,7 @@ _cpp_skip_block_comment (cpp_reader *pfile)
     {
       /* People like decorating comments with '*', so check for '/'
 	 instead for efficiency.  */
+      cur = search_fast (cur, SEARCH_COMMENT);
       c = *cur++;
 
       if (c == '/')
@@ -1140,7 +1300,7 @@ _cpp_lex_direct (cpp_reader *pfile)
 	      const char *var;
 	      cpp_hashnode *node = result->val.node;
 
-	      if(node->type == NT_VOID && ! (node->flags & NODE_TUP)) {
+	      if(node->type == NT_VOID && ! (node->flags & (NODE_TUP | NODE_LAZY))) {
 		      node->flags |= NODE_TUP;
 		      var = (const char*)cpp_token_as_text(pfile, result);
 		      if(CPP_OPTION(pfile, tup_linux) && strncmp(var, "CONFIG_", 7) == 0) {
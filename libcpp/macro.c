@@ -39,10 +39,30 @@ struct macro_arg
   unsigned int expanded_count;	/* # of tokens in expanded argument.  */
 };
 
+/* The full expansion of an object-like macro, kept so that later uses
+   of the macro need not expand the macros in its replacement list
+   again.  It is used while pfile->expansion_epoch has not changed.  */
+struct cpp_expansion
+{
+  unsigned int epoch;
+  unsigned int count;
+  /* The tokens cpp_get_token returned for the replacement list,
+     padding included.  */
+  cpp_token tokens[1];
+};
+
+#define EXPANSION_SIZE(COUNT) \
+  (offsetof (struct cpp_expansion, tokens) + (COUNT) * sizeof (cpp_token))
+
 /* Macro expansion.  */
 
 static int enter_macro_context (cpp_reader *, cpp_hashnode *,
 				const cpp_token *);
+static bool expansion_can_be_kept_p (cpp_reader *, const cpp_macro *);
+static struct cpp_expansion *keep_expansion (cpp_reader *, cpp_hashnode *);
+static const struct cpp_expansion *kept_expansion (cpp_reader *,
+						   cpp_hashnode *);
+static int forget_expansion (cpp_reader *, cpp_hashnode *, void *);
 static int builtin_macro (cpp_reader *, cpp_hashnode *);
 static void push_ptoken_context (cpp_reader *, cpp_hashnode *, _cpp_buff *,
 				 const cpp_token **, unsigned int);
@@ -872,7 +892,18 @@ enter_macro_context (cpp_reader *pfile, cpp_hashnode *node,
       macro->used = 1;
 
       if (macro->paramc == 0)
-	_cpp_push_token_context (pfile, node, macro->exp.tokens, macro->count);
+	{
+	  const struct cpp_expansion *expansion = NULL;
+
+	  if (!macro->fun_like)
+	    expansion = kept_expansion (pfile, node);
+	  if (expansion)
+	    _cpp_push_token_context (pfile, node, expansion->tokens,
+				     expansion->count);
+	  else
+	    _cpp_push_token_context (pfile, node, macro->exp.tokens,
+				     macro->count);
+	}
 
       if (pragma_buff)
 	{
@@ -900,6 +931,166 @@ enter_macro_context (cpp_reader *pfile, cpp_hashnode *node,
   return builtin_macro (pfile, node);
 }
 
+/* Return true if the expansion of the object-like MACRO can be kept
+   for later uses.  It can if the macros in its replacement list are
+   object-like macros whose expansions are kept: then expanding it
+   reads no tokens from beyond it, pastes none, and gives no macro
+   names, so the result does not depend on where it is used.  */
+static bool
+expansion_can_be_kept_p (cpp_reader *pfile, const cpp_macro *macro)
+{
+  unsigned int i;
+
+  for (i = 0; i < macro->count; i++)
+    {
+      const cpp_token *token = &macro->exp.tokens[i];
+      const cpp_hashnode *node;
+      const struct cpp_expansion *expansion;
+
+      if (token->flags & (PASTE_LEFT | NO_EXPAND))
+	return false;
+      if (token->type != CPP_NAME)
+	continue;
+
+      node = token->val.node;
+      if (node->flags & NODE_LAZY)
+	return false;
+      if (node->type != NT_MACRO)
+	continue;
+      if (node->flags & (NODE_BUILTIN | NODE_CONDITIONAL | NODE_DISABLED)
+	  || node->value.macro->fun_like)
+	return false;
+
+      expansion = node->value.macro->expansion;
+      if (expansion == NULL || expansion->epoch != pfile->expansion_epoch)
+	return false;
+    }
+
+  return true;
+}
+
+/* Expand the object-like macro of NODE, which is disabled, and keep
+   the result with the macro.  Identifiers in the replacement list and
+   in the result are marked, so that defining or undefining any of them
+   makes the result stale.  Return the result.  */
+static struct cpp_expansion *
+keep_expansion (cpp_reader *pfile, cpp_hashnode *node)
+{
+  cpp_macro *macro = node->value.macro;
+  cpp_context *base = pfile->context;
+  struct cpp_expansion *expansion;
+  unsigned int capacity, i;
+
+  capacity = macro->count + 1;
+  expansion = (struct cpp_expansion *) xmalloc (EXPANSION_SIZE (capacity));
+  expansion->epoch = pfile->expansion_epoch;
+  expansion->count = 0;
+
+  /* Popping the context re-enables the macro, and returns the token
+     that avoids a paste after it, which is not part of the expansion.  */
+  _cpp_push_token_context (pfile, node, macro->exp.tokens, macro->count);
+  for (;;)
+    {
+      const cpp_token *token = cpp_get_token (pfile);
+
+      if (pfile->context == base)
+	break;
+
+      if (expansion->count == capacity)
+	{
+	  capacity *= 2;
+	  expansion = (struct cpp_expansion *)
+	    xrealloc (expansion, EXPANSION_SIZE (capacity));
+	}
+      expansion->tokens[expansion->count++] = *token;
+    }
+  node->flags |= NODE_DISABLED;
+
+  for (i = 0; i < macro->count; i++)
+    if (macro->exp.tokens[i].type == CPP_NAME)
+      macro->exp.tokens[i].val.node->flags |= NODE_IN_EXPANSION;
+  for (i = 0; i < expansion->count; i++)
+    if (expansion->tokens[i].type == CPP_NAME)
+      expansion->tokens[i].val.node->flags |= NODE_IN_EXPANSION;
+
+  if (macro->expansion)
+    free (macro->expansion);
+  macro->expansion = expansion;
+  pfile->expansions_kept++;
+  return expansion;
+}
+
+/* Return the kept expansion of the object-like macro of NODE, which
+   is disabled, making it now if it can be kept.  Return NULL if the
+   macro has to be expanded from its replacement list.  */
+static const struct cpp_expansion *
+kept_expansion (cpp_reader *pfile, cpp_hashnode *node)
+{
+  cpp_macro *macro = node->value.macro;
+
+  /* In a directive, the end of the expansion is not seen by
+     keep_expansion: cpp_get_token goes on to the next token.  Nor can
+     a kept expansion be used there, since it holds the padding that
+     cpp_get_token does not return in directives.  */
+  if (pfile->state.in_directive)
+    return NULL;
+
+  if (macro->expansion && macro->expansion->epoch == pfile->expansion_epoch)
+    {
+      pfile->expansions_reused++;
+      return macro->expansion;
+    }
+
+  if (!expansion_can_be_kept_p (pfile, macro))
+    return NULL;
+
+  return keep_expansion (pfile, node);
+}
+
+/* Make the kept expansions stale if any of them depends on the
+   definition of NODE, which is about to change.  */
+void
+_cpp_invalidate_expansions (cpp_reader *pfile, cpp_hashnode *node)
+{
+  if (node->flags & NODE_IN_EXPANSION)
+    {
+      node->flags &= ~NODE_IN_EXPANSION;
+      pfile->expansion_epoch++;
+    }
+}
+
+/* Free the kept expansion of the macro of NODE, if any.  Suitable for
+   being called by cpp_forall_identifiers.  */
+static int
+forget_expansion (cpp_reader *pfile ATTRIBUTE_UNUSED, cpp_hashnode *node,
+		  void *data ATTRIBUTE_UNUSED)
+{
+  if (node->type == NT_MACRO && !(node->flags & NODE_BUILTIN)
+      && node->value.macro->expansion)
+    {
+      free (node->value.macro->expansion);
+      node->value.macro->expansion = NULL;
+    }
+  return 1;
+}
+
+/* Free all the kept expansions, which a PCH cannot hold.  */
+void
+_cpp_forget_expansions (cpp_reader *pfile)
+{
+  cpp_forall_identifiers (pfile, forget_expansion, NULL);
+}
+
+/* Dump statistics about macro expansion to stderr.  */
+void
+cpp_dump_statistics (cpp_reader *pfile)
+{
+  fprintf (stderr, "\nObject-like macro expansions\n");
+  fprintf (stderr, "kept\t\t%u\n", pfile->expansions_kept);
+  fprintf (stderr, "reused\t\t%u\n", pfile->expansions_reused);
+  fprintf (stderr, "made stale\t%u times\n", pfile->expansion_epoch);
+}
+
 /* Replace the parameters in a function-like macro of NODE with the
    actual ARGS, and place the result in a newly pushed token context.
    Expand each argument before replacing, unless it is operated upon
@@ -1246,7 +1437,12 @@ cpp_get_token (cpp_reader *pfile)
       node = result->val.node;
 
       if (node->type != NT_MACRO || (result->flags & NO_EXPAND))
-	break;
+	{
+	  /* A lazy macro is defined when it could first be expanded.  */
+	  if (!(node->flags & NODE_LAZY) || pfile->state.prevent_expansion)
+	    break;
+	  _cpp_define_lazy_macro (pfile, node);
+	}
 
       if (!(node->flags & NODE_DISABLED))
 	{
@@ -1463,9 +1659,13 @@ warn_of_redefinition (cpp_reader *pfile, const cpp_hashnode *node,
 
 /* Free the definition of hashnode H.  */
 void
-_cpp_free_definition (cpp_hashnode *h)
+_cpp_free_definition (cpp_reader *pfile, cpp_hashnode *h)
 {
-  /* Macros and assertions no longer have anything to free.  */
+  _cpp_invalidate_expansions (pfile, h);
+
+  /* Apart from a kept expansion, macros and assertions no longer
+     have anything to free.  */
+  forget_expansion (pfile, h, NULL);
   h->type = NT_VOID;
   /* Clear builtin flag in case of redefinition.  */
   h->flags &= ~(NODE_BUILTIN | NODE_DISABLED | NODE_USED);
@@ -1801,6 +2001,7 @@ _cpp_create_definition (cpp_reader *pfile, cpp_hashnode *node)
   macro->used = !CPP_OPTION (pfile, warn_unused_macros);
   macro->count = 0;
   macro->fun_like = 0;
+  macro->expansion = NULL;
   /* To suppress some diagnostics.  */
   macro->syshdr = pfile->buffer && pfile->buffer->sysp != 0;
 
@@ -1847,8 +2048,9 @@ _cpp_create_definition (cpp_reader *pfile, cpp_hashnode *node)
 	}
     }
 
+  _cpp_invalidate_expansions (pfile, node);
   if (node->type != NT_VOID)
-    _cpp_free_definition (node);
+    _cpp_free_definition (pfile, node);
 
   /* Enter definition in hash table.  */
   node->type = NT_MACRO;
@@ -24,14 +24,15 @@ along with this program; see the file COPYING3.  If not see
 #include "mkdeps.h"
 
 static int write_macdef (cpp_reader *, cpp_hashnode *, void *);
+static void save_ident_name (struct cpp_savedstate *, cpp_hashnode *);
 static int save_idents (cpp_reader *, cpp_hashnode *, void *);
+static int save_layer_idents (cpp_reader *, cpp_hashnode *, void *);
 static hashval_t hashmem (const void *, size_t);
 static hashval_t cpp_string_hash (const void *);
 static int cpp_string_eq (const void *, const void *);
 static int count_defs (cpp_reader *, cpp_hashnode *, void *);
-static int comp_hashnodes (const void *, const void *);
-static int collect_ht_nodes (cpp_reader *, cpp_hashnode *, void *);
 static int write_defs (cpp_reader *, cpp_hashnode *, void *);
+static int check_undefs (cpp_reader *, cpp_hashnode *, void *);
 static int save_macros (cpp_reader *, cpp_hashnode *, void *);
 
 /* This structure represents a macro definition on disk.  */
@@ -109,13 +110,38 @@ struct cpp_savedstate
   size_t hashsize;
   /* Number of definitions */
   size_t n_defs;
-  /* Array of definitions.  In cpp_write_pch_deps it is used for sorting.  */
+  /* Array of definitions, collected by cpp_write_pch_deps.  */
   cpp_hashnode **defs;
   /* Space for the next definition.  Definitions are null-terminated
      strings.  */
   unsigned char *definedstrs;
 };
 
+/* Put the name of HN in the hash table of SS.  */
+
+static void
+save_ident_name (struct cpp_savedstate *ss, cpp_hashnode *hn)
+{
+  struct cpp_string news;
+  void **slot;
+
+  news.len = NODE_LEN (hn);
+  news.text= NODE_NAME (hn);
+  slot = htab_find_slot (ss->definedhash, &news, INSERT);
+  if (*slot == NULL)
+    {
+      struct cpp_string *sp;
+      unsigned char *text;
+
+      sp = XNEW (struct cpp_string);
+      *slot = sp;
+
+      sp->len = NODE_LEN (hn);
+      sp->text = text = XNEWVEC (unsigned char, NODE_LEN (hn));
+      memcpy (text, NODE_NAME (hn), NODE_LEN (hn));
+    }
+}
+
 /* Save this identifier into the state: put it in the hash table,
    put the definition in 'definedstrs'.  */
 
@@ -125,26 +151,26 @@ save_idents (cpp_reader *pfile ATTRIBUTE_UNUSED, cpp_hashnode *hn, void *ss_p)
   struct cpp_savedstate *const ss = (struct cpp_savedstate *)ss_p;
 
   if (hn->type != NT_VOID)
-    {
-      struct cpp_string news;
-      void **slot;
+    save_ident_name (ss, hn);
 
-      news.len = NODE_LEN (hn);
-      news.text= NODE_NAME (hn);
-      slot = htab_find_slot (ss->definedhash, &news, INSERT);
-      if (*slot == NULL)
-	{
-	  struct cpp_string *sp;
-	  unsigned char *text;
+  return 1;
+}
 
-	  sp = XNEW (struct cpp_string);
-	  *slot = sp;
+/* A precompiled header has just been read while another is being
+   written, which will be layered on it.  The identifiers it knows
+   about are checked when it is validated, which a layered header
+   requires, so leave them out of the list written by
+   cpp_write_pch_deps.  */
 
-	  sp->len = NODE_LEN (hn);
-	  sp->text = text = XNEWVEC (unsigned char, NODE_LEN (hn));
-	  memcpy (text, NODE_NAME (hn), NODE_LEN (hn));
-	}
-    }
+static int
+save_layer_idents (cpp_reader *pfile ATTRIBUTE_UNUSED, cpp_hashnode *hn,
+		   void *ss_p)
+{
+  struct cpp_savedstate *const ss = (struct cpp_savedstate *)ss_p;
+
+  if (hn->type == NT_VOID
+      || (hn->type == NT_MACRO && !(hn->flags & NODE_BUILTIN)))
+    save_ident_name (ss, hn);
 
   return 1;
 }
@@ -283,15 +309,30 @@ write_defs (cpp_reader *pfile ATTRIBUTE_UNUSED, cpp_hashnode *hn, void *ss_p)
     }
 }
 
-/* Comparison function for qsort.  The arguments point to pointers of
-   type ht_hashnode *.  */
-static int
-comp_hashnodes (const void *px, const void *py)
+/* The identifiers that must not be defined when a PCH is used are
+   written as a list of null-terminated strings, followed by an open
+   addressing hash table of them so that checking the identifiers
+   defined when it is validated does not need to look at the rest.
+   Each slot holds the hash value of an identifier, as computed by the
+   identifier hash table, and one more than its offset in the list, or
+   zero if the slot is empty.  */
+
+struct undef_slot
 {
-  cpp_hashnode *x = *(cpp_hashnode **) px;
-  cpp_hashnode *y = *(cpp_hashnode **) py;
-  return ustrcmp (NODE_NAME (x), NODE_NAME (y));
-}
+  unsigned int hash;
+  unsigned int offset;
+};
+
+/* The parameters for check_undefs.  */
+
+struct undef_index
+{
+  const unsigned char *strs;
+  const struct undef_slot *slots;
+  unsigned int mask;
+  /* The first identifier found to be defined, if any.  */
+  cpp_hashnode *found;
+};
 
 /* Write out the remainder of the dependency information.  This should be
    called after the PCH is ready to be saved.  */
@@ -302,8 +343,13 @@ cpp_write_pch_deps (cpp_reader *r, FILE *f)
   struct macrodef_struct z;
   struct cpp_savedstate *const ss = r->savedstate;
   unsigned char *definedstrs;
+  struct undef_slot *slots;
+  unsigned int n_slots;
   size_t i;
 
+  /* The expansions kept with macros are not saved.  */
+  _cpp_forget_expansions (r);
+
   /* Collect the list of identifiers which have been seen and
      weren't defined to anything previously.  */
   ss->hashsize = 0;
@@ -314,12 +360,25 @@ cpp_write_pch_deps (cpp_reader *r, FILE *f)
   ss->n_defs = 0;
   cpp_forall_identifiers (r, write_defs, ss);
 
-  /* Sort the list, copy it into a buffer, and write it out.  */
-  qsort (ss->defs, ss->n_defs, sizeof (cpp_hashnode *), &comp_hashnodes);
+  /* Copy the list into a buffer and index it, keeping the table at
+     most half full.  */
+  n_slots = 0;
+  if (ss->n_defs != 0)
+    for (n_slots = 16; n_slots < 2 * ss->n_defs; n_slots *= 2)
+      ;
+  slots = XCNEWVEC (struct undef_slot, n_slots);
   definedstrs = ss->definedstrs = XNEWVEC (unsigned char, ss->hashsize);
   for (i = 0; i < ss->n_defs; ++i)
     {
       size_t len = NODE_LEN (ss->defs[i]);
+      unsigned int hash = ss->defs[i]->ident.hash_value;
+      unsigned int index = hash & (n_slots - 1);
+
+      while (slots[index].offset != 0)
+	index = (index + 1) & (n_slots - 1);
+      slots[index].hash = hash;
+      slots[index].offset = definedstrs - ss->definedstrs + 1;
+
       memcpy (definedstrs, NODE_NAME (ss->defs[i]), len + 1);
       definedstrs += len + 1;
     }
@@ -327,12 +386,16 @@ cpp_write_pch_deps (cpp_reader *r, FILE *f)
   memset (&z, 0, sizeof (z));
   z.definition_length = ss->hashsize;
   if (fwrite (&z, sizeof (z), 1, f) != 1
-      || fwrite (ss->definedstrs, ss->hashsize, 1, f) != 1)
+      || fwrite (ss->definedstrs, ss->hashsize, 1, f) != 1
+      || fwrite (&n_slots, sizeof (n_slots), 1, f) != 1
+      || fwrite (slots, sizeof (struct undef_slot), n_slots, f) != n_slots)
     {
       cpp_errno (r, CPP_DL_ERROR, "while writing precompiled header");
       return -1;
     }
   free (ss->definedstrs);
+  free (ss->defs);
+  free (slots);
 
   /* Free the saved state.  */
   free (ss);
@@ -382,41 +445,37 @@ cpp_write_pch_state (cpp_reader *r, FILE *f)
 }
 
 
-/* Data structure to transform hash table nodes into a sorted list */
-
-struct ht_node_list
-{
-  /* Array of nodes */
-  cpp_hashnode **defs;
-  /* Number of nodes in the array */
-  size_t n_defs;
-  /* Size of the allocated array */
-  size_t asize;
-};
-
-/* Callback for collecting identifiers from hash table */
+/* Callback for cpp_forall_identifiers: stop at the first identifier
+   defined now that is in the index UI_P.  */
 
 static int
-collect_ht_nodes (cpp_reader *pfile ATTRIBUTE_UNUSED, cpp_hashnode *hn,
-		  void *nl_p)
+check_undefs (cpp_reader *pfile ATTRIBUTE_UNUSED, cpp_hashnode *hn,
+	      void *ui_p)
 {
-  struct ht_node_list *const nl = (struct ht_node_list *)nl_p;
+  struct undef_index *const ui = (struct undef_index *) ui_p;
+  unsigned int hash, index;
+
+  if (hn->type == NT_VOID && !(hn->flags & NODE_POISONED))
+    return 1;
 
-  if (hn->type != NT_VOID || hn->flags & NODE_POISONED)
+  hash = hn->ident.hash_value;
+  for (index = hash & ui->mask;
+       ui->slots[index].offset != 0;
+       index = (index + 1) & ui->mask)
     {
-      if (nl->n_defs == nl->asize)
-        {
-          nl->asize *= 2;
-          nl->defs = XRESIZEVEC (cpp_hashnode *, nl->defs, nl->asize);
-        }
-
-      nl->defs[nl->n_defs] = hn;
-      ++nl->n_defs;
+      const unsigned char *str = ui->strs + ui->slots[index].offset - 1;
+
+      if (ui->slots[index].hash == hash
+	  && memcmp (str, NODE_NAME (hn), NODE_LEN (hn)) == 0
+	  && str[NODE_LEN (hn)] == '\0')
+	{
+	  ui->found = hn;
+	  return 0;
+	}
     }
   return 1;
 }
 
-
 /* Return nonzero if FD is a precompiled header which is consistent
    with the preprocessor's current definitions.  It will be consistent
    when:
@@ -437,11 +496,14 @@ cpp_valid_state (cpp_reader *r, const char *name, int fd)
   size_t namebufsz = 256;
   unsigned char *namebuf = XNEWVEC (unsigned char, namebufsz);
   unsigned char *undeftab = NULL;
-  struct ht_node_list nl = { 0, 0, 0 };
-  unsigned char *first, *last;
-  unsigned int i;
+  struct undef_slot *slots = NULL;
+  struct undef_index ui;
+  unsigned int n_slots;
   unsigned int counter;
 
+  /* The macros the PCH was built with are compared by name.  */
+  _cpp_define_lazy_macros (r);
+
   /* Read in the list of identifiers that must be defined
      Check that they are defined in the same way.  */
   for (;;)
@@ -525,45 +587,38 @@ cpp_valid_state (cpp_reader *r, const char *name, int fd)
   free (namebuf);
   namebuf = NULL;
 
-  /* Read in the list of identifiers that must not be defined.
-     Check that they really aren't.  */
+  /* Read in the list of identifiers that must not be defined and its
+     index.  Check that they really aren't, by looking up each
+     identifier that is defined now in the index.  */
   undeftab = XNEWVEC (unsigned char, m.definition_length);
-  if ((size_t) read (fd, undeftab, m.definition_length) != m.definition_length)
+  if ((size_t) read (fd, undeftab, m.definition_length) != m.definition_length
+      || read (fd, &n_slots, sizeof (n_slots)) != sizeof (n_slots))
     goto error;
 
-  /* Collect identifiers from the current hash table.  */
-  nl.n_defs = 0;
-  nl.asize = 10;
-  nl.defs = XNEWVEC (cpp_hashnode *, nl.asize);
-  cpp_forall_identifiers (r, &collect_ht_nodes, &nl);
-  qsort (nl.defs, nl.n_defs, sizeof (cpp_hashnode *), &comp_hashnodes);
-
-  /* Loop through nl.defs and undeftab, both of which are sorted lists.
-     There should be no matches.  */
-  first = undeftab;
-  last = undeftab + m.definition_length;
-  i = 0;
-
-  while (first < last && i < nl.n_defs)
+  if (n_slots != 0)
     {
-      int cmp = ustrcmp (first, NODE_NAME (nl.defs[i]));
+      slots = XNEWVEC (struct undef_slot, n_slots);
+      if ((size_t) read (fd, slots, n_slots * sizeof (struct undef_slot))
+	  != n_slots * sizeof (struct undef_slot))
+	goto error;
 
-      if (cmp < 0)
- 	first += ustrlen (first) + 1;
-      else if (cmp > 0)
- 	++i;
-      else
+      ui.strs = undeftab;
+      ui.slots = slots;
+      ui.mask = n_slots - 1;
+      ui.found = NULL;
+      cpp_forall_identifiers (r, check_undefs, &ui);
+      if (ui.found != NULL)
 	{
 	  if (CPP_OPTION (r, warn_invalid_pch))
 	    cpp_error (r, CPP_DL_WARNING_SYSHDR,
 		       "%s: not used because `%s' is defined",
-		       name, first);
+		       name, NODE_NAME (ui.found));
 	  goto fail;
 	}
+      free (slots);
+      slots = NULL;
     }
 
-  free(nl.defs);
-  nl.defs = NULL;
   free (undeftab);
   undeftab = NULL;
 
@@ -593,8 +648,8 @@ cpp_valid_state (cpp_reader *r, const char *name, int fd)
     free (namebuf);
   if (undeftab != NULL)
     free (undeftab);
-  if (nl.defs != NULL)
-    free (nl.defs);
+  if (slots != NULL)
+    free (slots);
   return 1;
 }
 
@@ -688,6 +743,9 @@ cpp_read_state (cpp_reader *r, const char *name, FILE *f,
   struct lexer_state old_state;
   unsigned int counter;
 
+  if (r->savedstate != NULL)
+    cpp_forall_identifiers (r, save_layer_idents, r->savedstate);
+
   /* Restore spec_nodes, which will be full of references to the old
      hashtable entries and so will now be invalid.  */
   {
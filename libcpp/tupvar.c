@@ -31,6 +31,7 @@ void tup_set_macro(cpp_reader *pfile, const char *var, int varlen,
 		macro->count = 1;
 		macro->traditional = 0;
 		macro->fun_like = 0;
+		macro->expansion = NULL;
 		/* To suppress some diagnostics.  */
 		macro->syshdr = pfile->buffer && pfile->buffer->sysp != 0;
 
@@ -103,6 +104,7 @@ void tup_enable_macro(cpp_reader *pfile, const char *var, int varlen,
 	macro->count = 1;
 	macro->traditional = 0;
 	macro->fun_like = 0;
+	macro->expansion = NULL;
 	/* To suppress some diagnostics.  */
 	macro->syshdr = pfile->buffer && pfile->buffer->sysp != 0;
 
@@ -133,6 +135,7 @@ int tup_set_if(cpp_reader *pfile, const char *var, int varlen,
 	macro->used = !CPP_OPTION (pfile, warn_unused_macros);
 	macro->traditional = 0;
 	macro->fun_like = 1;
+	macro->expansion = NULL;
 	/* To suppress some diagnostics.  */
 	macro->syshdr = pfile->buffer && pfile->buffer->sysp != 0;
 
@@ -0,0 +1,78 @@
+/* Overhead of fine-grained dynamic and guided loops, for both long and
+   unsigned long long iteration variables and both directions.  Run with
+   GOMP_ADAPTIVE_CHUNK=true to compare the adaptive chunk mode.  */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+extern void abort (void);
+
+#define N 1000000
+unsigned char hits[N];
+
+void
+check (void)
+{
+  int i;
+  for (i = 0; i < N; i++)
+    if (hits[i] != 1)
+      abort ();
+    else
+      hits[i] = 0;
+}
+
+void
+report (const char *name, double stime)
+{
+  double t = omp_get_wtime () - stime;
+  printf ("%-16s threads %d time %f (%.1f ns/iteration)\n", name,
+	  omp_get_max_threads (), t, t * 1e9 / N);
+  check ();
+}
+
+int
+main (void)
+{
+  double stime;
+  long i;
+  unsigned long long u;
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel for schedule (dynamic, 1)
+    for (i = 0; i < N; i++)
+      hits[i]++;
+  report ("dynamic,1", stime);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel for schedule (dynamic, 3)
+    for (i = N - 1; i >= 0; i--)
+      hits[i]++;
+  report ("dynamic,3 down", stime);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel for schedule (guided, 1)
+    for (i = 0; i < N; i++)
+      hits[i]++;
+  report ("guided,1", stime);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel for schedule (dynamic, 1)
+    for (u = 0; u < N; u++)
+      hits[u]++;
+  report ("ull dynamic,1", stime);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel for schedule (dynamic, 2)
+    for (u = N; u > 0; u--)
+      hits[u - 1]++;
+  report ("ull dynamic,2 down", stime);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel for schedule (guided, 7)
+    for (u = 0; u < N; u++)
+      hits[u]++;
+  report ("ull guided,7", stime);
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+/* Cost of starting and ending short parallel regions, both at the
+   outermost level and nested inside another parallel region, with team
+   sizes changing from one region to the next.  */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+extern void abort (void);
+
+int reps = 2000;
+
+void
+report (const char *name, double stime, int regions)
+{
+  double t = omp_get_wtime () - stime;
+  printf ("%-8s threads %d overhead %f us\n", name, omp_get_max_threads (),
+	  t * 1e6 / regions);
+}
+
+int
+main (int argc, char **argv)
+{
+  double stime;
+  int i, outer = 0;
+  long count = 0;
+
+  if (argc >= 2)
+    reps = atoi (argv[1]);
+
+  omp_set_nested (1);
+  omp_set_dynamic (0);
+
+  stime = omp_get_wtime ();
+  for (i = 0; i < reps; i++)
+    {
+      #pragma omp parallel reduction (+:count)
+	count++;
+    }
+  report ("parallel", stime, reps);
+  if (count != (long) reps * omp_get_max_threads ())
+    abort ();
+
+  count = 0;
+  stime = omp_get_wtime ();
+  #pragma omp parallel num_threads (2) reduction (+:outer)
+    {
+      int j;
+      for (j = 0; j < reps; j++)
+	{
+	  #pragma omp parallel num_threads (2 + j % 3)
+	    {
+	      #pragma omp atomic
+		count++;
+	      #pragma omp master
+		outer += omp_get_num_threads ();
+	    }
+	}
+    }
+  report ("nested", stime, 2 * reps);
+  if (count != outer)
+    abort ();
+  return 0;
+}
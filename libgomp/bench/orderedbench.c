@@ -0,0 +1,72 @@
+/* Throughput of ORDERED regions in loops where every iteration enters
+   one, for teams of 8, 16 and 32 threads and the different schedules.
+   This mostly measures the time it takes to hand the ordered region
+   over from one thread to the next.  */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+extern void abort (void);
+
+int iters = 20000;
+
+void
+report (const char *name, int nthreads, double stime)
+{
+  double t = omp_get_wtime () - stime;
+  printf ("%-8s threads %2d %10.0f iterations/s\n", name, nthreads,
+	  iters / t);
+}
+
+int
+main (int argc, char **argv)
+{
+  int n, nthreads;
+  long next;
+  double stime;
+
+  if (argc >= 2)
+    iters = atoi (argv[1]);
+
+  omp_set_dynamic (0);
+  for (nthreads = 8; nthreads <= 32; nthreads *= 2)
+    {
+      next = 0;
+      stime = omp_get_wtime ();
+      #pragma omp parallel for ordered schedule (dynamic) \
+			       num_threads (nthreads)
+	for (n = 0; n < iters; n++)
+	  {
+	    #pragma omp ordered
+	      if (next++ != n)
+		abort ();
+	  }
+      report ("dynamic", nthreads, stime);
+
+      next = 0;
+      stime = omp_get_wtime ();
+      #pragma omp parallel for ordered schedule (guided) \
+			       num_threads (nthreads)
+	for (n = 0; n < iters; n++)
+	  {
+	    #pragma omp ordered
+	      if (next++ != n)
+		abort ();
+	  }
+      report ("guided", nthreads, stime);
+
+      next = 0;
+      stime = omp_get_wtime ();
+      #pragma omp parallel for ordered schedule (static, 1) \
+			       num_threads (nthreads)
+	for (n = 0; n < iters; n++)
+	  {
+	    #pragma omp ordered
+	      if (next++ != n)
+		abort ();
+	  }
+      report ("static", nthreads, stime);
+    }
+  return 0;
+}
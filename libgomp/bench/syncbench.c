@@ -0,0 +1,63 @@
+/* EPCC syncbench style overhead of barrier, for and single.  Run with
+   GOMP_BARRIER=central and GOMP_BARRIER=tree to compare barriers.  */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+extern void abort (void);
+
+int reps = 10000;
+int counts[1024];
+
+void
+report (const char *name, double stime)
+{
+  double t = omp_get_wtime () - stime;
+  printf ("%-8s threads %d overhead %f us\n", name, omp_get_max_threads (),
+	  t * 1e6 / reps);
+}
+
+int
+main (int argc, char **argv)
+{
+  double stime;
+  int i, singles = 0;
+
+  if (argc >= 2)
+    reps = atoi (argv[1]);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel private (i)
+    for (i = 0; i < reps; i++)
+      {
+	#pragma omp barrier
+      }
+  report ("barrier", stime);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel private (i)
+    for (i = 0; i < reps; i++)
+      {
+	int j;
+	#pragma omp for
+	  for (j = 0; j < omp_get_num_threads (); j++)
+	    counts[j & 1023]++;
+      }
+  report ("for", stime);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel private (i)
+    for (i = 0; i < reps; i++)
+      {
+	#pragma omp single
+	  singles++;
+      }
+  report ("single", stime);
+
+  if (singles != reps)
+    abort ();
+  if (counts[0] != reps)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,159 @@
+/* Task spawn and completion throughput: recursive fib, nqueens and
+   a walk over a binary tree, each run serially and with tasks.  */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern void abort (void);
+
+long spawned;
+
+long
+fib (int n)
+{
+  long x, y;
+  if (n < 2)
+    return n;
+  #pragma omp task shared (x)
+    x = fib (n - 1);
+  #pragma omp task shared (y)
+    y = fib (n - 2);
+  #pragma omp atomic
+    spawned += 2;
+  #pragma omp taskwait
+  return x + y;
+}
+
+long
+fib_serial (int n)
+{
+  return n < 2 ? n : fib_serial (n - 1) + fib_serial (n - 2);
+}
+
+long
+nqueens (char *a, int n, int pos)
+{
+  /* b[i] = j means the queen in i-th row is in column j.  */
+  char b[pos + 1];
+  long cnts[n];
+  long cnt = 0;
+  int i, j;
+  memcpy (b, a, pos);
+  for (i = 0; i < n; i++)
+    {
+      cnts[i] = 0;
+      for (j = 0; j < pos; j++)
+	if (b[j] == i || b[j] == i + pos - j || i == b[j] + pos - j)
+	  break;
+      if (j < pos)
+	continue;
+      if (pos == n - 1)
+	cnts[i] = 1;
+      else
+	{
+	  b[pos] = i;
+	  #pragma omp task shared (cnts) firstprivate (b)
+	    cnts[i] = nqueens (b, n, pos + 1);
+	  #pragma omp atomic
+	    spawned++;
+	}
+    }
+  #pragma omp taskwait
+  for (i = 0; i < n; i++)
+    cnt += cnts[i];
+  return cnt;
+}
+
+struct node
+{
+  struct node *left, *right;
+  long val;
+};
+
+struct node *
+build (int depth, long *next)
+{
+  struct node *n;
+  if (depth == 0)
+    return NULL;
+  n = malloc (sizeof (*n));
+  n->val = (*next)++;
+  n->left = build (depth - 1, next);
+  n->right = build (depth - 1, next);
+  return n;
+}
+
+/* Visit every node without waiting for the children; the enclosing
+   barrier has to drain the deferred tasks.  */
+
+long visited;
+
+void
+walk (struct node *n)
+{
+  if (n == NULL)
+    return;
+  #pragma omp atomic
+    visited += n->val;
+  #pragma omp task
+    walk (n->left);
+  #pragma omp task
+    walk (n->right);
+  #pragma omp atomic
+    spawned += 2;
+}
+
+double
+report (const char *name, double stime)
+{
+  double t = omp_get_wtime () - stime;
+  printf ("%-8s threads %d tasks %ld time %f (%.0f tasks/s)\n", name,
+	  omp_get_max_threads (), spawned, t, t > 0 ? spawned / t : 0.0);
+  spawned = 0;
+  return t;
+}
+
+int
+main (int argc, char **argv)
+{
+  int n = 25, q = 9, depth = 16;
+  long res, next = 0, sum;
+  double stime;
+  struct node *root;
+
+  if (argc >= 2)
+    n = atoi (argv[1]);
+  if (argc >= 3)
+    q = atoi (argv[2]);
+  if (argc >= 4)
+    depth = atoi (argv[3]);
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel
+    #pragma omp single
+      res = fib (n);
+  report ("fib", stime);
+  if (res != fib_serial (n))
+    abort ();
+
+  stime = omp_get_wtime ();
+  #pragma omp parallel
+    #pragma omp single
+      res = nqueens ("", q, 0);
+  report ("nqueens", stime);
+  if (q == 9 && res != 352)
+    abort ();
+
+  root = build (depth, &next);
+  sum = next * (next - 1) / 2;
+  stime = omp_get_wtime ();
+  #pragma omp parallel
+    #pragma omp single
+      walk (root);
+  report ("treewalk", stime);
+  if (visited != sum)
+    abort ();
+  return 0;
+}
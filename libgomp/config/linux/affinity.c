@@ -28,7 +28,9 @@
 #define _GNU_SOURCE 1
 #endif
 #include "libgomp.h"
+#include <dirent.h>
 #include <sched.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 
@@ -36,6 +38,124 @@
 
 static unsigned int affinity_counter;
 
+/* The NUMA node, physical package and core ids of each configured CPU,
+   read from sysfs the first time they are needed.  ~0U stands for
+   unknown.  */
+static unsigned *cpu_node, *cpu_package, *cpu_core;
+static unsigned cpu_topology_len;
+static pthread_once_t cpu_topology_once = PTHREAD_ONCE_INIT;
+
+static void init_cpu_topology (void);
+
+/* One CPU to be placed by GOMP_CPU_AFFINITY=compact or spread.  */
+
+struct gomp_place
+{
+  unsigned node, package, core, cpu;
+  /* The index of the package within its node, of the core within
+     its package and of the hardware thread within its core.  */
+  unsigned domain, rank, smt;
+};
+
+static int
+compact_cmp (const void *a, const void *b)
+{
+  const struct gomp_place *x = a, *y = b;
+
+  if (x->node != y->node)
+    return x->node < y->node ? -1 : 1;
+  if (x->package != y->package)
+    return x->package < y->package ? -1 : 1;
+  if (x->core != y->core)
+    return x->core < y->core ? -1 : 1;
+  return x->cpu < y->cpu ? -1 : x->cpu > y->cpu;
+}
+
+static int
+spread_cmp (const void *a, const void *b)
+{
+  const struct gomp_place *x = a, *y = b;
+
+  if (x->smt != y->smt)
+    return x->smt < y->smt ? -1 : 1;
+  if (x->rank != y->rank)
+    return x->rank < y->rank ? -1 : 1;
+  if (x->domain != y->domain)
+    return x->domain < y->domain ? -1 : 1;
+  return compact_cmp (a, b);
+}
+
+/* Fill in gomp_cpu_affinity with the CPUs in CPUSET, ordered for the
+   placement policy gomp_cpu_affinity_kind.  COMPACT orders CPUs by node,
+   package and core, so that consecutive threads share cores and caches.
+   SPREAD takes one core of each package of each node in turn, and only
+   then uses the remaining hardware threads of each core.  CPUs whose
+   topology is unknown are treated as separate cores of node 0.  */
+
+static void
+init_placement (cpu_set_t *cpuset)
+{
+  struct gomp_place *places;
+  unsigned cpu, n = 0, i;
+
+  pthread_once (&cpu_topology_once, init_cpu_topology);
+  places = gomp_malloc (CPU_COUNT (cpuset) * sizeof (struct gomp_place));
+  for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    if (CPU_ISSET (cpu, cpuset))
+      {
+	struct gomp_place *p = &places[n++];
+
+	p->cpu = cpu;
+	p->node = 0;
+	p->package = 0;
+	p->core = cpu;
+	if (cpu < cpu_topology_len)
+	  {
+	    if (cpu_node[cpu] != ~0U)
+	      p->node = cpu_node[cpu];
+	    if (cpu_package[cpu] != ~0U && cpu_core[cpu] != ~0U)
+	      {
+		p->package = cpu_package[cpu];
+		p->core = cpu_core[cpu];
+	      }
+	  }
+      }
+
+  qsort (places, n, sizeof (struct gomp_place), compact_cmp);
+  for (i = 0; i < n; i++)
+    {
+      struct gomp_place *p = &places[i], *q = p - 1;
+
+      if (i == 0)
+	p->domain = p->rank = p->smt = 0;
+      else if (p->node != q->node || p->package != q->package)
+	{
+	  p->domain = q->domain + 1;
+	  p->rank = p->smt = 0;
+	}
+      else if (p->core != q->core)
+	{
+	  p->domain = q->domain;
+	  p->rank = q->rank + 1;
+	  p->smt = 0;
+	}
+      else
+	{
+	  p->domain = q->domain;
+	  p->rank = q->rank;
+	  p->smt = q->smt + 1;
+	}
+    }
+  if (gomp_cpu_affinity_kind == GOMP_AFFINITY_SPREAD)
+    qsort (places, n, sizeof (struct gomp_place), spread_cmp);
+
+  gomp_cpu_affinity = gomp_malloc (n * sizeof (unsigned short));
+  for (i = 0; i < n; i++)
+    gomp_cpu_affinity[i] = places[i].cpu;
+  gomp_cpu_affinity_len = n;
+  free (places);
+}
+
 void
 gomp_init_affinity (void)
 {
@@ -51,6 +171,9 @@ gomp_init_affinity (void)
       return;
     }
 
+  if (gomp_cpu_affinity_kind != GOMP_AFFINITY_LIST)
+    init_placement (&cpuset);
+
   for (widx = idx = 0; idx < gomp_cpu_affinity_len; idx++)
     if (gomp_cpu_affinity[idx] < CPU_SETSIZE
         && CPU_ISSET (gomp_cpu_affinity[idx], &cpuset))
@@ -72,19 +195,106 @@ gomp_init_affinity (void)
   affinity_counter = 1;
 }
 
+/* Make ATTR bind the thread to the CPU at index PLACE of the affinity
+   list, or to the next CPU in turn if PLACE is ~0U.  */
+
 void
-gomp_init_thread_affinity (pthread_attr_t *attr)
+gomp_init_thread_affinity (pthread_attr_t *attr, unsigned int place)
 {
   unsigned int cpu;
   cpu_set_t cpuset;
 
-  cpu = __sync_fetch_and_add (&affinity_counter, 1);
+  if (place != ~0U)
+    cpu = place;
+  else
+    cpu = __sync_fetch_and_add (&affinity_counter, 1);
   cpu %= gomp_cpu_affinity_len;
   CPU_ZERO (&cpuset);
   CPU_SET (gomp_cpu_affinity[cpu], &cpuset);
   pthread_attr_setaffinity_np (attr, sizeof (cpu_set_t), &cpuset);
 }
 
+static unsigned
+read_topology_id (unsigned cpu, const char *name)
+{
+  char path[sizeof ("/sys/devices/system/cpu/cpu/topology/")
+	    + 3 * sizeof (unsigned) + 32];
+  unsigned value;
+  FILE *f;
+
+  sprintf (path, "/sys/devices/system/cpu/cpu%u/topology/%s", cpu, name);
+  f = fopen (path, "r");
+  if (f == NULL)
+    return ~0U;
+  if (fscanf (f, "%u", &value) != 1)
+    value = ~0U;
+  fclose (f);
+  return value;
+}
+
+/* Return the NUMA node of CPU, which sysfs shows as a nodeN link in
+   the CPU's directory, or ~0U if there is none.  */
+
+static unsigned
+read_node_id (unsigned cpu)
+{
+  char path[sizeof ("/sys/devices/system/cpu/cpu") + 3 * sizeof (unsigned)];
+  struct dirent *d;
+  unsigned value = ~0U;
+  DIR *dir;
+
+  sprintf (path, "/sys/devices/system/cpu/cpu%u", cpu);
+  dir = opendir (path);
+  if (dir == NULL)
+    return ~0U;
+  while ((d = readdir (dir)) != NULL)
+    if (sscanf (d->d_name, "node%u", &value) == 1)
+      break;
+    else
+      value = ~0U;
+  closedir (dir);
+  return value;
+}
+
+static void
+init_cpu_topology (void)
+{
+  long ncpus = sysconf (_SC_NPROCESSORS_CONF);
+  unsigned cpu;
+
+  if (ncpus <= 0)
+    return;
+  if (ncpus > CPU_SETSIZE)
+    ncpus = CPU_SETSIZE;
+  cpu_node = malloc (3 * ncpus * sizeof (unsigned));
+  if (cpu_node == NULL)
+    return;
+  cpu_package = cpu_node + ncpus;
+  cpu_core = cpu_package + ncpus;
+  for (cpu = 0; cpu < ncpus; cpu++)
+    {
+      cpu_node[cpu] = read_node_id (cpu);
+      cpu_package[cpu] = read_topology_id (cpu, "physical_package_id");
+      cpu_core[cpu] = read_topology_id (cpu, "core_id");
+    }
+  cpu_topology_len = ncpus;
+}
+
+/* Store the physical package and core ids of CPU into *PACKAGE and *CORE.
+   Return false if they are not known.  */
+
+bool
+gomp_cpu_topology (unsigned cpu, unsigned *package, unsigned *core)
+{
+  pthread_once (&cpu_topology_once, init_cpu_topology);
+  if (cpu >= cpu_topology_len
+      || cpu_package[cpu] == ~0U || cpu_core[cpu] == ~0U)
+    return false;
+  *package = cpu_package[cpu];
+  *core = cpu_core[cpu];
+  return true;
+}
+
 #else
 
 #include "../posix/affinity.c"
@@ -27,12 +27,173 @@
    implementation uses atomic instructions and the futex syscall.  */
 
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 #include "wait.h"
 
 
+/* One entry being grouped while building the combining tree: either a
+   thread (NODE is NULL) or an already built subtree.  */
+
+struct gomp_barrier_item
+{
+  unsigned package, core;
+  unsigned thread;
+  struct gomp_barrier_node *node;
+};
+
+/* Level 0 groups threads running on the same core, level 1 those on
+   the same package, and level 2 everything.  */
+
+static inline bool
+same_group (struct gomp_barrier_item *a, struct gomp_barrier_item *b,
+	    int level)
+{
+  return (level == 2
+	  || (a->package == b->package && (level == 1 || a->core == b->core)));
+}
+
+/* Initialize BAR as the barrier of a team of COUNT threads.  If a tree
+   barrier has been requested through GOMP_BARRIER, build a combining
+   tree whose leaves group threads on the same core and whose inner
+   nodes group cores of the same package, so that most arrivals only
+   touch cache lines shared with nearby threads.  Nodes never have more
+   than gomp_barrier_fanin_var children.  Where the CPU of a thread is
+   not known, consecutive team members are grouped together.  */
+
+void
+gomp_team_barrier_init (gomp_barrier_t *bar, unsigned count)
+{
+  unsigned fanin = gomp_barrier_fanin_var;
+  struct gomp_barrier_item *items, *next, *tmp;
+  struct gomp_barrier_node *nodes;
+  unsigned nitems, nnext, nnodes, i, j, level;
+  bool *grouped;
+  char *mem;
+
+  gomp_barrier_init (bar, count);
+  if (fanin < 2 || count <= fanin)
+    return;
+
+  /* A tree over COUNT leaves with at least two children per node
+     has fewer than COUNT nodes.  */
+  mem = gomp_malloc (count * sizeof (*bar->leaves)
+		     + count * sizeof (*nodes) + __alignof__ (*nodes) - 1);
+  bar->leaves = (struct gomp_barrier_node **) mem;
+  nodes = (struct gomp_barrier_node *)
+	  (((uintptr_t) (mem + count * sizeof (*bar->leaves))
+	    + __alignof__ (*nodes) - 1)
+	   & ~(uintptr_t) (__alignof__ (*nodes) - 1));
+  nnodes = 0;
+
+  items = gomp_malloc (2 * count * sizeof (*items) + count * sizeof (bool));
+  next = items + count;
+  grouped = (bool *) (next + count);
+  for (i = 0; i < count; i++)
+    {
+      items[i].thread = i;
+      items[i].node = NULL;
+      if (gomp_cpu_affinity == NULL
+	  || !gomp_cpu_topology (gomp_cpu_affinity[i % gomp_cpu_affinity_len],
+				 &items[i].package, &items[i].core))
+	{
+	  items[i].package = 0;
+	  items[i].core = i;
+	}
+    }
+
+  nitems = count;
+  level = 0;
+  while (level < 3)
+    {
+      bool merged = false;
+
+      memset (grouped, 0, nitems * sizeof (bool));
+      nnext = 0;
+      for (i = 0; i < nitems; i++)
+	{
+	  unsigned group[nitems], m = 0, nchunks, k;
+
+	  if (grouped[i])
+	    continue;
+	  for (j = i; j < nitems; j++)
+	    if (!grouped[j] && same_group (&items[i], &items[j], level))
+	      {
+		grouped[j] = true;
+		group[m++] = j;
+	      }
+
+	  /* Split the group into as few balanced chunks as FANIN allows,
+	     and give each chunk with more than one member a new node.  */
+	  nchunks = (m + fanin - 1) / fanin;
+	  for (j = 0, k = 0; k < nchunks; k++)
+	    {
+	      unsigned size = m / nchunks + (k < m % nchunks);
+	      struct gomp_barrier_node *node;
+
+	      if (size == 1)
+		{
+		  next[nnext++] = items[group[j++]];
+		  continue;
+		}
+	      node = &nodes[nnodes++];
+	      node->awaited = size;
+	      node->total = size;
+	      node->parent = NULL;
+	      next[nnext] = items[group[j]];
+	      next[nnext].node = node;
+	      nnext++;
+	      for (; size; size--, j++)
+		if (items[group[j]].node)
+		  items[group[j]].node->parent = node;
+		else
+		  bar->leaves[items[group[j]].thread] = node;
+	      merged = true;
+	    }
+	}
+      tmp = items;
+      items = next;
+      next = tmp;
+      nitems = nnext;
+      if (!merged)
+	level++;
+    }
+
+  free (items < next ? items : next);
+}
+
+void
+gomp_barrier_destroy (gomp_barrier_t *bar)
+{
+  free (bar->leaves);
+}
+
+/* Arrive at the combining tree of BAR.  The last thread to arrive at a
+   node resets it and carries on to the parent; return true if the
+   current thread arrived last at the root.  */
+
+bool
+gomp_barrier_tree_arrive (gomp_barrier_t *bar)
+{
+  struct gomp_barrier_node *node = bar->leaves[gomp_thread ()->ts.team_id];
+
+  do
+    {
+      if (__sync_add_and_fetch (&node->awaited, -1) != 0)
+	return false;
+      /* Nobody else arrives at this node before the barrier is released.  */
+      node->awaited = node->total;
+      node = node->parent;
+    }
+  while (node != NULL);
+  return true;
+}
+
+
 void
 gomp_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
 {
+  gomp_trace (GOMP_TRACE_BARRIER_BEGIN, 0, (uintptr_t) bar);
   if (__builtin_expect ((state & 1) != 0, 0))
     {
       /* Next time we'll be awaiting TOTAL threads again.  */
@@ -46,9 +207,11 @@ gomp_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
       unsigned int generation = state;
 
       do
-	do_wait ((int *) &bar->generation, generation);
+	do_wait_estimate ((int *) &bar->generation, generation,
+			  &bar->spin_estimate);
       while (bar->generation == generation);
     }
+  gomp_trace (GOMP_TRACE_BARRIER_END, 0, (uintptr_t) bar);
 }
 
 void
@@ -83,6 +246,7 @@ gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
 {
   unsigned int generation;
 
+  gomp_trace (GOMP_TRACE_BARRIER_BEGIN, 1, (uintptr_t) bar);
   if (__builtin_expect ((state & 1) != 0, 0))
     {
       /* Next time we'll be awaiting TOTAL threads again.  */
@@ -99,6 +263,7 @@ gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
 	{
 	  bar->generation = state + 3;
 	  futex_wake ((int *) &bar->generation, INT_MAX);
+	  gomp_trace (GOMP_TRACE_BARRIER_END, 1, (uintptr_t) bar);
 	  return;
 	}
     }
@@ -106,13 +271,15 @@ gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
   generation = state;
   do
     {
-      do_wait ((int *) &bar->generation, generation);
+      do_wait_estimate ((int *) &bar->generation, generation,
+			&bar->spin_estimate);
       if (__builtin_expect (bar->generation & 1, 0))
 	gomp_barrier_handle_tasks (state);
       if ((bar->generation & 2))
 	generation |= 2;
     }
   while (bar->generation != state + 4);
+  gomp_trace (GOMP_TRACE_BARRIER_END, 1, (uintptr_t) bar);
 }
 
 void
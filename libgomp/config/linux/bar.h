@@ -31,13 +31,32 @@
 
 #include "mutex.h"
 
+/* A node of the combining tree used by team barriers with many threads.
+   Each node counts the arrivals of its children, which are either
+   threads sharing a core or package, or further nodes.  */
+
+struct gomp_barrier_node
+{
+  unsigned awaited __attribute__((aligned (64)));
+  unsigned total;
+  struct gomp_barrier_node *parent;
+};
+
 typedef struct
 {
   /* Make sure total/generation is in a mostly read cacheline, while
      awaited in a separate cacheline.  */
   unsigned total __attribute__((aligned (64)));
   unsigned generation;
+  /* If non-NULL, this is indexed by team_id and gives the leaf node of
+     the combining tree each thread arrives at, and awaited is unused.  */
+  struct gomp_barrier_node **leaves;
   unsigned awaited __attribute__((aligned (64)));
+  /* With GOMP_SPINCOUNT=adaptive, the number of spins recent waits on
+     this barrier took, see gomp_adaptive_wait.  Waiters update it when
+     they leave, so keep it away from awaited, which arriving threads
+     decrement.  */
+  unsigned spin_estimate __attribute__((aligned (64)));
 } gomp_barrier_t;
 typedef unsigned int gomp_barrier_state_t;
 
@@ -46,6 +65,8 @@ static inline void gomp_barrier_init (gomp_barrier_t *bar, unsigned count)
   bar->total = count;
   bar->awaited = count;
   bar->generation = 0;
+  bar->leaves = NULL;
+  bar->spin_estimate = 0;
 }
 
 static inline void gomp_barrier_reinit (gomp_barrier_t *bar, unsigned count)
@@ -54,9 +75,9 @@ static inline void gomp_barrier_reinit (gomp_barrier_t *bar, unsigned count)
   bar->total = count;
 }
 
-static inline void gomp_barrier_destroy (gomp_barrier_t *bar)
-{
-}
+extern void gomp_team_barrier_init (gomp_barrier_t *, unsigned);
+extern void gomp_barrier_destroy (gomp_barrier_t *);
+extern bool gomp_barrier_tree_arrive (gomp_barrier_t *);
 
 extern void gomp_barrier_wait (gomp_barrier_t *);
 extern void gomp_barrier_wait_last (gomp_barrier_t *);
@@ -70,6 +91,8 @@ static inline gomp_barrier_state_t
 gomp_barrier_wait_start (gomp_barrier_t *bar)
 {
   unsigned int ret = bar->generation & ~3;
+  if (__builtin_expect (bar->leaves != NULL, 0))
+    return ret + gomp_barrier_tree_arrive (bar);
   /* Do we need any barrier here or is __sync_add_and_fetch acting
      as the needed LoadLoad barrier already?  */
   ret += __sync_add_and_fetch (&bar->awaited, -1) == 0;
@@ -33,35 +33,50 @@
 
 
 /* The internal gomp_mutex_t and the external non-recursive omp_lock_t
-   have the same form.  Re-use it.  */
+   have the same form.  Re-use it.  With GOMP_LOCK=mcs or GOMP_LOCK_STATS
+   set the lock word instead refers to a gomp_qlock, see qlock.h.  */
 
 void
 gomp_init_lock_30 (omp_lock_t *lock)
 {
-  gomp_mutex_init (lock);
+  if (gomp_qlock_enabled ())
+    gomp_qlock_init (lock, GOMP_QLOCK_LOCK, lock);
+  else
+    gomp_mutex_init (lock);
 }
 
 void
 gomp_destroy_lock_30 (omp_lock_t *lock)
 {
-  gomp_mutex_destroy (lock);
+  if (gomp_qlock_enabled ())
+    gomp_qlock_destroy (lock);
+  else
+    gomp_mutex_destroy (lock);
 }
 
 void
 gomp_set_lock_30 (omp_lock_t *lock)
 {
-  gomp_mutex_lock (lock);
+  if (gomp_qlock_enabled ())
+    gomp_qlock_acquire (lock, GOMP_QLOCK_LOCK, lock);
+  else
+    gomp_mutex_lock (lock);
 }
 
 void
 gomp_unset_lock_30 (omp_lock_t *lock)
 {
-  gomp_mutex_unlock (lock);
+  if (gomp_qlock_enabled ())
+    gomp_qlock_release (lock);
+  else
+    gomp_mutex_unlock (lock);
 }
 
 int
 gomp_test_lock_30 (omp_lock_t *lock)
 {
+  if (gomp_qlock_enabled ())
+    return gomp_qlock_try (lock);
   return __sync_bool_compare_and_swap (lock, 0, 1);
 }
 
@@ -69,11 +84,15 @@ void
 gomp_init_nest_lock_30 (omp_nest_lock_t *lock)
 {
   memset (lock, '\0', sizeof (*lock));
+  if (gomp_qlock_enabled ())
+    gomp_qlock_init (&lock->lock, GOMP_QLOCK_NEST_LOCK, lock);
 }
 
 void
 gomp_destroy_nest_lock_30 (omp_nest_lock_t *lock)
 {
+  if (gomp_qlock_enabled ())
+    gomp_qlock_destroy (&lock->lock);
 }
 
 void
@@ -83,7 +102,10 @@ gomp_set_nest_lock_30 (omp_nest_lock_t *lock)
 
   if (lock->owner != me)
     {
-      gomp_mutex_lock (&lock->lock);
+      if (gomp_qlock_enabled ())
+	gomp_qlock_acquire (&lock->lock, GOMP_QLOCK_NEST_LOCK, lock);
+      else
+	gomp_mutex_lock (&lock->lock);
       lock->owner = me;
     }
 
@@ -96,7 +118,10 @@ gomp_unset_nest_lock_30 (omp_nest_lock_t *lock)
   if (--lock->count == 0)
     {
       lock->owner = NULL;
-      gomp_mutex_unlock (&lock->lock);
+      if (gomp_qlock_enabled ())
+	gomp_qlock_release (&lock->lock);
+      else
+	gomp_mutex_unlock (&lock->lock);
     }
 }
 
@@ -108,7 +133,9 @@ gomp_test_nest_lock_30 (omp_nest_lock_t *lock)
   if (lock->owner == me)
     return ++lock->count;
 
-  if (__sync_bool_compare_and_swap (&lock->lock, 0, 1))
+  if (gomp_qlock_enabled ()
+      ? gomp_qlock_try (&lock->lock)
+      : __sync_bool_compare_and_swap (&lock->lock, 0, 1))
     {
       lock->owner = me;
       lock->count = 1;
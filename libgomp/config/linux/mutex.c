@@ -27,10 +27,147 @@
    implementation uses atomic instructions and the futex syscall.  */
 
 #include "wait.h"
+#include <stdio.h>
+#if TIME_WITH_SYS_TIME
+# include <sys/time.h>
+# include <time.h>
+#else
+# if HAVE_SYS_TIME_H
+#  include <sys/time.h>
+# else
+#  include <time.h>
+# endif
+#endif
 
 long int gomp_futex_wake = FUTEX_WAKE | FUTEX_PRIVATE_FLAG;
 long int gomp_futex_wait = FUTEX_WAIT | FUTEX_PRIVATE_FLAG;
 
+/* The fewest spins an adaptive wait does while the machine is not
+   oversubscribed, so that short waits keep being noticed even once the
+   estimate has dropped to zero.  */
+#define GOMP_ADAPTIVE_MIN_SPINS 64
+
+/* How often, in nanoseconds, the number of runnable threads on the
+   system is sampled.  */
+#define GOMP_LOAD_SAMPLE_INTERVAL 100000000ULL
+
+/* Whether there were more runnable threads on the system than CPUs
+   available to us at the last sample, and when to take the next one.  */
+static bool system_oversubscribed;
+static unsigned long long next_load_sample;
+
+static unsigned long long
+wait_clock (void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ts;
+# ifdef CLOCK_MONOTONIC
+  if (clock_gettime (CLOCK_MONOTONIC, &ts) < 0)
+# endif
+    clock_gettime (CLOCK_REALTIME, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#endif
+}
+
+/* Read the number of currently runnable threads, the fourth field of
+   /proc/loadavg, if it is time to, and note whether it exceeds the
+   number of available CPUs.  */
+
+static void
+sample_load (unsigned long long now)
+{
+  unsigned long long next = next_load_sample;
+  unsigned long running;
+  FILE *f;
+
+  if (now < next
+      || !__sync_bool_compare_and_swap (&next_load_sample, next,
+					now + GOMP_LOAD_SAMPLE_INTERVAL))
+    return;
+
+  f = fopen ("/proc/loadavg", "r");
+  if (f == NULL)
+    return;
+  if (fscanf (f, "%*s %*s %*s %lu", &running) == 1)
+    system_oversubscribed = running > gomp_available_cpus;
+  fclose (f);
+}
+
+/* The spin estimate of waits by threads without a struct gomp_thread.  */
+unsigned int gomp_spin_estimate;
+
+/* The slow path of do_wait_estimate for GOMP_SPINCOUNT=adaptive.  Spin
+   for about twice the number of iterations recent waits needed, as
+   recorded in *ESTIMATE, before blocking in the kernel.  If the wait
+   ends while spinning, the estimate moves towards the number of spins
+   it took.  If we block, the time spent blocked is converted to spins
+   at the rate measured while spinning.  The estimate then moves towards
+   the total, or towards zero if even that is more than
+   gomp_spin_count_var, as spinning that long would not have paid off.
+   Nothing is spun if libgomp has more threads than there are CPUs, or
+   if the system has more runnable threads than that.  */
+
+void
+gomp_adaptive_wait (int *addr, int val, unsigned int *estimate)
+{
+  unsigned long long i, count, need, start, spun, woken;
+  unsigned int old = *estimate;
+
+  start = wait_clock ();
+  sample_load (start);
+  if (__builtin_expect (gomp_managed_threads > gomp_available_cpus, 0)
+      || __builtin_expect (system_oversubscribed, 0))
+    count = 0;
+  else
+    {
+      count = 2ULL * old + GOMP_ADAPTIVE_MIN_SPINS;
+      if (count > gomp_spin_count_var)
+	count = gomp_spin_count_var;
+    }
+
+  for (i = 0; i < count; i++)
+    if (__builtin_expect (*addr != val, 0))
+      break;
+    else
+      cpu_relax ();
+
+  if (i < count)
+    need = i;
+  else
+    {
+      spun = wait_clock ();
+      futex_wait (addr, val);
+      if (count == 0)
+	return;
+      woken = wait_clock ();
+      if (spun > start)
+	{
+	  double blocked = (double) (woken - spun) * count / (spun - start);
+	  if (blocked < gomp_spin_count_var - count)
+	    need = count + (unsigned long long) blocked;
+	  else
+	    need = 0;
+	}
+      else
+	need = 0;
+    }
+  if (need > 0xffffffffULL)
+    need = 0xffffffffULL;
+
+  /* Move a quarter of the way towards NEED.  Don't dirty the cache line
+     of a shared estimate if nothing changes.  */
+  if (need > old)
+    need = old + (need - old + 3) / 4;
+  else
+    need = old - (old - need + 3) / 4;
+  if (need != old)
+    *estimate = need;
+}
+
 void
 gomp_mutex_lock_slow (gomp_mutex_t *mutex)
 {
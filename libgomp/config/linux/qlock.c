@@ -0,0 +1,357 @@
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This is a Linux specific implementation of queued locks for libgomp.
+   This implementation uses atomic instructions and the futex syscall.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wait.h"
+
+/* A waiter in the queue of a gomp_qlock.  WAIT is 1 while the thread
+   spins, 2 once it blocks in the kernel, and 0 when it has been handed
+   the lock.  */
+
+struct gomp_qlock_node
+{
+  struct gomp_qlock_node *next;
+  int wait;
+};
+
+struct gomp_qlock
+{
+  /* The last node queued, or NULL if the lock is free.  The holder's
+     node is HOLDER, except while the holder is still moving into it from
+     the node it queued on its stack, see qlock_mcs_acquire.  */
+  struct gomp_qlock_node *tail __attribute__((aligned (64)));
+  struct gomp_qlock_node holder;
+  /* The lock itself with GOMP_LOCK=mutex.  */
+  gomp_mutex_t mutex;
+  enum gomp_qlock_kind kind;
+  /* The omp_lock_t or critical section, for the statistics.  */
+  void *id;
+  /* Statistics, only updated by the holder of the lock.  */
+  unsigned long long acquisitions, contended;
+  double hold_start, hold_time;
+  /* The index plus one of the next lock on the free list.  */
+  int next_free;
+  bool destroyed;
+};
+
+/* The locks are allocated in chunks, which are never freed.  A lock word
+   holds the index of its lock plus one.  */
+
+#define QLOCK_CHUNK_BITS 8
+#define QLOCK_CHUNK (1 << QLOCK_CHUNK_BITS)
+#define QLOCK_CHUNKS 65536
+
+static struct gomp_qlock *qlock_chunks[QLOCK_CHUNKS];
+static int qlock_count, qlock_free;
+static gomp_mutex_t qlock_table_lock;
+
+static inline struct gomp_qlock *
+qlock_get (int word)
+{
+  unsigned int i = word - 1;
+
+  return &qlock_chunks[i >> QLOCK_CHUNK_BITS][i & (QLOCK_CHUNK - 1)];
+}
+
+/* Allocate a free lock of KIND for ID and return its lock word.  */
+
+static int
+qlock_alloc (enum gomp_qlock_kind kind, void *id)
+{
+  struct gomp_qlock *q;
+  int word;
+
+  gomp_mutex_lock (&qlock_table_lock);
+  if (qlock_free != 0)
+    {
+      word = qlock_free;
+      qlock_free = qlock_get (word)->next_free;
+    }
+  else
+    {
+      int chunk = qlock_count >> QLOCK_CHUNK_BITS;
+
+      if (chunk == QLOCK_CHUNKS)
+	gomp_fatal ("too many locks for GOMP_LOCK");
+      if (qlock_chunks[chunk] == NULL)
+	{
+	  char *p = gomp_malloc (QLOCK_CHUNK * sizeof (struct gomp_qlock) + 63);
+	  p += -(uintptr_t) p & 63;
+	  qlock_chunks[chunk] = (struct gomp_qlock *) p;
+	}
+      word = ++qlock_count;
+    }
+  gomp_mutex_unlock (&qlock_table_lock);
+
+  q = qlock_get (word);
+  memset (q, 0, sizeof (*q));
+  q->kind = kind;
+  q->id = id;
+  return word;
+}
+
+/* Put the lock of WORD back on the free list, unless its statistics are
+   to be reported at exit.  */
+
+static void
+qlock_free_word (int word, bool keep)
+{
+  struct gomp_qlock *q = qlock_get (word);
+
+  if (keep)
+    {
+      q->destroyed = true;
+      return;
+    }
+  gomp_mutex_lock (&qlock_table_lock);
+  q->next_free = qlock_free;
+  qlock_free = word;
+  gomp_mutex_unlock (&qlock_table_lock);
+}
+
+/* Return the lock of WORD, creating it first if WORD is still zero.  */
+
+static inline struct gomp_qlock *
+qlock_lookup (int *word, enum gomp_qlock_kind kind, void *id)
+{
+  int w = *word;
+
+  if (__builtin_expect (w == 0, 0))
+    {
+      int n = qlock_alloc (kind, id);
+
+      w = __sync_val_compare_and_swap (word, 0, n);
+      if (w != 0)
+	qlock_free_word (n, false);
+      else
+	w = n;
+    }
+  return qlock_get (w);
+}
+
+void
+gomp_qlock_init (int *word, enum gomp_qlock_kind kind, void *id)
+{
+  *word = qlock_alloc (kind, id);
+}
+
+void
+gomp_qlock_destroy (int *word)
+{
+  if (*word != 0)
+    qlock_free_word (*word, gomp_lock_stats_var);
+  *word = 0;
+}
+
+/* Wait until NODE has been handed the lock.  */
+
+static void
+qlock_wait (struct gomp_qlock_node *node)
+{
+  unsigned long long i, count = gomp_spin_count_var;
+
+  if (__builtin_expect (gomp_managed_threads > gomp_available_cpus, 0))
+    count = gomp_throttled_spin_count_var;
+  for (i = 0; i < count; i++)
+    if (__builtin_expect (node->wait == 0, 0))
+      return;
+    else
+      cpu_relax ();
+
+  if (__sync_bool_compare_and_swap (&node->wait, 1, 2))
+    do
+      futex_wait (&node->wait, 2);
+    while (node->wait != 0);
+}
+
+/* Queue behind the current tail of Q and wait for the lock.  Return true
+   if it was held by another thread.  */
+
+static bool
+qlock_mcs_acquire (struct gomp_qlock *q)
+{
+  struct gomp_qlock_node me, *pred, *old;
+
+  me.next = NULL;
+  me.wait = 1;
+  pred = q->tail;
+  while ((old = __sync_val_compare_and_swap (&q->tail, pred, &me)) != pred)
+    pred = old;
+  if (pred != NULL)
+    {
+      pred->next = &me;
+      qlock_wait (&me);
+    }
+
+  /* ME lives on this thread's stack, but the lock is released from
+     another frame.  Move to Q->HOLDER, which is no longer referenced
+     by the previous holder: either by swinging the tail over to it, or,
+     if a successor has queued behind ME, by passing it on.  */
+  q->holder.next = NULL;
+  if (me.next == NULL)
+    {
+      if (__sync_bool_compare_and_swap (&q->tail, &me, &q->holder))
+	return pred != NULL;
+      while (me.next == NULL)
+	cpu_relax ();
+    }
+  q->holder.next = me.next;
+  return pred != NULL;
+}
+
+static void
+qlock_mcs_release (struct gomp_qlock *q)
+{
+  struct gomp_qlock_node *next = q->holder.next;
+
+  if (next == NULL)
+    {
+      if (__sync_bool_compare_and_swap (&q->tail, &q->holder, NULL))
+	return;
+      while ((next = q->holder.next) == NULL)
+	cpu_relax ();
+    }
+
+  /* The waiter may return as soon as it sees zero, so NEXT must not be
+     dereferenced after the store.  A stray wake of whatever reuses its
+     address is harmless, futex waiters recheck their condition.  */
+  if (!__sync_bool_compare_and_swap (&next->wait, 1, 0))
+    {
+      next->wait = 0;
+      futex_wake (&next->wait, 1);
+    }
+}
+
+void
+gomp_qlock_acquire (int *word, enum gomp_qlock_kind kind, void *id)
+{
+  struct gomp_qlock *q = qlock_lookup (word, kind, id);
+  bool contended;
+
+  if (gomp_lock_mcs_var)
+    contended = qlock_mcs_acquire (q);
+  else
+    {
+      contended = !__sync_bool_compare_and_swap (&q->mutex, 0, 1);
+      if (contended)
+	gomp_mutex_lock (&q->mutex);
+    }
+
+  if (gomp_lock_stats_var)
+    {
+      q->acquisitions++;
+      q->contended += contended;
+      q->hold_start = omp_get_wtime ();
+    }
+}
+
+bool
+gomp_qlock_try (int *word)
+{
+  struct gomp_qlock *q = qlock_get (*word);
+
+  /* With the lock free, HOLDER.NEXT is always NULL.  */
+  if (gomp_lock_mcs_var
+      ? !__sync_bool_compare_and_swap (&q->tail, NULL, &q->holder)
+      : !__sync_bool_compare_and_swap (&q->mutex, 0, 1))
+    return false;
+
+  if (gomp_lock_stats_var)
+    {
+      q->acquisitions++;
+      q->hold_start = omp_get_wtime ();
+    }
+  return true;
+}
+
+void
+gomp_qlock_release (int *word)
+{
+  struct gomp_qlock *q = qlock_get (*word);
+
+  if (gomp_lock_stats_var)
+    q->hold_time += omp_get_wtime () - q->hold_start;
+
+  if (gomp_lock_mcs_var)
+    qlock_mcs_release (q);
+  else
+    gomp_mutex_unlock (&q->mutex);
+}
+
+static int
+qlock_compare (const void *a, const void *b)
+{
+  const struct gomp_qlock *qa = *(struct gomp_qlock * const *) a;
+  const struct gomp_qlock *qb = *(struct gomp_qlock * const *) b;
+
+  if (qa->hold_time != qb->hold_time)
+    return qa->hold_time < qb->hold_time ? 1 : -1;
+  return qa->acquisitions < qb->acquisitions
+	 ? 1 : qa->acquisitions > qb->acquisitions ? -1 : 0;
+}
+
+/* With GOMP_LOCK_STATS, print the locks that were acquired, those held
+   longest in total first, up to QLOCK_REPORT of them.  */
+
+#define QLOCK_REPORT 20
+
+static void __attribute__((destructor))
+qlock_destructor (void)
+{
+  static const char *const kinds[] = {
+    "omp_lock_t", "omp_nest_lock_t", "critical", "named critical"
+  };
+  struct gomp_qlock **locks;
+  int i, n = 0;
+
+  if (!gomp_lock_stats_var)
+    return;
+
+  locks = gomp_malloc (qlock_count * sizeof (*locks) + 1);
+  for (i = 1; i <= qlock_count; i++)
+    if (qlock_get (i)->acquisitions != 0)
+      locks[n++] = qlock_get (i);
+  qsort (locks, n, sizeof (*locks), qlock_compare);
+
+  fprintf (stderr, "\nlibgomp: lock statistics (GOMP_LOCK=%s)\n"
+	   "%20s %20s %14s  %s\n", gomp_lock_mcs_var ? "mcs" : "mutex",
+	   "acquisitions", "contended", "held (s)", "lock");
+  for (i = 0; i < n && i < QLOCK_REPORT; i++)
+    {
+      struct gomp_qlock *q = locks[i];
+
+      fprintf (stderr, "%20llu %20llu %14.6f  %s",
+	       q->acquisitions, q->contended, q->hold_time, kinds[q->kind]);
+      if (q->kind != GOMP_QLOCK_CRITICAL)
+	fprintf (stderr, " %p", q->id);
+      fputs (q->destroyed ? " (destroyed)\n" : "\n", stderr);
+    }
+  if (n > QLOCK_REPORT)
+    fprintf (stderr, "%20s and %d more locks\n", "...", n - QLOCK_REPORT);
+  free (locks);
+}
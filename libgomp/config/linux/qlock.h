@@ -0,0 +1,59 @@
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This is a Linux specific implementation of queued locks for libgomp.
+   With GOMP_LOCK=mcs or GOMP_LOCK_STATS set, the word of an omp_lock_t,
+   omp_nest_lock_t or critical section no longer holds a mutex but the
+   index of a gomp_qlock, which queues its waiters in an MCS list so that
+   each spins on a cache line of its own, and may count how often and how
+   long it is held.  The word stays zero until the lock is created, which
+   for critical sections happens on first use.  This implementation uses
+   atomic instructions and the futex syscall.  */
+
+#ifndef GOMP_QLOCK_H
+#define GOMP_QLOCK_H 1
+
+enum gomp_qlock_kind
+{
+  GOMP_QLOCK_LOCK,
+  GOMP_QLOCK_NEST_LOCK,
+  GOMP_QLOCK_CRITICAL,
+  GOMP_QLOCK_CRITICAL_NAME
+};
+
+extern bool gomp_lock_mcs_var, gomp_lock_stats_var;
+
+extern void gomp_qlock_init (int *, enum gomp_qlock_kind, void *);
+extern void gomp_qlock_destroy (int *);
+extern void gomp_qlock_acquire (int *, enum gomp_qlock_kind, void *);
+extern bool gomp_qlock_try (int *);
+extern void gomp_qlock_release (int *);
+
+/* Whether locks and critical sections go through a gomp_qlock.  */
+
+static inline bool gomp_qlock_enabled (void)
+{
+  return __builtin_expect (gomp_lock_mcs_var | gomp_lock_stats_var, 0);
+}
+
+#endif /* GOMP_QLOCK_H */
@@ -0,0 +1,71 @@
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This is a Linux specific implementation of a ticket slot for libgomp.
+   This implementation uses atomic instructions and the futex syscall.  */
+
+#include <limits.h>
+#include "wait.h"
+
+/* Wait until SLOT shows TICKET.  The previous holder normally hands
+   over within a short time, so spin first without telling it, which
+   spares it the futex_wake.  */
+
+void
+gomp_ticket_wait_slow (gomp_ticket_t *slot, unsigned ticket)
+{
+  unsigned long long i, count = gomp_spin_count_var;
+  unsigned want = ticket << 1, word;
+
+  if (__builtin_expect (gomp_managed_threads > gomp_available_cpus, 0))
+    count = gomp_throttled_spin_count_var;
+  for (i = 0; i < count; i++)
+    if (__builtin_expect ((slot->word & ~1U) == want, 0))
+      return;
+    else
+      cpu_relax ();
+
+  while (((word = slot->word) & ~1U) != want)
+    {
+      if ((word & 1) == 0
+	  && !__sync_bool_compare_and_swap (&slot->word, word, word | 1))
+	continue;
+      futex_wait ((int *) &slot->word, word | 1);
+    }
+}
+
+void
+gomp_ticket_grant_slow (gomp_ticket_t *slot, unsigned ticket)
+{
+  unsigned old, tmp = slot->word;
+
+  do
+    {
+      old = tmp;
+      tmp = __sync_val_compare_and_swap (&slot->word, old, ticket << 1);
+    }
+  while (old != tmp);
+
+  if (old & 1)
+    futex_wake ((int *) &slot->word, INT_MAX);
+}
@@ -44,10 +44,24 @@ extern long int gomp_futex_wait, gomp_futex_wake;
 
 #include "futex.h"
 
-static inline void do_wait (int *addr, int val)
+extern void gomp_adaptive_wait (int *, int, unsigned int *);
+extern unsigned int gomp_spin_estimate;
+
+/* Wait until *ADDR is no longer VAL.  With GOMP_SPINCOUNT=adaptive, the
+   number of spins before blocking is derived from *ESTIMATE, which
+   tracks how long recent waits on the same object took.  */
+
+static inline void do_wait_estimate (int *addr, int val,
+				     unsigned int *estimate)
 {
   unsigned long long i, count = gomp_spin_count_var;
 
+  if (__builtin_expect (gomp_spin_adaptive_var, 0))
+    {
+      gomp_adaptive_wait (addr, val, estimate);
+      return;
+    }
+
   if (__builtin_expect (gomp_managed_threads > gomp_available_cpus, 0))
     count = gomp_throttled_spin_count_var;
   for (i = 0; i < count; i++)
@@ -58,6 +72,24 @@ static inline void do_wait (int *addr, int val)
   futex_wait (addr, val);
 }
 
+/* Likewise, for waits with no object of their own to keep an estimate
+   in.  Those use an estimate per thread, or gomp_spin_estimate for
+   threads libgomp knows nothing about, which without TLS have no
+   struct gomp_thread.  */
+
+static inline void do_wait (int *addr, int val)
+{
+  unsigned int *estimate = &gomp_spin_estimate;
+
+  if (__builtin_expect (gomp_spin_adaptive_var, 0))
+    {
+      struct gomp_thread *thr = gomp_thread ();
+      if (thr != NULL)
+	estimate = &thr->spin_estimate;
+    }
+  do_wait_estimate (addr, val, estimate);
+}
+
 #ifdef HAVE_ATTRIBUTE_VISIBILITY
 # pragma GCC visibility pop
 #endif
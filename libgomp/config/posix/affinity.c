@@ -32,7 +32,17 @@ gomp_init_affinity (void)
 }
 
 void
-gomp_init_thread_affinity (pthread_attr_t *attr)
+gomp_init_thread_affinity (pthread_attr_t *attr, unsigned int place)
 {
   (void) attr;
+  (void) place;
+}
+
+bool
+gomp_cpu_topology (unsigned cpu, unsigned *package, unsigned *core)
+{
+  (void) cpu;
+  (void) package;
+  (void) core;
+  return false;
 }
@@ -72,6 +72,7 @@ gomp_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
 {
   unsigned int n;
 
+  gomp_trace (GOMP_TRACE_BARRIER_BEGIN, 0, (uintptr_t) bar);
   if (state & 1)
     {
       n = --bar->arrived;
@@ -100,6 +101,7 @@ gomp_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
       if (n == 0)
 	gomp_sem_post (&bar->sem2);
     }
+  gomp_trace (GOMP_TRACE_BARRIER_END, 0, (uintptr_t) bar);
 }
 
 void
@@ -113,6 +115,7 @@ gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
 {
   unsigned int n;
 
+  gomp_trace (GOMP_TRACE_BARRIER_BEGIN, 1, (uintptr_t) bar);
   if (state & 1)
     {
       n = --bar->arrived;
@@ -125,6 +128,7 @@ gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
 	  if (n > 0)
 	    gomp_sem_wait (&bar->sem2);
 	  gomp_mutex_unlock (&bar->mutex1);
+	  gomp_trace (GOMP_TRACE_BARRIER_END, 1, (uintptr_t) bar);
 	  return;
 	}
 
@@ -160,6 +164,7 @@ gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
       if (n == 0)
 	gomp_sem_post (&bar->sem2);
     }
+  gomp_trace (GOMP_TRACE_BARRIER_END, 1, (uintptr_t) bar);
 }
 
 void
@@ -0,0 +1 @@
+/* Everything is in the header.  */
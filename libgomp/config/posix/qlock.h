@@ -0,0 +1,67 @@
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This is the default implementation of queued locks for libgomp, which
+   has none: locks and critical sections always use a gomp_mutex_t, and
+   GOMP_LOCK and GOMP_LOCK_STATS are ignored.  */
+
+#ifndef GOMP_QLOCK_H
+#define GOMP_QLOCK_H 1
+
+enum gomp_qlock_kind
+{
+  GOMP_QLOCK_LOCK,
+  GOMP_QLOCK_NEST_LOCK,
+  GOMP_QLOCK_CRITICAL,
+  GOMP_QLOCK_CRITICAL_NAME
+};
+
+static inline bool gomp_qlock_enabled (void)
+{
+  return false;
+}
+
+static inline void gomp_qlock_init (int *word, enum gomp_qlock_kind kind,
+				    void *id)
+{
+}
+
+static inline void gomp_qlock_destroy (int *word)
+{
+}
+
+static inline void gomp_qlock_acquire (int *word, enum gomp_qlock_kind kind,
+				       void *id)
+{
+}
+
+static inline bool gomp_qlock_try (int *word)
+{
+  return false;
+}
+
+static inline void gomp_qlock_release (int *word)
+{
+}
+
+#endif /* GOMP_QLOCK_H */
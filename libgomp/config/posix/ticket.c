@@ -0,0 +1,56 @@
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This is the default implementation of a ticket slot for libgomp.  */
+
+#include "libgomp.h"
+
+
+void
+gomp_ticket_wait (gomp_ticket_t *slot, unsigned ticket)
+{
+  gomp_mutex_lock (&slot->lock);
+  while (slot->ticket != ticket)
+    {
+      slot->waiters++;
+      gomp_mutex_unlock (&slot->lock);
+      gomp_sem_wait (&slot->sem);
+      gomp_mutex_lock (&slot->lock);
+    }
+  gomp_mutex_unlock (&slot->lock);
+}
+
+void
+gomp_ticket_grant (gomp_ticket_t *slot, unsigned ticket)
+{
+  unsigned n;
+
+  gomp_mutex_lock (&slot->lock);
+  slot->ticket = ticket;
+  n = slot->waiters;
+  slot->waiters = 0;
+  gomp_mutex_unlock (&slot->lock);
+
+  while (n-- > 0)
+    gomp_sem_post (&slot->sem);
+}
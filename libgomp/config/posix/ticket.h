@@ -0,0 +1,59 @@
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This is the default implementation of a ticket slot for libgomp.
+   A thread holding a ticket waits until the slot shows that ticket, and
+   the thread before it hands over by writing the ticket into the slot.
+   This type is private to the library.  */
+
+#ifndef GOMP_TICKET_H
+#define GOMP_TICKET_H 1
+
+typedef struct
+{
+  /* The ticket allowed to proceed.  */
+  unsigned ticket __attribute__((aligned (64)));
+  /* The number of threads blocked on SEM.  */
+  unsigned waiters;
+  gomp_mutex_t lock;
+  gomp_sem_t sem;
+} gomp_ticket_t;
+
+static inline void gomp_ticket_init (gomp_ticket_t *slot, unsigned ticket)
+{
+  slot->ticket = ticket;
+  slot->waiters = 0;
+  gomp_mutex_init (&slot->lock);
+  gomp_sem_init (&slot->sem, 0);
+}
+
+extern void gomp_ticket_wait (gomp_ticket_t *, unsigned);
+extern void gomp_ticket_grant (gomp_ticket_t *, unsigned);
+
+static inline void gomp_ticket_destroy (gomp_ticket_t *slot)
+{
+  gomp_mutex_destroy (&slot->lock);
+  gomp_sem_destroy (&slot->sem);
+}
+
+#endif /* GOMP_TICKET_H */
@@ -29,17 +29,24 @@
 
 
 static gomp_mutex_t default_lock;
+static int default_qlock;
 
 void
 GOMP_critical_start (void)
 {
-  gomp_mutex_lock (&default_lock);
+  if (gomp_qlock_enabled ())
+    gomp_qlock_acquire (&default_qlock, GOMP_QLOCK_CRITICAL, NULL);
+  else
+    gomp_mutex_lock (&default_lock);
 }
 
 void
 GOMP_critical_end (void)
 {
-  gomp_mutex_unlock (&default_lock);
+  if (gomp_qlock_enabled ())
+    gomp_qlock_release (&default_qlock);
+  else
+    gomp_mutex_unlock (&default_lock);
 }
 
 #ifndef HAVE_SYNC_BUILTINS
@@ -51,6 +58,14 @@ GOMP_critical_name_start (void **pptr)
 {
   gomp_mutex_t *plock;
 
+  /* A queued lock is created on first use, its word living in the
+     pointer space.  */
+  if (gomp_qlock_enabled ())
+    {
+      gomp_qlock_acquire ((int *) pptr, GOMP_QLOCK_CRITICAL_NAME, pptr);
+      return;
+    }
+
   /* If a mutex fits within the space for a pointer, and is zero initialized,
      then use the pointer space directly.  */
   if (GOMP_MUTEX_INIT_0
@@ -100,6 +115,12 @@ GOMP_critical_name_end (void **pptr)
 {
   gomp_mutex_t *plock;
 
+  if (gomp_qlock_enabled ())
+    {
+      gomp_qlock_release ((int *) pptr);
+      return;
+    }
+
   /* If a mutex fits within the space for a pointer, and is zero initialized,
      then use the pointer space directly.  */
   if (GOMP_MUTEX_INIT_0
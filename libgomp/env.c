@@ -58,6 +58,7 @@ struct gomp_task_icv gomp_global_icv = {
 
 unsigned short *gomp_cpu_affinity;
 size_t gomp_cpu_affinity_len;
+enum gomp_affinity_kind gomp_cpu_affinity_kind;
 unsigned long gomp_max_active_levels_var = INT_MAX;
 unsigned long gomp_thread_limit_var = ULONG_MAX;
 unsigned long gomp_remaining_threads_count;
@@ -66,6 +67,10 @@ gomp_mutex_t gomp_remaining_threads_lock;
 #endif
 unsigned long gomp_available_cpus = 1, gomp_managed_threads = 1;
 unsigned long long gomp_spin_count_var, gomp_throttled_spin_count_var;
+unsigned long gomp_barrier_fanin_var;
+bool gomp_adaptive_chunk_var;
+bool gomp_spin_adaptive_var;
+bool gomp_lock_mcs_var, gomp_lock_stats_var;
 
 /* Parse the OMP_SCHEDULE environment variable.  */
 
@@ -239,7 +244,8 @@ parse_stacksize (const char *name, unsigned long *pvalue)
 }
 
 /* Parse the GOMP_SPINCOUNT environment varible.  Return true if one was
-   present and it was successfully parsed.  */
+   present and it was successfully parsed.  If it is "adaptive", set
+   gomp_spin_adaptive_var and return false.  */
 
 static bool
 parse_spincount (const char *name, unsigned long long *pvalue)
@@ -264,6 +270,19 @@ parse_spincount (const char *name, unsigned long long *pvalue)
       goto check_tail;
     }
 
+  /* "adaptive" leaves *PVALUE alone.  It then bounds the spin counts
+     adapted to recent waits.  */
+  if (strncasecmp (env, "adaptive", 8) == 0)
+    {
+      end = env + 8;
+      while (isspace ((unsigned char) *end))
+	++end;
+      if (*end != '\0')
+	goto invalid;
+      gomp_spin_adaptive_var = true;
+      return false;
+    }
+
   errno = 0;
   value = strtoull (env, &end, 10);
   if (errno)
@@ -378,8 +397,123 @@ parse_wait_policy (void)
   return -1;
 }
 
+/* Parse the GOMP_BARRIER environment variable.  "central" selects the
+   default barrier, where all threads arrive on a single counter, and
+   "tree" optionally followed by ",FANIN" selects a combining tree of
+   arrival counters with at most FANIN threads sharing each counter.  */
+
+static void
+parse_barrier (void)
+{
+  char *env, *end;
+  unsigned long value;
+
+  env = getenv ("GOMP_BARRIER");
+  if (env == NULL)
+    return;
+
+  while (isspace ((unsigned char) *env))
+    ++env;
+  if (strncasecmp (env, "central", 7) == 0)
+    {
+      value = 0;
+      env += 7;
+    }
+  else if (strncasecmp (env, "tree", 4) == 0)
+    {
+      value = 8;
+      env += 4;
+    }
+  else
+    goto invalid;
+
+  while (isspace ((unsigned char) *env))
+    ++env;
+  if (*env == ',' && value != 0)
+    {
+      ++env;
+      while (isspace ((unsigned char) *env))
+	++env;
+      errno = 0;
+      value = strtoul (env, &end, 10);
+      if (errno || env == end || value < 2 || value > 64)
+	goto invalid;
+      env = end;
+      while (isspace ((unsigned char) *env))
+	++env;
+    }
+  if (*env != '\0')
+    goto invalid;
+
+  gomp_barrier_fanin_var = value;
+  return;
+
+ invalid:
+  gomp_error ("Invalid value for environment variable GOMP_BARRIER");
+}
+
+/* Parse the GOMP_LOCK environment variable, selecting how waiters
+   queue on omp locks and critical sections, "mutex" (the default) or
+   "mcs", and GOMP_LOCK_STATS.  */
+
+static void
+parse_lock (void)
+{
+  char *env;
+
+  parse_boolean ("GOMP_LOCK_STATS", &gomp_lock_stats_var);
+
+  env = getenv ("GOMP_LOCK");
+  if (env == NULL)
+    return;
+
+  while (isspace ((unsigned char) *env))
+    ++env;
+  if (strncasecmp (env, "mutex", 5) == 0)
+    {
+      gomp_lock_mcs_var = false;
+      env += 5;
+    }
+  else if (strncasecmp (env, "mcs", 3) == 0)
+    {
+      gomp_lock_mcs_var = true;
+      env += 3;
+    }
+  else
+    goto invalid;
+
+  while (isspace ((unsigned char) *env))
+    ++env;
+  if (*env == '\0')
+    return;
+
+ invalid:
+  gomp_lock_mcs_var = false;
+  gomp_error ("Invalid value for environment variable GOMP_LOCK");
+}
+
+/* Parse the GOMP_TRACE environment variable, naming the file runtime
+   events are written to, and GOMP_TRACE_BUFFER, the number of events
+   kept per thread, and start tracing if GOMP_TRACE is set.  */
+
+static void
+parse_trace (void)
+{
+  const char *env;
+  unsigned long size;
+
+  env = getenv ("GOMP_TRACE");
+  if (env == NULL || *env == '\0')
+    return;
+  if (!parse_unsigned_long ("GOMP_TRACE_BUFFER", &size))
+    size = 65536;
+  gomp_trace_init (env, size);
+}
+
 /* Parse the GOMP_CPU_AFFINITY environment varible.  Return true if one was
-   present and it was successfully parsed.  */
+   present and it was successfully parsed.  Instead of a list of CPUs it
+   may name a placement policy, "compact" or "spread", in which case the
+   list is computed by gomp_init_affinity.  */
 
 static bool
 parse_affinity (void)
@@ -393,6 +527,28 @@ parse_affinity (void)
   if (env == NULL)
     return false;
 
+  while (*env == ' ' || *env == '\t')
+    env++;
+  if (strncasecmp (env, "compact", 7) == 0)
+    {
+      gomp_cpu_affinity_kind = GOMP_AFFINITY_COMPACT;
+      env += 7;
+    }
+  else if (strncasecmp (env, "spread", 6) == 0)
+    {
+      gomp_cpu_affinity_kind = GOMP_AFFINITY_SPREAD;
+      env += 6;
+    }
+  if (gomp_cpu_affinity_kind != GOMP_AFFINITY_LIST)
+    {
+      while (*env == ' ' || *env == '\t')
+	env++;
+      if (*env == '\0')
+	return true;
+      gomp_cpu_affinity_kind = GOMP_AFFINITY_LIST;
+      goto invalid;
+    }
+
   do
     {
       while (*env == ' ' || *env == '\t')
@@ -500,13 +656,15 @@ initialize_env (void)
       /* Using a rough estimation of 100000 spins per msec,
 	 use 5 min blocking for OMP_WAIT_POLICY=active,
 	 200 msec blocking when OMP_WAIT_POLICY is not specificed
-	 and 0 when OMP_WAIT_POLICY=passive.
+	 and 0 when OMP_WAIT_POLICY=passive.  With GOMP_SPINCOUNT=adaptive
+	 and no OMP_WAIT_POLICY, waits longer than 1 msec are not worth
+	 spinning for.
 	 Depending on the CPU speed, this can be e.g. 5 times longer
 	 or 5 times shorter.  */
       if (wait_policy > 0)
 	gomp_spin_count_var = 30000000000LL;
       else if (wait_policy < 0)
-	gomp_spin_count_var = 20000000LL;
+	gomp_spin_count_var = gomp_spin_adaptive_var ? 100000LL : 20000000LL;
     }
   /* gomp_throttled_spin_count_var is used when there are more libgomp
      managed threads than available CPUs.  Use very short spinning.  */
@@ -516,6 +674,10 @@ initialize_env (void)
     gomp_throttled_spin_count_var = 100LL;
   if (gomp_throttled_spin_count_var > gomp_spin_count_var)
     gomp_throttled_spin_count_var = gomp_spin_count_var;
+  parse_barrier ();
+  parse_boolean ("GOMP_ADAPTIVE_CHUNK", &gomp_adaptive_chunk_var);
+  parse_lock ();
+  parse_trace ();
 
   /* Not strictly environment related, but ordering constructors is tricky.  */
   pthread_attr_init (&gomp_thread_attr);
@@ -29,6 +29,15 @@
 #include <stdlib.h>
 
 
+/* Record for GOMP_TRACE that the chunk START to END of WS has been
+   handed out.  */
+
+static inline void
+trace_chunk (struct gomp_work_share *ws, long start, long end)
+{
+  gomp_trace (GOMP_TRACE_LOOP_CHUNK, (end - start) / ws->incr, start);
+}
+
 /* This function implements the STATIC scheduling method.  The caller should
    iterate *pstart <= x < *pend.  Return zero if there are more iterations
    to perform; nonzero if not.  Return less than 0 if this thread had
@@ -94,6 +103,7 @@ gomp_iter_static_next (long *pstart, long *pend)
       *pstart = s;
       *pend = e;
       thr->ts.static_trip = (e0 == n ? -1 : 1);
+      trace_chunk (ws, s, e);
       return 0;
     }
   else
@@ -131,6 +141,7 @@ gomp_iter_static_next (long *pstart, long *pend)
 	thr->ts.static_trip = -1;
       else
 	thr->ts.static_trip++;
+      trace_chunk (ws, s, e);
       return 0;
     }
 }
@@ -168,11 +179,86 @@ gomp_iter_dynamic_next_locked (long *pstart, long *pend)
   ws->next = end;
   *pstart = start;
   *pend = end;
+  trace_chunk (ws, start, end);
   return true;
 }
 
 
 #ifdef HAVE_SYNC_BUILTINS
+/* The adaptive variant of gomp_iter_dynamic_next.  Claims chunk_scale
+   chunks at a time with compare-and-swap, doubles chunk_scale whenever
+   another thread got in between and lets it decay while there is no
+   contention.  A chunk never exceeds half of what an even split of the
+   remaining iterations among the team would give each thread, so the
+   tail of the loop stays balanced as with the plain DYNAMIC schedule.  */
+
+static bool
+gomp_iter_dynamic_next_adaptive (struct gomp_work_share *ws, long *pstart,
+				 long *pend)
+{
+  struct gomp_team *team = gomp_thread ()->ts.team;
+  unsigned long nthreads = team ? team->nthreads : 1;
+  unsigned long scale, nscale, max_scale, fails = 0;
+  long start, end, nend, chunk, incr;
+
+  end = ws->end;
+  incr = ws->incr;
+  chunk = ws->chunk_size;
+  scale = ws->chunk_scale;
+
+  start = ws->next;
+  while (1)
+    {
+      long left = end - start;
+      long tmp;
+
+      if (start == end)
+	return false;
+
+      /* LEFT and CHUNK have the same sign, and CHUNK * MAX_SCALE can't
+	 exceed LEFT.  */
+      max_scale = (unsigned long) (left / chunk) / (2 * nthreads);
+      if (scale > max_scale)
+	scale = max_scale ? max_scale : 1;
+
+      if (incr < 0)
+	{
+	  if (chunk * (long) scale < left)
+	    nend = end;
+	  else
+	    nend = start + chunk * (long) scale;
+	}
+      else
+	{
+	  if (chunk * (long) scale > left)
+	    nend = end;
+	  else
+	    nend = start + chunk * (long) scale;
+	}
+
+      tmp = __sync_val_compare_and_swap (&ws->next, start, nend);
+      if (__builtin_expect (tmp == start, 1))
+	break;
+
+      start = tmp;
+      fails++;
+    }
+
+  if (fails)
+    nscale = scale * 2 <= max_scale ? scale * 2 : scale;
+  else
+    nscale = scale - (scale >> 3) - (scale > 1);
+  if (nscale == 0)
+    nscale = 1;
+  if (nscale != ws->chunk_scale)
+    ws->chunk_scale = nscale;
+
+  *pstart = start;
+  *pend = nend;
+  trace_chunk (ws, start, nend);
+  return true;
+}
+
 /* Similar, but doesn't require the lock held, and uses compare-and-swap
    instead.  Note that the only memory value that changes is ws->next.  */
 
@@ -183,11 +269,14 @@ gomp_iter_dynamic_next (long *pstart, long *pend)
   struct gomp_work_share *ws = thr->ts.work_share;
   long start, end, nend, chunk, incr;
 
+  if (__builtin_expect (ws->mode & 4, 0))
+    return gomp_iter_dynamic_next_adaptive (ws, pstart, pend);
+
   end = ws->end;
   incr = ws->incr;
   chunk = ws->chunk_size;
 
-  if (__builtin_expect (ws->mode, 1))
+  if (__builtin_expect (ws->mode & 1, 1))
     {
       long tmp = __sync_fetch_and_add (&ws->next, chunk);
       if (incr > 0)
@@ -199,6 +288,7 @@ gomp_iter_dynamic_next (long *pstart, long *pend)
 	    nend = end;
 	  *pstart = tmp;
 	  *pend = nend;
+	  trace_chunk (ws, tmp, nend);
 	  return true;
 	}
       else
@@ -210,6 +300,7 @@ gomp_iter_dynamic_next (long *pstart, long *pend)
 	    nend = end;
 	  *pstart = tmp;
 	  *pend = nend;
+	  trace_chunk (ws, tmp, nend);
 	  return true;
 	}
     }
@@ -244,6 +335,7 @@ gomp_iter_dynamic_next (long *pstart, long *pend)
 
   *pstart = start;
   *pend = nend;
+  trace_chunk (ws, start, nend);
   return true;
 }
 #endif /* HAVE_SYNC_BUILTINS */
@@ -280,6 +372,7 @@ gomp_iter_guided_next_locked (long *pstart, long *pend)
   ws->next = end;
   *pstart = start;
   *pend = end;
+  trace_chunk (ws, start, end);
   return true;
 }
 
@@ -329,6 +422,89 @@ gomp_iter_guided_next (long *pstart, long *pend)
 
   *pstart = start;
   *pend = nend;
+  trace_chunk (ws, start, nend);
+  return true;
+}
+
+/* The DYNAMIC scheduling method for ordered loops with bit 3 of ws->mode
+   set.  The chunks are numbered, and a single fetch-and-add on
+   ws->ordered_claim claims the next chunk together with its number,
+   which is its ticket.  Arguments are as for gomp_iter_dynamic_next,
+   and *PTICKET receives the ticket.  */
+
+bool
+gomp_iter_ordered_dynamic_next (long *pstart, long *pend, unsigned *pticket)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_work_share *ws = thr->ts.work_share;
+  unsigned long k;
+  long start, end;
+
+  k = __sync_fetch_and_add (&ws->ordered_claim, 1);
+  if (k >= ws->ordered_count)
+    return false;
+
+  start = ws->next + (long) k * ws->chunk_size;
+  if (k == ws->ordered_count - 1)
+    end = ws->end;
+  else
+    end = start + ws->chunk_size;
+
+  *pstart = start;
+  *pend = end;
+  *pticket = k;
+  trace_chunk (ws, start, end);
+  return true;
+}
+
+/* The GUIDED scheduling method for ordered loops with bit 3 of ws->mode
+   set.  ws->ordered_claim holds the ticket of the next chunk in its upper
+   half and the number of iterations handed out in its lower half, so a
+   single compare-and-swap claims a chunk together with its ticket.
+   Arguments are as for gomp_iter_ordered_dynamic_next.  */
+
+bool
+gomp_iter_ordered_guided_next (long *pstart, long *pend, unsigned *pticket)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_work_share *ws = thr->ts.work_share;
+  struct gomp_team *team = thr->ts.team;
+  unsigned long nthreads = team ? team->nthreads : 1;
+  const int half = sizeof (long) * __CHAR_BIT__ / 2;
+  unsigned long n, claim, done, q;
+  long start, end;
+
+  n = ws->ordered_count;
+  claim = ws->ordered_claim;
+  while (1)
+    {
+      unsigned long tmp;
+
+      done = claim & ((1UL << half) - 1);
+      if (done == n)
+	return false;
+
+      q = (n - done + nthreads - 1) / nthreads;
+      if (q < ws->chunk_size)
+	q = ws->chunk_size;
+      if (q > n - done)
+	q = n - done;
+
+      tmp = __sync_val_compare_and_swap (&ws->ordered_claim, claim,
+					 claim + (1UL << half) + q);
+      if (__builtin_expect (tmp == claim, 1))
+	break;
+
+      claim = tmp;
+    }
+
+  start = ws->next + (long) done * ws->incr;
+  end = start + (long) q * ws->incr;
+
+  *pstart = start;
+  *pend = end;
+  *pticket = claim >> half;
+  trace_chunk (ws, start, end);
   return true;
 }
 #endif /* HAVE_SYNC_BUILTINS */
@@ -30,6 +30,21 @@
 
 typedef unsigned long long gomp_ull;
 
+/* Record for GOMP_TRACE that the chunk START to END of WS has been
+   handed out.  */
+
+static inline void
+trace_chunk_ull (struct gomp_work_share *ws, gomp_ull start, gomp_ull end)
+{
+  gomp_ull n;
+
+  if (__builtin_expect (ws->mode & 2, 0))
+    n = (start - end) / -ws->incr_ull;
+  else
+    n = (end - start) / ws->incr_ull;
+  gomp_trace (GOMP_TRACE_LOOP_CHUNK, n, start);
+}
+
 /* This function implements the STATIC scheduling method.  The caller should
    iterate *pstart <= x < *pend.  Return zero if there are more iterations
    to perform; nonzero if not.  Return less than 0 if this thread had
@@ -95,6 +110,7 @@ gomp_iter_ull_static_next (gomp_ull *pstart, gomp_ull *pend)
       *pstart = s;
       *pend = e;
       thr->ts.static_trip = (e0 == n ? -1 : 1);
+      trace_chunk_ull (ws, s, e);
       return 0;
     }
   else
@@ -133,6 +149,7 @@ gomp_iter_ull_static_next (gomp_ull *pstart, gomp_ull *pend)
 	thr->ts.static_trip = -1;
       else
 	thr->ts.static_trip++;
+      trace_chunk_ull (ws, s, e);
       return 0;
     }
 }
@@ -170,11 +187,82 @@ gomp_iter_ull_dynamic_next_locked (gomp_ull *pstart, gomp_ull *pend)
   ws->next_ull = end;
   *pstart = start;
   *pend = end;
+  trace_chunk_ull (ws, start, end);
   return true;
 }
 
 
-#if defined HAVE_SYNC_BUILTINS && defined __LP64__
+#ifdef HAVE_SYNC_BUILTINS_ULL
+/* The adaptive variant of gomp_iter_ull_dynamic_next, see
+   gomp_iter_dynamic_next_adaptive.  */
+
+static bool
+gomp_iter_ull_dynamic_next_adaptive (struct gomp_work_share *ws,
+				     gomp_ull *pstart, gomp_ull *pend)
+{
+  struct gomp_team *team = gomp_thread ()->ts.team;
+  gomp_ull nthreads = team ? team->nthreads : 1;
+  unsigned long scale, nscale, fails = 0;
+  gomp_ull start, end, nend, chunk, n;
+
+  end = ws->end_ull;
+  chunk = ws->chunk_size_ull;
+  scale = ws->chunk_scale;
+
+  start = ws->next_ull;
+  while (1)
+    {
+      gomp_ull left = end - start;
+      gomp_ull tmp;
+
+      if (start == end)
+	return false;
+
+      if (__builtin_expect (ws->mode & 2, 0))
+	n = (-left / -chunk) / (2 * nthreads);
+      else
+	n = (left / chunk) / (2 * nthreads);
+      if (scale > n)
+	scale = n ? n : 1;
+
+      if (__builtin_expect (ws->mode & 2, 0))
+	{
+	  if (chunk * scale < left)
+	    nend = end;
+	  else
+	    nend = start + chunk * scale;
+	}
+      else
+	{
+	  if (chunk * scale > left)
+	    nend = end;
+	  else
+	    nend = start + chunk * scale;
+	}
+
+      tmp = __sync_val_compare_and_swap (&ws->next_ull, start, nend);
+      if (__builtin_expect (tmp == start, 1))
+	break;
+
+      start = tmp;
+      fails++;
+    }
+
+  if (fails)
+    nscale = scale * 2 <= n ? scale * 2 : scale;
+  else
+    nscale = scale - (scale >> 3) - (scale > 1);
+  if (nscale == 0)
+    nscale = 1;
+  if (nscale != ws->chunk_scale)
+    ws->chunk_scale = nscale;
+
+  *pstart = start;
+  *pend = nend;
+  trace_chunk_ull (ws, start, nend);
+  return true;
+}
+
 /* Similar, but doesn't require the lock held, and uses compare-and-swap
    instead.  Note that the only memory value that changes is ws->next_ull.  */
 
@@ -185,6 +273,9 @@ gomp_iter_ull_dynamic_next (gomp_ull *pstart, gomp_ull *pend)
   struct gomp_work_share *ws = thr->ts.work_share;
   gomp_ull start, end, nend, chunk;
 
+  if (__builtin_expect (ws->mode & 4, 0))
+    return gomp_iter_ull_dynamic_next_adaptive (ws, pstart, pend);
+
   end = ws->end_ull;
   chunk = ws->chunk_size_ull;
 
@@ -200,6 +291,7 @@ gomp_iter_ull_dynamic_next (gomp_ull *pstart, gomp_ull *pend)
 	    nend = end;
 	  *pstart = tmp;
 	  *pend = nend;
+	  trace_chunk_ull (ws, tmp, nend);
 	  return true;
 	}
       else
@@ -211,6 +303,7 @@ gomp_iter_ull_dynamic_next (gomp_ull *pstart, gomp_ull *pend)
 	    nend = end;
 	  *pstart = tmp;
 	  *pend = nend;
+	  trace_chunk_ull (ws, tmp, nend);
 	  return true;
 	}
     }
@@ -245,9 +338,10 @@ gomp_iter_ull_dynamic_next (gomp_ull *pstart, gomp_ull *pend)
 
   *pstart = start;
   *pend = nend;
+  trace_chunk_ull (ws, start, nend);
   return true;
 }
-#endif /* HAVE_SYNC_BUILTINS */
+#endif /* HAVE_SYNC_BUILTINS_ULL */
 
 
 /* This function implements the GUIDED scheduling method.  Arguments are
@@ -268,7 +362,7 @@ gomp_iter_ull_guided_next_locked (gomp_ull *pstart, gomp_ull *pend)
     return false;
 
   start = ws->next_ull;
-  if (__builtin_expect (ws->mode, 0) == 0)
+  if (__builtin_expect (ws->mode & 2, 0) == 0)
     n = (ws->end_ull - start) / ws->incr_ull;
   else
     n = (start - ws->end_ull) / -ws->incr_ull;
@@ -284,10 +378,11 @@ gomp_iter_ull_guided_next_locked (gomp_ull *pstart, gomp_ull *pend)
   ws->next_ull = end;
   *pstart = start;
   *pend = end;
+  trace_chunk_ull (ws, start, end);
   return true;
 }
 
-#if defined HAVE_SYNC_BUILTINS && defined __LP64__
+#ifdef HAVE_SYNC_BUILTINS_ULL
 /* Similar, but doesn't require the lock held, and uses compare-and-swap
    instead.  Note that the only memory value that changes is ws->next_ull.  */
 
@@ -314,7 +409,7 @@ gomp_iter_ull_guided_next (gomp_ull *pstart, gomp_ull *pend)
       if (start == end)
 	return false;
 
-      if (__builtin_expect (ws->mode, 0) == 0)
+      if (__builtin_expect (ws->mode & 2, 0) == 0)
 	n = (end - start) / incr;
       else
 	n = (start - end) / -incr;
@@ -336,6 +431,84 @@ gomp_iter_ull_guided_next (gomp_ull *pstart, gomp_ull *pend)
 
   *pstart = start;
   *pend = nend;
+  trace_chunk_ull (ws, start, nend);
+  return true;
+}
+
+/* The DYNAMIC scheduling method for ordered loops with bit 3 of ws->mode
+   set, see gomp_iter_ordered_dynamic_next.  */
+
+bool
+gomp_iter_ull_ordered_dynamic_next (gomp_ull *pstart, gomp_ull *pend,
+				    unsigned *pticket)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_work_share *ws = thr->ts.work_share;
+  gomp_ull k, start, end;
+
+  k = __sync_fetch_and_add (&ws->ordered_claim_ull, 1);
+  if (k >= ws->ordered_count_ull)
+    return false;
+
+  start = ws->next_ull + k * ws->chunk_size_ull;
+  if (k == ws->ordered_count_ull - 1)
+    end = ws->end_ull;
+  else
+    end = start + ws->chunk_size_ull;
+
+  *pstart = start;
+  *pend = end;
+  *pticket = k;
+  trace_chunk_ull (ws, start, end);
+  return true;
+}
+
+/* The GUIDED scheduling method for ordered loops with bit 3 of ws->mode
+   set, see gomp_iter_ordered_guided_next.  */
+
+bool
+gomp_iter_ull_ordered_guided_next (gomp_ull *pstart, gomp_ull *pend,
+				   unsigned *pticket)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_work_share *ws = thr->ts.work_share;
+  struct gomp_team *team = thr->ts.team;
+  gomp_ull nthreads = team ? team->nthreads : 1;
+  const int half = sizeof (gomp_ull) * __CHAR_BIT__ / 2;
+  gomp_ull n, claim, done, q, start, end;
+
+  n = ws->ordered_count_ull;
+  claim = ws->ordered_claim_ull;
+  while (1)
+    {
+      gomp_ull tmp;
+
+      done = claim & ((1ULL << half) - 1);
+      if (done == n)
+	return false;
+
+      q = (n - done + nthreads - 1) / nthreads;
+      if (q < ws->chunk_size_ull)
+	q = ws->chunk_size_ull;
+      if (q > n - done)
+	q = n - done;
+
+      tmp = __sync_val_compare_and_swap (&ws->ordered_claim_ull, claim,
+					 claim + (1ULL << half) + q);
+      if (__builtin_expect (tmp == claim, 1))
+	break;
+
+      claim = tmp;
+    }
+
+  /* This wraps around as needed for loops iterating downwards.  */
+  start = ws->next_ull + done * ws->incr_ull;
+  end = start + q * ws->incr_ull;
+
+  *pstart = start;
+  *pend = end;
+  *pticket = claim >> half;
+  trace_chunk_ull (ws, start, end);
   return true;
 }
-#endif /* HAVE_SYNC_BUILTINS */
+#endif /* HAVE_SYNC_BUILTINS_ULL */
@@ -44,12 +44,26 @@
 # pragma GCC visibility push(hidden)
 #endif
 
+/* The unsigned long long loops can claim iterations without the work
+   share lock wherever 8 byte compare-and-swap is available, which
+   includes 32-bit hosts such as i586 and later.  */
+#if defined HAVE_SYNC_BUILTINS \
+    && (defined __LP64__ || defined __GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+# define HAVE_SYNC_BUILTINS_ULL 1
+#endif
+
 #include "sem.h"
 #include "mutex.h"
 #include "bar.h"
 #include "ptrlock.h"
+#include "ticket.h"
+#include "qlock.h"
 
 
+/* The number of slots for ordered loops each work share has room for,
+   which must be a power of two.  */
+#define INLINE_ORDERED_SLOTS 4
+
 /* This structure contains the data to control one work-sharing construct,
    either a LOOP (FOR/DO) or a SECTIONS.  */
 
@@ -69,6 +83,12 @@ struct gomp_work_share
      If this is a SECTIONS construct, this value will always be DYNAMIC.  */
   enum gomp_schedule_type sched;
 
+  /* Bit 0 is set if DYNAMIC iterations may be claimed with fetch-and-add
+     without risking overflow of next, bit 1 is set for unsigned long long
+     loops that iterate downwards, bit 2 is set if the DYNAMIC chunk is
+     adapted to contention, see chunk_scale, and bit 3 is set if the
+     chunks of an ordered DYNAMIC or GUIDED loop are claimed together
+     with their tickets through ordered_claim.  */
   int mode;
 
   union {
@@ -93,27 +113,24 @@ struct gomp_work_share
     };
   };
 
-  /* This is a circular queue that details which threads will be allowed
-     into the ordered region and in which order.  When a thread allocates
-     iterations on which it is going to work, it also registers itself at
-     the end of the array.  When a thread reaches the ordered region, it
-     checks to see if it is the one at the head of the queue.  If not, it
-     blocks on its RELEASE semaphore.  */
-  unsigned *ordered_team_ids;
-
-  /* This is the number of threads that have registered themselves in
-     the circular queue ordered_team_ids.  */
-  unsigned ordered_num_used;
-
-  /* This is the team_id of the currently acknowledged owner of the ordered
-     section, or -1u if the ordered section has not been acknowledged by
-     any thread.  This is distinguished from the thread that is *allowed*
-     to take the section next.  */
-  unsigned ordered_owner;
-
-  /* This is the index into the circular queue ordered_team_ids of the
-     current thread that's allowed into the ordered reason.  */
-  unsigned ordered_cur;
+  /* The chunks of iterations of an ordered loop are numbered by tickets
+     in the order their ORDERED regions must run.  The thread holding
+     ticket T waits until slot T & ORDERED_MASK shows T, and hands over
+     by writing T + 1 into the next slot.  There are at least as many
+     slots as threads, so every waiting thread watches a slot, and a
+     cache line, of its own.  Small teams use INLINE_ORDERED_SLOTS,
+     otherwise ORDERED_SLOTS_ALLOC is the memory the aligned
+     ORDERED_SLOTS array was carved from.  */
+  gomp_ticket_t *ordered_slots;
+  void *ordered_slots_alloc;
+  unsigned ordered_mask;
+
+  /* With bit 3 of mode set, the number of chunks of a DYNAMIC loop, or
+     the number of iterations of a GUIDED one.  */
+  union {
+    unsigned long ordered_count;
+    unsigned long long ordered_count_ull;
+  };
 
   /* This is a chain of allocated gomp_work_share blocks, valid only
      in the first gomp_work_share struct in the block.  */
@@ -132,6 +149,20 @@ struct gomp_work_share
      of the team to exit the work share construct must deallocate it.  */
   unsigned threads_completed;
 
+  /* The ticket the next chunk of an ordered DYNAMIC or GUIDED loop
+     gets, if bit 3 of mode is clear.  */
+  unsigned ordered_next_ticket;
+
+  /* With bit 3 of mode set, the number of chunks of a DYNAMIC loop
+     claimed so far, which is also the ticket of the next one.  For a
+     GUIDED loop, the ticket of the next chunk in the upper half and the
+     number of iterations claimed so far in the lower half.  The start
+     of the loop stays in next.  */
+  union {
+    unsigned long ordered_claim;
+    unsigned long long ordered_claim_ull;
+  };
+
   union {
     /* This is the next iteration value to be allocated.  In the case of
        GFS_STATIC loops, this the iteration start point and never changes.  */
@@ -144,6 +175,12 @@ struct gomp_work_share
     void *copyprivate;
   };
 
+  /* For DYNAMIC loops with bit 2 of mode set, chunks of chunk_scale times
+     chunk_size iterations are claimed.  It is doubled whenever a claim
+     loses a compare-and-swap race and decays back towards 1 while claims
+     succeed at the first attempt.  */
+  unsigned long chunk_scale;
+
   union {
     /* Link to gomp_work_share struct for next work sharing construct
        encountered after this one.  */
@@ -154,9 +191,8 @@ struct gomp_work_share
     struct gomp_work_share *next_free;
   };
 
-  /* If only few threads are in the team, ordered_team_ids can point
-     to this array which fills the padding at the end of this struct.  */
-  unsigned inline_ordered_team_ids[0];
+  /* The ordered slots of teams of up to INLINE_ORDERED_SLOTS threads.  */
+  gomp_ticket_t inline_ordered_slots[INLINE_ORDERED_SLOTS];
 };
 
 /* This structure contains all of the thread-local data associated with 
@@ -201,6 +237,10 @@ struct gomp_team_state
      is 1, etc.  This is unused when the compiler knows in advance that
      the loop is statically scheduled.  */
   unsigned long static_trip;
+
+  /* In an ordered loop, the ticket of the chunk of iterations this
+     thread is working on.  */
+  unsigned ordered_ticket;
 };
 
 /* These are the OpenMP 3.0 Internal Control Variables described in
@@ -226,6 +266,10 @@ extern gomp_mutex_t gomp_remaining_threads_lock;
 extern unsigned long gomp_max_active_levels_var;
 extern unsigned long long gomp_spin_count_var, gomp_throttled_spin_count_var;
 extern unsigned long gomp_available_cpus, gomp_managed_threads;
+extern unsigned long gomp_barrier_fanin_var;
+extern bool gomp_adaptive_chunk_var;
+extern bool gomp_spin_adaptive_var;
+extern bool gomp_lock_mcs_var, gomp_lock_stats_var;
 
 enum gomp_task_kind
 {
@@ -235,25 +279,59 @@ enum gomp_task_kind
   GOMP_TASK_TIED
 };
 
+/* This bit is set in gomp_task's REFS while the task sleeps in
+   GOMP_taskwait waiting for its last children to complete.  */
+#define GOMP_TASK_REFS_WAITING	0x80000000U
+
 /* This structure describes a "task" to be run by a thread.  */
 
 struct gomp_task
 {
   struct gomp_task *parent;
-  struct gomp_task *children;
-  struct gomp_task *next_child;
-  struct gomp_task *prev_child;
-  struct gomp_task *next_queue;
-  struct gomp_task *prev_queue;
   struct gomp_task_icv icv;
   void (*fn) (void *);
   void *fn_data;
   enum gomp_task_kind kind;
-  bool in_taskwait;
   bool in_tied_task;
+
+  /* True if the task was allocated with room for an argument block of
+     GOMP_TASK_CACHE_ARG_SIZE bytes and may be kept in a free list of
+     task descriptors once it has completed.  Only valid for explicit
+     tasks of a team.  */
+  bool cached;
+
+  /* The number of explicit tasks this task is nested in, within the
+     innermost parallel region.  */
+  unsigned depth;
+
+  /* One reference for the task itself until its body has finished,
+     plus one for each child task that has not completed yet.  The
+     task may be freed once this drops to zero.  */
+  unsigned refs;
+
+  /* The tail index of the executing thread's task deque at the time
+     this task started running.  Entries at or above this index were
+     created by this task or its descendants.  */
+  unsigned long deque_mark;
+
   gomp_sem_t taskwait_sem;
 };
 
+/* This structure is a double-ended queue of deferred tasks.  Each member
+   of a team owns one; the owner pushes and pops newly created tasks at
+   the tail, while idle team members steal the oldest tasks from the
+   head.  HEAD and TAIL grow monotonically and are reduced modulo SIZE
+   to index TASKS.  */
+
+struct gomp_task_deque
+{
+  gomp_mutex_t lock __attribute__((aligned (64)));
+  unsigned long head;
+  unsigned long tail;
+  unsigned long size;
+  struct gomp_task **tasks;
+};
+
 /* This structure describes a "team" of threads.  These are the threads
    that are spawned by a PARALLEL constructs, as well as the work sharing
    constructs that the team encounters.  */
@@ -271,15 +349,6 @@ struct gomp_team
      the current thread was created.  */
   struct gomp_team_state prev_ts;
 
-  /* This semaphore should be used by the master thread instead of its
-     "native" semaphore in the thread structure.  Required for nested
-     parallels, as the master is a member of two teams.  */
-  gomp_sem_t master_release;
-
-  /* This points to an array with pointers to the release semaphore
-     of the threads in the team.  */
-  gomp_sem_t **ordered_release;
-
   /* List of gomp_work_share structs chained through next_free fields.
      This is populated and taken off only by the first thread in the
      team encountering a new work sharing construct, in a critical
@@ -309,11 +378,20 @@ struct gomp_team
      structs in the common case.  */
   struct gomp_work_share work_shares[8];
 
+  /* This lock protects the task related bits of the barrier generation
+     word.  Queueing and dequeueing of tasks only uses task_deques.  */
   gomp_mutex_t task_lock;
-  struct gomp_task *task_queue;
+
+  /* Number of deferred tasks that have not completed yet, the number
+     of those still sitting in one of the task_deques and the number of
+     those currently being executed.  These are updated atomically.  */
   int task_count;
+  int task_queued_count;
   int task_running_count;
 
+  /* This points to an array with one task deque per team member.  */
+  struct gomp_task_deque *task_deques;
+
   /* This array contains structures for implicit tasks.  */
   struct gomp_task implicit_task[];
 };
@@ -334,23 +412,53 @@ struct gomp_thread
   /* This is the task that the thread is currently executing.  */
   struct gomp_task *task;
 
-  /* This semaphore is used for ordered loops.  */
-  gomp_sem_t release;
-
   /* user pthread thread pool */
   struct gomp_thread_pool *thread_pool;
+
+  /* The pools of threads for teams this thread starts while it is
+     itself a member of a team, chained through their nested field in
+     order of increasing level.  They are made when first needed and
+     kept while nesting stays enabled, so that nested teams of later
+     regions reuse their threads, and freed when the thread exits.  */
+  struct gomp_thread_pool *nested_pool;
+
+  /* With GOMP_SPINCOUNT=adaptive, the number of spins recent waits of
+     this thread on locks and semaphores took.  */
+  unsigned int spin_estimate;
+
+  /* With GOMP_TRACE, the ring buffer of events recorded by this thread,
+     allocated on its first event.  */
+  struct gomp_trace_buffer *trace;
+
+  /* Descriptors of completed tasks, linked through their parent field,
+     which GOMP_task reuses instead of allocating new ones.  */
+  struct gomp_task *task_cache;
+  unsigned int task_cache_count;
 };
 
 
 struct gomp_thread_pool
 {
-  /* This array manages threads spawned from the top level, which will
-     return to the idle loop once the current PARALLEL construct ends.  */
+  /* This array manages threads spawned by the owner of the pool, which
+     will return to the idle loop once the current PARALLEL construct
+     ends.  */
   struct gomp_thread **threads;
   unsigned threads_size;
   unsigned threads_used;
   struct gomp_team *last_team;
 
+  /* A team no thread uses any more, kept for reuse by gomp_new_team.  */
+  struct gomp_team *spare_team;
+
+  /* For a nested pool, the nesting level of the owner when it takes
+     threads from this pool, and the owner's pool for a deeper level.  */
+  unsigned level;
+  struct gomp_thread_pool *nested;
+
+  /* True while the threads of this nested pool are not counted in
+     gomp_managed_threads, because its owner is idle.  */
+  bool parked;
+
   /* This barrier holds and releases threads waiting in threads.  */
   gomp_barrier_t threads_dock;
 };
@@ -391,15 +499,27 @@ extern pthread_attr_t gomp_thread_attr;
 
 /* Other variables.  */
 
+/* How the list of CPUs in gomp_cpu_affinity is obtained: given explicitly
+   by GOMP_CPU_AFFINITY, or computed from the processor topology.  */
+
+enum gomp_affinity_kind
+{
+  GOMP_AFFINITY_LIST,
+  GOMP_AFFINITY_COMPACT,
+  GOMP_AFFINITY_SPREAD
+};
+
 extern unsigned short *gomp_cpu_affinity;
 extern size_t gomp_cpu_affinity_len;
+extern enum gomp_affinity_kind gomp_cpu_affinity_kind;
 
 /* Function prototypes.  */
 
 /* affinity.c */
 
 extern void gomp_init_affinity (void);
-extern void gomp_init_thread_affinity (pthread_attr_t *);
+extern void gomp_init_thread_affinity (pthread_attr_t *, unsigned int);
+extern bool gomp_cpu_topology (unsigned, unsigned *, unsigned *);
 
 /* alloc.c */
 
@@ -427,6 +547,8 @@ extern bool gomp_iter_guided_next_locked (long *, long *);
 #ifdef HAVE_SYNC_BUILTINS
 extern bool gomp_iter_dynamic_next (long *, long *);
 extern bool gomp_iter_guided_next (long *, long *);
+extern bool gomp_iter_ordered_dynamic_next (long *, long *, unsigned *);
+extern bool gomp_iter_ordered_guided_next (long *, long *, unsigned *);
 #endif
 
 /* iter_ull.c */
@@ -438,18 +560,26 @@ extern bool gomp_iter_ull_dynamic_next_locked (unsigned long long *,
 extern bool gomp_iter_ull_guided_next_locked (unsigned long long *,
 					      unsigned long long *);
 
-#if defined HAVE_SYNC_BUILTINS && defined __LP64__
+#ifdef HAVE_SYNC_BUILTINS_ULL
 extern bool gomp_iter_ull_dynamic_next (unsigned long long *,
 					unsigned long long *);
 extern bool gomp_iter_ull_guided_next (unsigned long long *,
 				       unsigned long long *);
+extern bool gomp_iter_ull_ordered_dynamic_next (unsigned long long *,
+						unsigned long long *,
+						unsigned *);
+extern bool gomp_iter_ull_ordered_guided_next (unsigned long long *,
+					       unsigned long long *,
+					       unsigned *);
 #endif
 
 /* ordered.c */
 
 extern void gomp_ordered_first (void);
+extern void gomp_ordered_first_ticket (unsigned);
 extern void gomp_ordered_last (void);
 extern void gomp_ordered_next (void);
+extern void gomp_ordered_next_ticket (unsigned);
 extern void gomp_ordered_static_init (void);
 extern void gomp_ordered_static_next (void);
 extern void gomp_ordered_sync (void);
@@ -469,6 +599,7 @@ extern void gomp_init_task (struct gomp_task *, struct gomp_task *,
 			    struct gomp_task_icv *);
 extern void gomp_end_task (void);
 extern void gomp_barrier_handle_tasks (gomp_barrier_state_t);
+extern void gomp_free_task_cache (struct gomp_thread *);
 
 static void inline
 gomp_finish_task (struct gomp_task *task)
@@ -476,6 +607,50 @@ gomp_finish_task (struct gomp_task *task)
   gomp_sem_destroy (&task->taskwait_sem);
 }
 
+/* trace.c */
+
+/* The runtime events GOMP_TRACE records.  The numbers are part of the
+   trace file format and must not change.  */
+
+enum gomp_trace_kind
+{
+  /* ARG0 is the number of threads, ARG1 the outlined function.  */
+  GOMP_TRACE_PARALLEL_BEGIN = 1,
+  GOMP_TRACE_PARALLEL_END = 2,
+  /* ARG0 is 1 for team barriers and 0 for docking threads in a pool,
+     ARG1 the barrier.  */
+  GOMP_TRACE_BARRIER_BEGIN = 3,
+  GOMP_TRACE_BARRIER_END = 4,
+  /* ARG0 is 1 if the task was deferred, ARG1 identifies the task.  */
+  GOMP_TRACE_TASK_CREATE = 5,
+  GOMP_TRACE_TASK_BEGIN = 6,
+  GOMP_TRACE_TASK_END = 7,
+  /* ARG0 is the number of iterations, ARG1 the first one.  */
+  GOMP_TRACE_LOOP_CHUNK = 8,
+  /* The implicit task of a thread other than the master, ARG1 being
+     the outlined function.  */
+  GOMP_TRACE_IMPLICIT_BEGIN = 9,
+  GOMP_TRACE_IMPLICIT_END = 10
+};
+
+extern bool gomp_trace_var;
+extern void gomp_trace_init (const char *, unsigned long);
+extern void gomp_trace_record (enum gomp_trace_kind, unsigned int,
+			       unsigned long long);
+
+/* Record an event if GOMP_TRACE is set.  Building libgomp with
+   LIBGOMP_NO_TRACE defined removes the tracing hooks altogether.  */
+
+static inline void
+gomp_trace (enum gomp_trace_kind kind, unsigned int arg0,
+	    unsigned long long arg1)
+{
+#ifndef LIBGOMP_NO_TRACE
+  if (__builtin_expect (gomp_trace_var, 0))
+    gomp_trace_record (kind, arg0, arg1);
+#endif
+}
+
 /* team.c */
 
 extern struct gomp_team *gomp_new_team (unsigned);
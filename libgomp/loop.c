@@ -42,6 +42,7 @@ gomp_loop_init (struct gomp_work_share *ws, long start, long end, long incr,
 	    ? start : end;
   ws->incr = incr;
   ws->next = start;
+  ws->mode = 0;
   if (sched == GFS_DYNAMIC)
     {
       ws->chunk_size *= incr;
@@ -72,11 +73,56 @@ gomp_loop_init (struct gomp_work_share *ws, long start, long end, long incr,
 	  ws->mode = 0;
 	else
 	  ws->mode = ws->end > (nthreads + 1) * -ws->chunk_size - LONG_MAX;
+
+	if (gomp_adaptive_chunk_var && nthreads > 1)
+	  {
+	    ws->mode |= 4;
+	    ws->chunk_scale = 1;
+	  }
       }
 #endif
     }
 }
 
+/* Prepare the ordered DYNAMIC or GUIDED loop WS, initialized by
+   gomp_loop_init with CHUNK_SIZE, to hand out its chunks together with
+   their tickets without taking the work share lock, if the number of
+   chunks or iterations fits.  */
+
+static inline void
+gomp_loop_ordered_init (struct gomp_work_share *ws, long chunk_size)
+{
+#ifdef HAVE_SYNC_BUILTINS
+  struct gomp_team *team = gomp_thread ()->ts.team;
+  unsigned long n, d, i;
+
+  if (team == NULL || team->nthreads == 1 || chunk_size <= 0)
+    return;
+
+  /* Compute the number of iterations.  */
+  if (ws->incr > 0)
+    {
+      d = (unsigned long) ws->end - ws->next;
+      i = ws->incr;
+    }
+  else
+    {
+      d = (unsigned long) ws->next - ws->end;
+      i = -(unsigned long) ws->incr;
+    }
+  n = d / i + (d % i != 0);
+
+  if (ws->sched == GFS_DYNAMIC)
+    n = n / chunk_size + (n % chunk_size != 0);
+  else if (n >= 1UL << (sizeof (long) * __CHAR_BIT__ / 2))
+    return;
+
+  ws->mode |= 8;
+  ws->ordered_count = n;
+  ws->ordered_claim = 0;
+#endif
+}
+
 /* The *_start routines are called when first encountering a loop construct
    that is not bound directly to a parallel construct.  The first thread 
    that arrives will create the work-share construct; subsequent threads
@@ -199,9 +245,9 @@ gomp_loop_ordered_static_start (long start, long end, long incr,
     {
       gomp_loop_init (thr->ts.work_share, start, end, incr,
 		      GFS_STATIC, chunk_size);
-      gomp_ordered_static_init ();
       gomp_work_share_init_done ();
     }
+  gomp_ordered_static_init ();
 
   return !gomp_iter_static_next (istart, iend);
 }
@@ -217,12 +263,23 @@ gomp_loop_ordered_dynamic_start (long start, long end, long incr,
     {
       gomp_loop_init (thr->ts.work_share, start, end, incr,
 		      GFS_DYNAMIC, chunk_size);
-      gomp_mutex_lock (&thr->ts.work_share->lock);
+      gomp_loop_ordered_init (thr->ts.work_share, chunk_size);
       gomp_work_share_init_done ();
     }
-  else
-    gomp_mutex_lock (&thr->ts.work_share->lock);
 
+#ifdef HAVE_SYNC_BUILTINS
+  if (thr->ts.work_share->mode & 8)
+    {
+      unsigned ticket;
+
+      ret = gomp_iter_ordered_dynamic_next (istart, iend, &ticket);
+      if (ret)
+	gomp_ordered_first_ticket (ticket);
+      return ret;
+    }
+#endif
+
+  gomp_mutex_lock (&thr->ts.work_share->lock);
   ret = gomp_iter_dynamic_next_locked (istart, iend);
   if (ret)
     gomp_ordered_first ();
@@ -242,12 +299,23 @@ gomp_loop_ordered_guided_start (long start, long end, long incr,
     {
       gomp_loop_init (thr->ts.work_share, start, end, incr,
 		      GFS_GUIDED, chunk_size);
-      gomp_mutex_lock (&thr->ts.work_share->lock);
+      gomp_loop_ordered_init (thr->ts.work_share, chunk_size);
       gomp_work_share_init_done ();
     }
-  else
-    gomp_mutex_lock (&thr->ts.work_share->lock);
 
+#ifdef HAVE_SYNC_BUILTINS
+  if (thr->ts.work_share->mode & 8)
+    {
+      unsigned ticket;
+
+      ret = gomp_iter_ordered_guided_next (istart, iend, &ticket);
+      if (ret)
+	gomp_ordered_first_ticket (ticket);
+      return ret;
+    }
+#endif
+
+  gomp_mutex_lock (&thr->ts.work_share->lock);
   ret = gomp_iter_guided_next_locked (istart, iend);
   if (ret)
     gomp_ordered_first ();
@@ -364,15 +432,12 @@ GOMP_loop_runtime_next (long *istart, long *iend)
 static bool
 gomp_loop_ordered_static_next (long *istart, long *iend)
 {
-  struct gomp_thread *thr = gomp_thread ();
   int test;
 
   gomp_ordered_sync ();
-  gomp_mutex_lock (&thr->ts.work_share->lock);
   test = gomp_iter_static_next (istart, iend);
   if (test >= 0)
     gomp_ordered_static_next ();
-  gomp_mutex_unlock (&thr->ts.work_share->lock);
 
   return test == 0;
 }
@@ -384,6 +449,21 @@ gomp_loop_ordered_dynamic_next (long *istart, long *iend)
   bool ret;
 
   gomp_ordered_sync ();
+
+#ifdef HAVE_SYNC_BUILTINS
+  if (thr->ts.work_share->mode & 8)
+    {
+      unsigned ticket;
+
+      ret = gomp_iter_ordered_dynamic_next (istart, iend, &ticket);
+      if (ret)
+	gomp_ordered_next_ticket (ticket);
+      else
+	gomp_ordered_last ();
+      return ret;
+    }
+#endif
+
   gomp_mutex_lock (&thr->ts.work_share->lock);
   ret = gomp_iter_dynamic_next_locked (istart, iend);
   if (ret)
@@ -402,6 +482,21 @@ gomp_loop_ordered_guided_next (long *istart, long *iend)
   bool ret;
 
   gomp_ordered_sync ();
+
+#ifdef HAVE_SYNC_BUILTINS
+  if (thr->ts.work_share->mode & 8)
+    {
+      unsigned ticket;
+
+      ret = gomp_iter_ordered_guided_next (istart, iend, &ticket);
+      if (ret)
+	gomp_ordered_next_ticket (ticket);
+      else
+	gomp_ordered_last ();
+      return ret;
+    }
+#endif
+
   gomp_mutex_lock (&thr->ts.work_share->lock);
   ret = gomp_iter_guided_next_locked (istart, iend);
   if (ret)
@@ -49,7 +49,7 @@ gomp_loop_ull_init (struct gomp_work_share *ws, bool up, gomp_ull start,
     {
       ws->chunk_size_ull *= incr;
 
-#if defined HAVE_SYNC_BUILTINS && defined __LP64__
+#ifdef HAVE_SYNC_BUILTINS_ULL
       {
 	/* For dynamic scheduling prepare things to make each iteration
 	   faster.  */
@@ -72,6 +72,12 @@ gomp_loop_ull_init (struct gomp_work_share *ws, bool up, gomp_ull start,
 					      * __CHAR_BIT__ / 2 - 1), 1))
 	  ws->mode = ws->end_ull > ((nthreads + 1) * -ws->chunk_size_ull
 				    - (__LONG_LONG_MAX__ * 2ULL + 1));
+
+	if (gomp_adaptive_chunk_var && nthreads > 1)
+	  {
+	    ws->mode |= 4;
+	    ws->chunk_scale = 1;
+	  }
       }
 #endif
     }
@@ -79,6 +85,48 @@ gomp_loop_ull_init (struct gomp_work_share *ws, bool up, gomp_ull start,
     ws->mode |= 2;
 }
 
+/* Prepare the ordered DYNAMIC or GUIDED loop WS, see
+   gomp_loop_ordered_init.  */
+
+static inline void
+gomp_loop_ull_ordered_init (struct gomp_work_share *ws, gomp_ull chunk_size)
+{
+#ifdef HAVE_SYNC_BUILTINS_ULL
+  struct gomp_team *team = gomp_thread ()->ts.team;
+  gomp_ull n, d, i;
+
+  if (team == NULL || team->nthreads == 1 || chunk_size == 0)
+    return;
+
+  /* Compute the number of iterations.  */
+  if (__builtin_expect (ws->mode & 2, 0) == 0)
+    {
+      d = ws->end_ull - ws->next_ull;
+      i = ws->incr_ull;
+    }
+  else
+    {
+      d = ws->next_ull - ws->end_ull;
+      i = -ws->incr_ull;
+    }
+  n = d / i + (d % i != 0);
+
+  if (ws->sched == GFS_DYNAMIC)
+    {
+      n = n / chunk_size + (n % chunk_size != 0);
+      /* Threads past the last chunk still increment the counter.  */
+      if (n > __LONG_LONG_MAX__ * 2ULL + 1 - team->nthreads)
+	return;
+    }
+  else if (n >= 1ULL << (sizeof (gomp_ull) * __CHAR_BIT__ / 2))
+    return;
+
+  ws->mode |= 8;
+  ws->ordered_count_ull = n;
+  ws->ordered_claim_ull = 0;
+#endif
+}
+
 /* The *_start routines are called when first encountering a loop construct
    that is not bound directly to a parallel construct.  The first thread
    that arrives will create the work-share construct; subsequent threads
@@ -128,7 +176,7 @@ gomp_loop_ull_dynamic_start (bool up, gomp_ull start, gomp_ull end,
       gomp_work_share_init_done ();
     }
 
-#if defined HAVE_SYNC_BUILTINS && defined __LP64__
+#ifdef HAVE_SYNC_BUILTINS_ULL
   ret = gomp_iter_ull_dynamic_next (istart, iend);
 #else
   gomp_mutex_lock (&thr->ts.work_share->lock);
@@ -154,7 +202,7 @@ gomp_loop_ull_guided_start (bool up, gomp_ull start, gomp_ull end,
       gomp_work_share_init_done ();
     }
 
-#if defined HAVE_SYNC_BUILTINS && defined __LP64__
+#ifdef HAVE_SYNC_BUILTINS_ULL
   ret = gomp_iter_ull_guided_next (istart, iend);
 #else
   gomp_mutex_lock (&thr->ts.work_share->lock);
@@ -209,9 +257,9 @@ gomp_loop_ull_ordered_static_start (bool up, gomp_ull start, gomp_ull end,
     {
       gomp_loop_ull_init (thr->ts.work_share, up, start, end, incr,
 			  GFS_STATIC, chunk_size);
-      gomp_ordered_static_init ();
       gomp_work_share_init_done ();
     }
+  gomp_ordered_static_init ();
 
   return !gomp_iter_ull_static_next (istart, iend);
 }
@@ -228,12 +276,23 @@ gomp_loop_ull_ordered_dynamic_start (bool up, gomp_ull start, gomp_ull end,
     {
       gomp_loop_ull_init (thr->ts.work_share, up, start, end, incr,
 			  GFS_DYNAMIC, chunk_size);
-      gomp_mutex_lock (&thr->ts.work_share->lock);
+      gomp_loop_ull_ordered_init (thr->ts.work_share, chunk_size);
       gomp_work_share_init_done ();
     }
-  else
-    gomp_mutex_lock (&thr->ts.work_share->lock);
 
+#ifdef HAVE_SYNC_BUILTINS_ULL
+  if (thr->ts.work_share->mode & 8)
+    {
+      unsigned ticket;
+
+      ret = gomp_iter_ull_ordered_dynamic_next (istart, iend, &ticket);
+      if (ret)
+	gomp_ordered_first_ticket (ticket);
+      return ret;
+    }
+#endif
+
+  gomp_mutex_lock (&thr->ts.work_share->lock);
   ret = gomp_iter_ull_dynamic_next_locked (istart, iend);
   if (ret)
     gomp_ordered_first ();
@@ -254,12 +313,23 @@ gomp_loop_ull_ordered_guided_start (bool up, gomp_ull start, gomp_ull end,
     {
       gomp_loop_ull_init (thr->ts.work_share, up, start, end, incr,
 			  GFS_GUIDED, chunk_size);
-      gomp_mutex_lock (&thr->ts.work_share->lock);
+      gomp_loop_ull_ordered_init (thr->ts.work_share, chunk_size);
       gomp_work_share_init_done ();
     }
-  else
-    gomp_mutex_lock (&thr->ts.work_share->lock);
 
+#ifdef HAVE_SYNC_BUILTINS_ULL
+  if (thr->ts.work_share->mode & 8)
+    {
+      unsigned ticket;
+
+      ret = gomp_iter_ull_ordered_guided_next (istart, iend, &ticket);
+      if (ret)
+	gomp_ordered_first_ticket (ticket);
+      return ret;
+    }
+#endif
+
+  gomp_mutex_lock (&thr->ts.work_share->lock);
   ret = gomp_iter_ull_guided_next_locked (istart, iend);
   if (ret)
     gomp_ordered_first ();
@@ -319,7 +389,7 @@ gomp_loop_ull_dynamic_next (gomp_ull *istart, gomp_ull *iend)
 {
   bool ret;
 
-#if defined HAVE_SYNC_BUILTINS && defined __LP64__
+#ifdef HAVE_SYNC_BUILTINS_ULL
   ret = gomp_iter_ull_dynamic_next (istart, iend);
 #else
   struct gomp_thread *thr = gomp_thread ();
@@ -336,7 +406,7 @@ gomp_loop_ull_guided_next (gomp_ull *istart, gomp_ull *iend)
 {
   bool ret;
 
-#if defined HAVE_SYNC_BUILTINS && defined __LP64__
+#ifdef HAVE_SYNC_BUILTINS_ULL
   ret = gomp_iter_ull_guided_next (istart, iend);
 #else
   struct gomp_thread *thr = gomp_thread ();
@@ -377,15 +447,12 @@ GOMP_loop_ull_runtime_next (gomp_ull *istart, gomp_ull *iend)
 static bool
 gomp_loop_ull_ordered_static_next (gomp_ull *istart, gomp_ull *iend)
 {
-  struct gomp_thread *thr = gomp_thread ();
   int test;
 
   gomp_ordered_sync ();
-  gomp_mutex_lock (&thr->ts.work_share->lock);
   test = gomp_iter_ull_static_next (istart, iend);
   if (test >= 0)
     gomp_ordered_static_next ();
-  gomp_mutex_unlock (&thr->ts.work_share->lock);
 
   return test == 0;
 }
@@ -397,6 +464,21 @@ gomp_loop_ull_ordered_dynamic_next (gomp_ull *istart, gomp_ull *iend)
   bool ret;
 
   gomp_ordered_sync ();
+
+#ifdef HAVE_SYNC_BUILTINS_ULL
+  if (thr->ts.work_share->mode & 8)
+    {
+      unsigned ticket;
+
+      ret = gomp_iter_ull_ordered_dynamic_next (istart, iend, &ticket);
+      if (ret)
+	gomp_ordered_next_ticket (ticket);
+      else
+	gomp_ordered_last ();
+      return ret;
+    }
+#endif
+
   gomp_mutex_lock (&thr->ts.work_share->lock);
   ret = gomp_iter_ull_dynamic_next_locked (istart, iend);
   if (ret)
@@ -415,6 +497,21 @@ gomp_loop_ull_ordered_guided_next (gomp_ull *istart, gomp_ull *iend)
   bool ret;
 
   gomp_ordered_sync ();
+
+#ifdef HAVE_SYNC_BUILTINS_ULL
+  if (thr->ts.work_share->mode & 8)
+    {
+      unsigned ticket;
+
+      ret = gomp_iter_ull_ordered_guided_next (istart, iend, &ticket);
+      if (ret)
+	gomp_ordered_next_ticket (ticket);
+      else
+	gomp_ordered_last ();
+      return ret;
+    }
+#endif
+
   gomp_mutex_lock (&thr->ts.work_share->lock);
   ret = gomp_iter_ull_guided_next_locked (istart, iend);
   if (ret)
@@ -27,9 +27,18 @@
 #include "libgomp.h"
 
 
+/* Hand the ordered region over to the holder of ticket TICKET of work
+   share WS, which may not have been given out yet.  */
+
+static inline void
+gomp_ordered_grant (struct gomp_work_share *ws, unsigned ticket)
+{
+  gomp_ticket_grant (&ws->ordered_slots[ticket & ws->ordered_mask], ticket);
+}
+
 /* This function is called when first allocating an iteration block.  That
-   is, the thread is not currently on the queue.  The work-share lock must
-   be held on entry.  */
+   is, the thread holds no ticket yet.  The work-share lock must be held
+   on entry, so that tickets are given out in the order of the blocks.  */
 
 void
 gomp_ordered_first (void)
@@ -37,30 +46,34 @@ gomp_ordered_first (void)
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
   struct gomp_work_share *ws = thr->ts.work_share;
-  unsigned index;
 
   /* Work share constructs can be orphaned.  */
   if (team == NULL || team->nthreads == 1)
     return;
 
-  index = ws->ordered_cur + ws->ordered_num_used;
-  if (index >= team->nthreads)
-    index -= team->nthreads;
-  ws->ordered_team_ids[index] = thr->ts.team_id;
+  thr->ts.ordered_ticket = ws->ordered_next_ticket++;
+}
+
+/* Likewise, but for a block claimed together with its TICKET, without
+   the work-share lock.  */
 
-  /* If this is the first and only thread in the queue, then there is
-     no one to release us when we get to our ordered section.  Post to
-     our own release queue now so that we won't block later.  */
-  if (ws->ordered_num_used++ == 0)
-    gomp_sem_post (team->ordered_release[thr->ts.team_id]);
+void
+gomp_ordered_first_ticket (unsigned ticket)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_team *team = thr->ts.team;
+
+  if (team == NULL || team->nthreads == 1)
+    return;
+
+  thr->ts.ordered_ticket = ticket;
 }
 
 /* This function is called when completing the last iteration block.  That
-   is, there are no more iterations to perform and so the thread should be
-   removed from the queue entirely.  Because of the way ORDERED blocks are
-   managed, it follows that we currently own access to the ORDERED block,
-   and should now pass it on to the next thread.  The work-share lock must
-   be held on entry.  */
+   is, there are no more iterations to perform.  Because of the way ORDERED
+   blocks are managed, it follows that we currently own access to the
+   ORDERED block, and should now pass it on to the holder of the next
+   ticket.  The work-share lock need not be held.  */
 
 void
 gomp_ordered_last (void)
@@ -68,26 +81,12 @@ gomp_ordered_last (void)
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
   struct gomp_work_share *ws = thr->ts.work_share;
-  unsigned next_id;
 
   /* Work share constructs can be orphaned.  */
   if (team == NULL || team->nthreads == 1)
     return;
 
-  /* We're no longer the owner.  */
-  ws->ordered_owner = -1;
-
-  /* If we're not the last thread in the queue, then wake the next.  */
-  if (--ws->ordered_num_used > 0)
-    {
-      unsigned next = ws->ordered_cur + 1;
-      if (next == team->nthreads)
-	next = 0;
-      ws->ordered_cur = next;
-
-      next_id = ws->ordered_team_ids[next];
-      gomp_sem_post (team->ordered_release[next_id]);
-    }
+  gomp_ordered_grant (ws, thr->ts.ordered_ticket + 1);
 }
 
 
@@ -103,47 +102,40 @@ gomp_ordered_next (void)
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
   struct gomp_work_share *ws = thr->ts.work_share;
-  unsigned index, next_id;
 
   /* Work share constructs can be orphaned.  */
   if (team == NULL || team->nthreads == 1)
     return;
 
-  /* We're no longer the owner.  */
-  ws->ordered_owner = -1;
-
-  /* If there's only one thread in the queue, that must be us.  */
-  if (ws->ordered_num_used == 1)
-    {
-      /* We have a similar situation as in gomp_ordered_first
-	 where we need to post to our own release semaphore.  */
-      gomp_sem_post (team->ordered_release[thr->ts.team_id]);
-      return;
-    }
-
-  /* If the queue is entirely full, then we move ourself to the end of 
-     the queue merely by incrementing ordered_cur.  Only if it's not 
-     full do we have to write our id.  */
-  if (ws->ordered_num_used < team->nthreads)
-    {
-      index = ws->ordered_cur + ws->ordered_num_used;
-      if (index >= team->nthreads)
-	index -= team->nthreads;
-      ws->ordered_team_ids[index] = thr->ts.team_id;
-    }
-
-  index = ws->ordered_cur + 1;
-  if (index == team->nthreads)
-    index = 0;
-  ws->ordered_cur = index;
-
-  next_id = ws->ordered_team_ids[index];
-  gomp_sem_post (team->ordered_release[next_id]);
+  /* If no other thread took a block since ours, we get the ticket we
+     grant here and won't block later.  */
+  gomp_ordered_grant (ws, thr->ts.ordered_ticket + 1);
+  thr->ts.ordered_ticket = ws->ordered_next_ticket++;
+}
+
+/* Likewise, but for a block claimed together with its TICKET, without
+   the work-share lock.  */
+
+void
+gomp_ordered_next_ticket (unsigned ticket)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_team *team = thr->ts.team;
+  struct gomp_work_share *ws = thr->ts.work_share;
+
+  if (team == NULL || team->nthreads == 1)
+    return;
+
+  gomp_ordered_grant (ws, thr->ts.ordered_ticket + 1);
+  thr->ts.ordered_ticket = ticket;
 }
 
 
-/* This function is called when a statically scheduled loop is first
-   being created.  */
+/* This function is called by each thread when a statically scheduled
+   loop is first being created.  Static schedules are not first come
+   first served like the others, the blocks are handed out round robin,
+   so the N-th block of the thread with team_id I has ticket
+   N * nthreads + I.  */
 
 void
 gomp_ordered_static_init (void)
@@ -154,14 +146,12 @@ gomp_ordered_static_init (void)
   if (team == NULL || team->nthreads == 1)
     return;
 
-  gomp_sem_post (team->ordered_release[0]);
+  thr->ts.ordered_ticket = thr->ts.team_id;
 }
 
 /* This function is called when a statically scheduled loop is moving to
-   the next allocation block.  Static schedules are not first come first
-   served like the others, so we're to move to the numerically next thread,
-   not the next thread on a list.  The work-share lock should *not* be held
-   on entry.  */
+   the next allocation block.  The next ticket belongs to the numerically
+   next thread.  The work-share lock should *not* be held on entry.  */
 
 void
 gomp_ordered_static_next (void)
@@ -169,23 +159,20 @@ gomp_ordered_static_next (void)
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
   struct gomp_work_share *ws = thr->ts.work_share;
-  unsigned id = thr->ts.team_id;
 
   if (team == NULL || team->nthreads == 1)
     return;
 
-  ws->ordered_owner = -1;
-
-  /* This thread currently owns the lock.  Increment the owner.  */
-  if (++id == team->nthreads)
-    id = 0;
-  ws->ordered_team_ids[0] = id;
-  gomp_sem_post (team->ordered_release[id]);
+  /* This thread currently owns the ordered section.  */
+  gomp_ordered_grant (ws, thr->ts.ordered_ticket + 1);
+  thr->ts.ordered_ticket += team->nthreads;
 }
 
 /* This function is called when we need to assert that the thread owns the
-   ordered section.  Due to the problem of posted-but-not-waited semaphores,
-   this needs to happen before completing a loop iteration.  */
+   ordered section, that is, that its ticket has been granted.  Waiting
+   for a granted ticket returns at once, so this can be done any number
+   of times for the same block, and it needs no lock, as no one but this
+   thread can move its slot past its ticket.  */
 
 void
 gomp_ordered_sync (void)
@@ -193,32 +180,20 @@ gomp_ordered_sync (void)
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
   struct gomp_work_share *ws = thr->ts.work_share;
+  unsigned ticket;
 
   /* Work share constructs can be orphaned.  But this clearly means that
      we are the only thread, and so we automatically own the section.  */
   if (team == NULL || team->nthreads == 1)
     return;
 
-  /* ??? I believe it to be safe to access this data without taking the
-     ws->lock.  The only presumed race condition is with the previous
-     thread on the queue incrementing ordered_cur such that it points
-     to us, concurrently with our check below.  But our team_id is
-     already present in the queue, and the other thread will always
-     post to our release semaphore.  So the two cases are that we will
-     either win the race an momentarily block on the semaphore, or lose
-     the race and find the semaphore already unlocked and so not block.
-     Either way we get correct results.  */
-
-  if (ws->ordered_owner != thr->ts.team_id)
-    {
-      gomp_sem_wait (team->ordered_release[thr->ts.team_id]);
-      ws->ordered_owner = thr->ts.team_id;
-    }
+  ticket = thr->ts.ordered_ticket;
+  gomp_ticket_wait (&ws->ordered_slots[ticket & ws->ordered_mask], ticket);
 }
 
 /* This function is called by user code when encountering the start of an
-   ORDERED block.  We must check to see if the current thread is at the
-   head of the queue, and if not, block.  */
+   ORDERED block.  We must check to see if the ticket of the current
+   thread has been granted, and if not, block.  */
 
 #ifdef HAVE_ATTRIBUTE_ALIAS
 extern void GOMP_ordered_start (void)
@@ -37,6 +37,18 @@ gomp_sections_init (struct gomp_work_share *ws, unsigned count)
   ws->end = count + 1;
   ws->incr = 1;
   ws->next = 1;
+#ifdef HAVE_SYNC_BUILTINS
+  {
+    /* Prepare things to make each section claim use fetch-and-add.  */
+    struct gomp_team *team = gomp_thread ()->ts.team;
+    long nthreads = team ? team->nthreads : 1;
+
+    ws->mode = ((nthreads | ws->end)
+		< 1UL << (sizeof (long) * __CHAR_BIT__ / 2 - 1));
+  }
+#else
+  ws->mode = 0;
+#endif
 }
 
 /* This routine is called when first encountering a sections construct
@@ -29,6 +29,19 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* Explicit tasks whose argument block fits into this many bytes get a
+   descriptor of a fixed size, which is recycled through per-thread free
+   lists of at most GOMP_TASK_CACHE_MAX entries.  */
+#define GOMP_TASK_CACHE_ARG_SIZE 128
+#define GOMP_TASK_CACHE_MAX 256
+
+/* New tasks are run immediately rather than queued if the team has more
+   than GOMP_TASK_QUEUE_CUTOFF queued tasks per thread, or if they are
+   nested at least GOMP_TASK_DEPTH_CUTOFF explicit tasks deep while the
+   creating thread still has two or more tasks of its own queued.  */
+#define GOMP_TASK_QUEUE_CUTOFF 16
+#define GOMP_TASK_DEPTH_CUTOFF 8
+
 
 /* Create a new task data structure.  */
 
@@ -39,9 +52,10 @@ gomp_init_task (struct gomp_task *task, struct gomp_task *parent_task,
   task->parent = parent_task;
   task->icv = *prev_icv;
   task->kind = GOMP_TASK_IMPLICIT;
-  task->in_taskwait = false;
   task->in_tied_task = false;
-  task->children = NULL;
+  task->refs = 1;
+  task->depth = 0;
+  task->deque_mark = 0;
   gomp_sem_init (&task->taskwait_sem, 0);
 }
 
@@ -57,18 +71,327 @@ gomp_end_task (void)
   thr->task = task->parent;
 }
 
+/* Allocate a descriptor for an explicit task of a team with room for
+   an argument block of SIZE bytes, taking it from the free list of THR
+   if it is small enough.  */
+
+static inline struct gomp_task *
+gomp_task_alloc (struct gomp_thread *thr, long size)
+{
+  struct gomp_task *task;
+
+  if (__builtin_expect (size > GOMP_TASK_CACHE_ARG_SIZE, 0))
+    {
+      task = gomp_malloc (sizeof (*task) + size);
+      task->cached = false;
+      return task;
+    }
+
+  task = thr->task_cache;
+  if (task != NULL)
+    {
+      thr->task_cache = task->parent;
+      thr->task_cache_count--;
+    }
+  else
+    {
+      task = gomp_malloc (sizeof (*task) + GOMP_TASK_CACHE_ARG_SIZE);
+      task->cached = true;
+    }
+  return task;
+}
+
+/* Release the descriptor of a completed explicit task, keeping it in
+   the free list of the current thread if it is of the cached size.  */
+
+static void
+gomp_task_free (struct gomp_task *task)
+{
+  struct gomp_thread *thr;
+
+  gomp_finish_task (task);
+  if (task->cached)
+    {
+      thr = gomp_thread ();
+      if (thr->task_cache_count < GOMP_TASK_CACHE_MAX)
+	{
+	  task->parent = thr->task_cache;
+	  thr->task_cache = task;
+	  thr->task_cache_count++;
+	  return;
+	}
+    }
+  free (task);
+}
+
+/* Free the task descriptors cached by THR, which is exiting.  */
+
+void
+gomp_free_task_cache (struct gomp_thread *thr)
+{
+  struct gomp_task *task;
+
+  while ((task = thr->task_cache) != NULL)
+    {
+      thr->task_cache = task->parent;
+      free (task);
+    }
+  thr->task_cache_count = 0;
+}
+
+/* Atomically add VAL to one of the task counters of TEAM and return
+   the new value.  Without sync builtins the counters are protected by
+   the team's task_lock, which must not be held by the caller.  */
+
+static inline int
+gomp_task_count_add (struct gomp_team *team, int *count, int val)
+{
+#ifdef HAVE_SYNC_BUILTINS
+  return __sync_add_and_fetch (count, val);
+#else
+  int ret;
+
+  gomp_mutex_lock (&team->task_lock);
+  ret = *count += val;
+  gomp_mutex_unlock (&team->task_lock);
+  return ret;
+#endif
+}
+
+/* Take a reference to TASK on behalf of a newly deferred child.  */
+
 static inline void
-gomp_clear_parent (struct gomp_task *children)
+gomp_task_ref (struct gomp_team *team, struct gomp_task *task)
 {
-  struct gomp_task *task = children;
+#ifdef HAVE_SYNC_BUILTINS
+  __sync_fetch_and_add (&task->refs, 1);
+#else
+  gomp_mutex_lock (&team->task_lock);
+  task->refs++;
+  gomp_mutex_unlock (&team->task_lock);
+#endif
+}
 
-  if (task)
-    do
-      {
-	task->parent = NULL;
-	task = task->next_child;
-      }
-    while (task != children);
+/* Drop a reference to TASK, either because one of its children has
+   completed or because its own body has finished.  Wake it up if it
+   is sleeping in GOMP_taskwait for its last child, and free it if
+   nothing refers to it any longer.  */
+
+static void
+gomp_task_unref (struct gomp_team *team, struct gomp_task *task)
+{
+  unsigned old;
+
+#ifdef HAVE_SYNC_BUILTINS
+  old = __sync_fetch_and_add (&task->refs, -1);
+#else
+  gomp_mutex_lock (&team->task_lock);
+  old = task->refs--;
+  gomp_mutex_unlock (&team->task_lock);
+#endif
+  if (__builtin_expect (old == (GOMP_TASK_REFS_WAITING | 2), 0))
+    gomp_sem_post (&task->taskwait_sem);
+  else if (old == 1 && task->kind != GOMP_TASK_IMPLICIT)
+    gomp_task_free (task);
+}
+
+/* Mark TASK as sleeping in GOMP_taskwait.  Returns false if all of its
+   children have completed in the meantime, so there is nothing to
+   wait for.  */
+
+static bool
+gomp_task_set_waiting (struct gomp_team *team, struct gomp_task *task)
+{
+#ifdef HAVE_SYNC_BUILTINS
+  unsigned refs;
+
+  do
+    {
+      refs = task->refs;
+      if (refs == 1)
+	return false;
+    }
+  while (!__sync_bool_compare_and_swap (&task->refs, refs,
+					refs | GOMP_TASK_REFS_WAITING));
+  return true;
+#else
+  bool ret;
+
+  gomp_mutex_lock (&team->task_lock);
+  ret = task->refs != 1;
+  if (ret)
+    task->refs |= GOMP_TASK_REFS_WAITING;
+  gomp_mutex_unlock (&team->task_lock);
+  return ret;
+#endif
+}
+
+static inline void
+gomp_task_clear_waiting (struct gomp_team *team, struct gomp_task *task)
+{
+#ifdef HAVE_SYNC_BUILTINS
+  __sync_fetch_and_and (&task->refs, ~GOMP_TASK_REFS_WAITING);
+#else
+  gomp_mutex_lock (&team->task_lock);
+  task->refs &= ~GOMP_TASK_REFS_WAITING;
+  gomp_mutex_unlock (&team->task_lock);
+#endif
+}
+
+/* Make the task pending bit of the team barrier agree with whether any
+   tasks are queued.  This is called by whoever moved task_queued_count
+   between zero and non-zero, after the deque has been updated.  */
+
+static void
+gomp_task_update_pending (struct gomp_team *team)
+{
+  gomp_mutex_lock (&team->task_lock);
+  if (team->task_queued_count != 0)
+    gomp_team_barrier_set_task_pending (&team->barrier);
+  else
+    gomp_team_barrier_clear_task_pending (&team->barrier);
+  gomp_mutex_unlock (&team->task_lock);
+}
+
+/* Double the size of DEQUE, which must be full and locked.  */
+
+static void
+gomp_task_deque_grow (struct gomp_task_deque *deque)
+{
+  unsigned long size = deque->size ? 2 * deque->size : 64;
+  struct gomp_task **tasks = gomp_malloc (size * sizeof (*tasks));
+  unsigned long i;
+
+  for (i = deque->head; i != deque->tail; i++)
+    tasks[i & (size - 1)] = deque->tasks[i & (deque->size - 1)];
+  free (deque->tasks);
+  deque->tasks = tasks;
+  deque->size = size;
+}
+
+/* Push TASK at the tail of DEQUE.  Only the owner of DEQUE may call
+   this.  */
+
+static void
+gomp_task_deque_push (struct gomp_task_deque *deque, struct gomp_task *task)
+{
+  gomp_mutex_lock (&deque->lock);
+  if (__builtin_expect (deque->tail - deque->head == deque->size, 0))
+    gomp_task_deque_grow (deque);
+  deque->tasks[deque->tail & (deque->size - 1)] = task;
+  deque->tail++;
+  gomp_mutex_unlock (&deque->lock);
+}
+
+/* Pop the most recently pushed task off DEQUE, provided it was pushed
+   at or above index MARK.  Only the owner of DEQUE may call this.  */
+
+static struct gomp_task *
+gomp_task_deque_pop (struct gomp_task_deque *deque, unsigned long mark)
+{
+  struct gomp_task *task = NULL;
+
+  if (deque->tail == deque->head || deque->tail <= mark)
+    return NULL;
+  gomp_mutex_lock (&deque->lock);
+  if (deque->tail != deque->head && deque->tail > mark)
+    {
+      deque->tail--;
+      task = deque->tasks[deque->tail & (deque->size - 1)];
+    }
+  gomp_mutex_unlock (&deque->lock);
+  return task;
+}
+
+/* Steal the oldest task from the head of another thread's DEQUE.  */
+
+static struct gomp_task *
+gomp_task_deque_steal (struct gomp_task_deque *deque)
+{
+  struct gomp_task *task = NULL;
+
+  if (deque->head == deque->tail)
+    return NULL;
+  gomp_mutex_lock (&deque->lock);
+  if (deque->head != deque->tail)
+    {
+      task = deque->tasks[deque->head & (deque->size - 1)];
+      deque->head++;
+    }
+  gomp_mutex_unlock (&deque->lock);
+  return task;
+}
+
+/* Account for a task having been taken off one of the team's deques.  */
+
+static inline void
+gomp_task_dequeued (struct gomp_team *team)
+{
+  if (gomp_task_count_add (team, &team->task_queued_count, -1) == 0)
+    gomp_task_update_pending (team);
+}
+
+/* Find a queued task for the current thread to run, preferring the
+   newest task on its own deque and otherwise stealing the oldest task
+   from the other team members, starting with the next one.  */
+
+static struct gomp_task *
+gomp_task_take (struct gomp_thread *thr, struct gomp_team *team)
+{
+  unsigned id = thr->ts.team_id, nthreads = team->nthreads, i;
+  struct gomp_task *task;
+
+  task = gomp_task_deque_pop (&team->task_deques[id], 0);
+  for (i = 1; task == NULL && i < nthreads; i++)
+    {
+      if (team->task_queued_count == 0)
+	return NULL;
+      task = gomp_task_deque_steal (&team->task_deques[(id + i) % nthreads]);
+    }
+  if (task != NULL)
+    gomp_task_dequeued (team);
+  return task;
+}
+
+/* Run CHILD_TASK, which has just been taken off a deque, in the current
+   thread.  Returns true if it was the last outstanding task of TEAM.  */
+
+static bool
+gomp_task_run (struct gomp_thread *thr, struct gomp_team *team,
+	       struct gomp_task *child_task)
+{
+  struct gomp_task *task = thr->task;
+  struct gomp_task *parent = child_task->parent;
+
+  child_task->kind = GOMP_TASK_TIED;
+  child_task->deque_mark = team->task_deques[thr->ts.team_id].tail;
+  gomp_task_count_add (team, &team->task_running_count, 1);
+  thr->task = child_task;
+  gomp_trace (GOMP_TRACE_TASK_BEGIN, 1, (uintptr_t) child_task);
+  child_task->fn (child_task->fn_data);
+  gomp_trace (GOMP_TRACE_TASK_END, 1, (uintptr_t) child_task);
+  thr->task = task;
+  gomp_task_count_add (team, &team->task_running_count, -1);
+  gomp_task_unref (team, parent);
+  gomp_task_unref (team, child_task);
+  return gomp_task_count_add (team, &team->task_count, -1) == 0;
+}
+
+/* Return true if a task the current thread is about to create should
+   be run immediately, because there is enough parallel slack already
+   that queueing it would cost more than it could gain.  */
+
+static inline bool
+gomp_task_cutoff (struct gomp_thread *thr, struct gomp_team *team)
+{
+  struct gomp_task_deque *deque;
+
+  if (team->task_queued_count > GOMP_TASK_QUEUE_CUTOFF * team->nthreads)
+    return true;
+  if (thr->task->depth + 1 < GOMP_TASK_DEPTH_CUTOFF)
+    return false;
+  deque = &team->task_deques[thr->ts.team_id];
+  return deque->tail - deque->head >= 2;
 }
 
 /* Called when encountering an explicit task directive.  If IF_CLAUSE is
@@ -95,15 +418,28 @@ GOMP_task (void (*fn) (void *), void *data, void (*cpyfn) (void *, void *),
 #endif
 
   if (!if_clause || team == NULL
-      || team->task_count > 64 * team->nthreads)
+      || team->task_count > 64 * team->nthreads
+      || gomp_task_cutoff (thr, team))
     {
-      struct gomp_task task;
+      struct gomp_task local_task, *task = &local_task;
+      struct gomp_task *parent = thr->task;
 
-      gomp_init_task (&task, thr->task, gomp_icv (false));
-      task.kind = GOMP_TASK_IFFALSE;
-      if (thr->task)
-	task.in_tied_task = thr->task->in_tied_task;
-      thr->task = &task;
+      /* Inside of a team the task may create deferred children which
+	 outlive it, so it can't be allocated on the stack there.  */
+      if (team != NULL)
+	task = gomp_task_alloc (thr, 0);
+      gomp_init_task (task, parent, gomp_icv (false));
+      task->kind = GOMP_TASK_IFFALSE;
+      if (parent)
+	{
+	  task->in_tied_task = parent->in_tied_task;
+	  task->depth = parent->depth + 1;
+	}
+      if (team != NULL)
+	task->deque_mark = team->task_deques[thr->ts.team_id].tail;
+      thr->task = task;
+      gomp_trace (GOMP_TRACE_TASK_CREATE, 0, (uintptr_t) task);
+      gomp_trace (GOMP_TRACE_TASK_BEGIN, 0, (uintptr_t) task);
       if (__builtin_expect (cpyfn != NULL, 0))
 	{
 	  char buf[arg_size + arg_align - 1];
@@ -114,27 +450,28 @@ GOMP_task (void (*fn) (void *), void *data, void (*cpyfn) (void *, void *),
 	}
       else
 	fn (data);
-      if (task.children)
-	{
-	  gomp_mutex_lock (&team->task_lock);
-	  gomp_clear_parent (task.children);
-	  gomp_mutex_unlock (&team->task_lock);
-	}
-      gomp_end_task ();
+      gomp_trace (GOMP_TRACE_TASK_END, 0, (uintptr_t) task);
+      thr->task = parent;
+      if (team != NULL)
+	gomp_task_unref (team, task);
+      else
+	gomp_finish_task (task);
     }
   else
     {
       struct gomp_task *task;
       struct gomp_task *parent = thr->task;
       char *arg;
+      int queued;
       bool do_wake;
 
-      task = gomp_malloc (sizeof (*task) + arg_size + arg_align - 1);
+      task = gomp_task_alloc (thr, arg_size + arg_align - 1);
       arg = (char *) (((uintptr_t) (task + 1) + arg_align - 1)
 		      & ~(uintptr_t) (arg_align - 1));
       gomp_init_task (task, parent, gomp_icv (false));
       task->kind = GOMP_TASK_IFFALSE;
       task->in_tied_task = parent->in_tied_task;
+      task->depth = parent->depth + 1;
       thr->task = task;
       if (cpyfn)
 	cpyfn (arg, data);
@@ -145,55 +482,37 @@ GOMP_task (void (*fn) (void *), void *data, void (*cpyfn) (void *, void *),
       task->fn = fn;
       task->fn_data = arg;
       task->in_tied_task = true;
-      gomp_mutex_lock (&team->task_lock);
-      if (parent->children)
-	{
-	  task->next_child = parent->children;
-	  task->prev_child = parent->children->prev_child;
-	  task->next_child->prev_child = task;
-	  task->prev_child->next_child = task;
-	}
-      else
-	{
-	  task->next_child = task;
-	  task->prev_child = task;
-	}
-      parent->children = task;
-      if (team->task_queue)
-	{
-	  task->next_queue = team->task_queue;
-	  task->prev_queue = team->task_queue->prev_queue;
-	  task->next_queue->prev_queue = task;
-	  task->prev_queue->next_queue = task;
-	}
-      else
-	{
-	  task->next_queue = task;
-	  task->prev_queue = task;
-	  team->task_queue = task;
-	}
-      ++team->task_count;
-      gomp_team_barrier_set_task_pending (&team->barrier);
+      gomp_task_ref (team, parent);
+      gomp_task_count_add (team, &team->task_count, 1);
+      gomp_trace (GOMP_TRACE_TASK_CREATE, 1, (uintptr_t) task);
+      /* Count the task as queued before it becomes visible to thieves,
+	 so that task_queued_count never drops below zero.  */
+      queued = gomp_task_count_add (team, &team->task_queued_count, 1);
+      gomp_task_deque_push (&team->task_deques[thr->ts.team_id], task);
+      if (queued == 1)
+	gomp_task_update_pending (team);
       do_wake = team->task_running_count + !parent->in_tied_task
 		< team->nthreads;
-      gomp_mutex_unlock (&team->task_lock);
       if (do_wake)
 	gomp_team_barrier_wake (&team->barrier, 1);
     }
 }
 
+/* Called by threads waiting on the team barrier while there are pending
+   tasks.  Run queued tasks until there are none left to take.  The last
+   thread to arrive at the barrier flags it as waiting for tasks, and
+   whoever completes the last task then releases the barrier.  */
+
 void
 gomp_barrier_handle_tasks (gomp_barrier_state_t state)
 {
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
-  struct gomp_task *task = thr->task;
-  struct gomp_task *child_task = NULL;
-  struct gomp_task *to_free = NULL;
+  struct gomp_task *child_task;
 
-  gomp_mutex_lock (&team->task_lock);
   if (gomp_barrier_last_thread (state))
     {
+      gomp_mutex_lock (&team->task_lock);
       if (team->task_count == 0)
 	{
 	  gomp_team_barrier_done (&team->barrier, state);
@@ -202,80 +521,29 @@ gomp_barrier_handle_tasks (gomp_barrier_state_t state)
 	  return;
 	}
       gomp_team_barrier_set_waiting_for_tasks (&team->barrier);
-    }
-
-  while (1)
-    {
-      if (team->task_queue != NULL)
-	{
-	  struct gomp_task *parent;
-
-	  child_task = team->task_queue;
-	  parent = child_task->parent;
-	  if (parent && parent->children == child_task)
-	    parent->children = child_task->next_child;
-	  child_task->prev_queue->next_queue = child_task->next_queue;
-	  child_task->next_queue->prev_queue = child_task->prev_queue;
-	  if (child_task->next_queue != child_task)
-	    team->task_queue = child_task->next_queue;
-	  else
-	    team->task_queue = NULL;
-	  child_task->kind = GOMP_TASK_TIED;
-	  team->task_running_count++;
-	  if (team->task_count == team->task_running_count)
-	    gomp_team_barrier_clear_task_pending (&team->barrier);
-	}
       gomp_mutex_unlock (&team->task_lock);
-      if (to_free)
-	{
-	  gomp_finish_task (to_free);
-	  free (to_free);
-	  to_free = NULL;
-	}
-      if (child_task)
-	{
-	  thr->task = child_task;
-	  child_task->fn (child_task->fn_data);
-	  thr->task = task;
-	}
-      else
-	return;
-      gomp_mutex_lock (&team->task_lock);
-      if (child_task)
-	{
-	  struct gomp_task *parent = child_task->parent;
-	  if (parent)
-	    {
-	      child_task->prev_child->next_child = child_task->next_child;
-	      child_task->next_child->prev_child = child_task->prev_child;
-	      if (parent->children == child_task)
-		{
-		  if (child_task->next_child != child_task)
-		    parent->children = child_task->next_child;
-		  else
-		    {
-		      parent->children = NULL;
-		      if (parent->in_taskwait)
-			gomp_sem_post (&parent->taskwait_sem);
-		    }
-		}
-	    }
-	  gomp_clear_parent (child_task->children);
-	  to_free = child_task;
-	  child_task = NULL;
-	  team->task_running_count--;
-	  if (--team->task_count == 0
-	      && gomp_team_barrier_waiting_for_tasks (&team->barrier))
-	    {
-	      gomp_team_barrier_done (&team->barrier, state);
-	      gomp_mutex_unlock (&team->task_lock);
-	      gomp_team_barrier_wake (&team->barrier, 0);
-	    }
-	}
     }
+
+  while ((child_task = gomp_task_take (thr, team)) != NULL)
+    if (gomp_task_run (thr, team, child_task))
+      {
+	gomp_mutex_lock (&team->task_lock);
+	if (team->task_count == 0
+	    && gomp_team_barrier_waiting_for_tasks (&team->barrier))
+	  {
+	    gomp_team_barrier_done (&team->barrier, state);
+	    gomp_mutex_unlock (&team->task_lock);
+	    gomp_team_barrier_wake (&team->barrier, 0);
+	    return;
+	  }
+	gomp_mutex_unlock (&team->task_lock);
+      }
 }
 
-/* Called when encountering a taskwait directive.  */
+/* Called when encountering a taskwait directive.  Run the children of
+   the current task that are still queued on this thread's own deque,
+   newest first, then sleep until those stolen by other threads have
+   completed.  */
 
 void
 GOMP_taskwait (void)
@@ -283,82 +551,25 @@ GOMP_taskwait (void)
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
   struct gomp_task *task = thr->task;
-  struct gomp_task *child_task = NULL;
-  struct gomp_task *to_free = NULL;
+  struct gomp_task *child_task;
+  struct gomp_task_deque *deque;
 
-  if (task == NULL || task->children == NULL)
+  if (task == NULL || task->refs == 1)
     return;
-  gomp_mutex_lock (&team->task_lock);
-  while (1)
+  deque = &team->task_deques[thr->ts.team_id];
+  while ((child_task = gomp_task_deque_pop (deque, task->deque_mark)) != NULL)
     {
-      if (task->children == NULL)
-	{
-	  gomp_mutex_unlock (&team->task_lock);
-	  if (to_free)
-	    {
-	      gomp_finish_task (to_free);
-	      free (to_free);
-	    }
-	  return;
-	}
-      if (task->children->kind == GOMP_TASK_WAITING)
-	{
-	  child_task = task->children;
-	  task->children = child_task->next_child;
-	  child_task->prev_queue->next_queue = child_task->next_queue;
-	  child_task->next_queue->prev_queue = child_task->prev_queue;
-	  if (team->task_queue == child_task)
-	    {
-	      if (child_task->next_queue != child_task)
-		team->task_queue = child_task->next_queue;
-	      else
-		team->task_queue = NULL;
-	    }
-	  child_task->kind = GOMP_TASK_TIED;
-	  team->task_running_count++;
-	  if (team->task_count == team->task_running_count)
-	    gomp_team_barrier_clear_task_pending (&team->barrier);
-	}
-      else
-	/* All tasks we are waiting for are already running
-	   in other threads.  Wait for them.  */
-	task->in_taskwait = true;
-      gomp_mutex_unlock (&team->task_lock);
-      if (to_free)
-	{
-	  gomp_finish_task (to_free);
-	  free (to_free);
-	  to_free = NULL;
-	}
-      if (child_task)
-	{
-	  thr->task = child_task;
-	  child_task->fn (child_task->fn_data);
-	  thr->task = task;
-	}
-      else
-	{
-	  gomp_sem_wait (&task->taskwait_sem);
-	  task->in_taskwait = false;
-	  return;
-	}
-      gomp_mutex_lock (&team->task_lock);
-      if (child_task)
-	{
-	  child_task->prev_child->next_child = child_task->next_child;
-	  child_task->next_child->prev_child = child_task->prev_child;
-	  if (task->children == child_task)
-	    {
-	      if (child_task->next_child != child_task)
-		task->children = child_task->next_child;
-	      else
-		task->children = NULL;
-	    }
-	  gomp_clear_parent (child_task->children);
-	  to_free = child_task;
-	  child_task = NULL;
-	  team->task_count--;
-	  team->task_running_count--;
-	}
+      gomp_task_dequeued (team);
+      gomp_task_run (thr, team, child_task);
+      if (task->refs == 1)
+	return;
+    }
+
+  /* All tasks we are waiting for are already running
+     in other threads.  Wait for them.  */
+  if (gomp_task_set_waiting (team, task))
+    {
+      gomp_sem_wait (&task->taskwait_sem);
+      gomp_task_clear_waiting (team, task);
     }
 }
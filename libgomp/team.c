@@ -44,6 +44,13 @@ pthread_key_t gomp_tls_key;
 #endif
 
 
+static struct gomp_thread_pool *gomp_new_thread_pool (void);
+static void gomp_free_pool (struct gomp_thread_pool *);
+static void gomp_free_nested_pools (struct gomp_thread *, unsigned);
+static void gomp_park_nested_pools (struct gomp_thread *, bool);
+static void gomp_idle_nested_pools (struct gomp_thread *);
+
+
 /* This structure is used to communicate across pthread_create.  */
 
 struct gomp_thread_start_data
@@ -53,7 +60,6 @@ struct gomp_thread_start_data
   struct gomp_team_state ts;
   struct gomp_task *task;
   struct gomp_thread_pool *thread_pool;
-  bool nested;
 };
 
 
@@ -76,73 +82,129 @@ gomp_thread_start (void *xdata)
   thr = &local_thr;
   pthread_setspecific (gomp_tls_key, thr);
 #endif
-  gomp_sem_init (&thr->release, 0);
-
   /* Extract what we need from data.  */
   local_fn = data->fn;
   local_data = data->fn_data;
   thr->thread_pool = data->thread_pool;
+  thr->nested_pool = NULL;
   thr->ts = data->ts;
   thr->task = data->task;
-
-  thr->ts.team->ordered_release[thr->ts.team_id] = &thr->release;
+  thr->trace = NULL;
+  thr->task_cache = NULL;
+  thr->task_cache_count = 0;
 
   /* Make thread pool local. */
   pool = thr->thread_pool;
+  pool->threads[thr->ts.team_id] = thr;
 
-  if (data->nested)
+  gomp_barrier_wait (&pool->threads_dock);
+  do
     {
       struct gomp_team *team = thr->ts.team;
       struct gomp_task *task = thr->task;
 
-      gomp_barrier_wait (&team->barrier);
-
+      gomp_trace (GOMP_TRACE_IMPLICIT_BEGIN, 0, (uintptr_t) local_fn);
       local_fn (local_data);
+      gomp_trace (GOMP_TRACE_IMPLICIT_END, 0, (uintptr_t) local_fn);
       gomp_team_barrier_wait (&team->barrier);
       gomp_finish_task (task);
-      gomp_barrier_wait_last (&team->barrier);
-    }
-  else
-    {
-      pool->threads[thr->ts.team_id] = thr;
 
+      gomp_idle_nested_pools (thr);
       gomp_barrier_wait (&pool->threads_dock);
-      do
-	{
-	  struct gomp_team *team = thr->ts.team;
-	  struct gomp_task *task = thr->task;
-
-	  local_fn (local_data);
-	  gomp_team_barrier_wait (&team->barrier);
-	  gomp_finish_task (task);
-
-	  gomp_barrier_wait (&pool->threads_dock);
+      gomp_park_nested_pools (thr, false);
 
-	  local_fn = thr->fn;
-	  local_data = thr->data;
-	  thr->fn = NULL;
-	}
-      while (local_fn);
+      local_fn = thr->fn;
+      local_data = thr->data;
+      thr->fn = NULL;
     }
+  while (local_fn);
 
-  gomp_sem_destroy (&thr->release);
+  gomp_free_nested_pools (thr, 0);
+  gomp_free_task_cache (thr);
   return NULL;
 }
 
 
-/* Create a new team data structure.  */
+/* Return the thread pool from which THR takes the threads of the
+   teams it starts.  Teams nested in another team have a pool of their
+   own for each master thread and nesting level, since the threads of
+   the pool for one level are busy while the master starts a team one
+   level deeper.  If CREATE, make the pool if it is missing, otherwise
+   return NULL.  */
+
+static struct gomp_thread_pool *
+gomp_team_pool (struct gomp_thread *thr, bool create)
+{
+  struct gomp_thread_pool **poolp, *pool;
+
+  if (thr->ts.team == NULL)
+    return thr->thread_pool;
+
+  poolp = &thr->nested_pool;
+  while (*poolp != NULL && (*poolp)->level < thr->ts.level)
+    poolp = &(*poolp)->nested;
+  if (*poolp != NULL && (*poolp)->level == thr->ts.level)
+    return *poolp;
+  if (!create)
+    return NULL;
+
+  pool = gomp_new_thread_pool ();
+  pool->level = thr->ts.level;
+  pool->nested = *poolp;
+  *poolp = pool;
+  return pool;
+}
+
+/* Create a new team data structure, or reuse the spare team of the
+   current thread's pool if it has the right size.  */
 
 struct gomp_team *
 gomp_new_team (unsigned nthreads)
 {
+  struct gomp_thread_pool *pool = gomp_team_pool (gomp_thread (), false);
   struct gomp_team *team;
   size_t size;
   int i;
 
-  size = sizeof (*team) + nthreads * (sizeof (team->ordered_release[0])
-				      + sizeof (team->implicit_task[0]));
+  if (pool != NULL
+      && pool->spare_team != NULL
+      && pool->spare_team->nthreads == nthreads)
+    {
+      /* Its barrier and task deques are still set up from the last
+	 time it was used.  */
+      team = pool->spare_team;
+      pool->spare_team = NULL;
+      for (i = 0; i < nthreads; i++)
+	{
+	  team->task_deques[i].head = 0;
+	  team->task_deques[i].tail = 0;
+	}
+      goto init;
+    }
+
+  size = sizeof (*team) + nthreads * (sizeof (team->implicit_task[0])
+				      + sizeof (team->task_deques[0]))
+	 + __alignof__ (struct gomp_task_deque) - 1;
   team = gomp_malloc (size);
 
+  team->nthreads = nthreads;
+  gomp_team_barrier_init (&team->barrier, nthreads);
+
+  gomp_mutex_init (&team->task_lock);
+  team->task_deques
+    = (void *) (((uintptr_t) &team->implicit_task[nthreads]
+		 + __alignof__ (struct gomp_task_deque) - 1)
+		& ~(uintptr_t) (__alignof__ (struct gomp_task_deque) - 1));
+  for (i = 0; i < nthreads; i++)
+    {
+      gomp_mutex_init (&team->task_deques[i].lock);
+      team->task_deques[i].head = 0;
+      team->task_deques[i].tail = 0;
+      team->task_deques[i].size = 0;
+      team->task_deques[i].tasks = NULL;
+    }
+
+ init:
   team->work_share_chunk = 8;
 #ifdef HAVE_SYNC_BUILTINS
   team->single_count = 0;
@@ -157,16 +219,8 @@ gomp_new_team (unsigned nthreads)
     team->work_shares[i].next_free = &team->work_shares[i + 1];
   team->work_shares[i].next_free = NULL;
 
-  team->nthreads = nthreads;
-  gomp_barrier_init (&team->barrier, nthreads);
-
-  gomp_sem_init (&team->master_release, 0);
-  team->ordered_release = (void *) &team->implicit_task[nthreads];
-  team->ordered_release[0] = &team->master_release;
-
-  gomp_mutex_init (&team->task_lock);
-  team->task_queue = NULL;
   team->task_count = 0;
+  team->task_queued_count = 0;
   team->task_running_count = 0;
 
   return team;
@@ -178,11 +232,29 @@ gomp_new_team (unsigned nthreads)
 static void
 free_team (struct gomp_team *team)
 {
+  unsigned i;
+
+  for (i = 0; i < team->nthreads; i++)
+    {
+      gomp_mutex_destroy (&team->task_deques[i].lock);
+      free (team->task_deques[i].tasks);
+    }
   gomp_barrier_destroy (&team->barrier);
   gomp_mutex_destroy (&team->task_lock);
   free (team);
 }
 
+/* Keep TEAM, which no thread uses any longer, as the spare team of
+   POOL.  */
+
+static void
+retire_team (struct gomp_thread_pool *pool, struct gomp_team *team)
+{
+  if (pool->spare_team)
+    free_team (pool->spare_team);
+  pool->spare_team = team;
+}
+
 /* Allocate and initialize a thread pool. */
 
 static struct gomp_thread_pool *gomp_new_thread_pool (void)
@@ -193,49 +265,144 @@ static struct gomp_thread_pool *gomp_new_thread_pool (void)
   pool->threads_size = 0;
   pool->threads_used = 0;
   pool->last_team = NULL;
+  pool->spare_team = NULL;
+  pool->level = 0;
+  pool->nested = NULL;
+  pool->parked = false;
   return pool;
 }
 
 static void
 gomp_free_pool_helper (void *thread_pool)
 {
+  struct gomp_thread *thr = gomp_thread ();
   struct gomp_thread_pool *pool
     = (struct gomp_thread_pool *) thread_pool;
+  gomp_free_nested_pools (thr, 0);
   gomp_barrier_wait_last (&pool->threads_dock);
-  gomp_sem_destroy (&gomp_thread ()->release);
+  gomp_free_task_cache (thr);
   pthread_exit (NULL);
 }
 
-/* Free a thread pool and release its threads. */
+/* Release the threads docked in POOL and free it.  */
 
 static void
-gomp_free_thread (void *arg __attribute__((unused)))
+gomp_free_pool (struct gomp_thread_pool *pool)
 {
-  struct gomp_thread *thr = gomp_thread ();
-  struct gomp_thread_pool *pool = thr->thread_pool;
-  if (pool)
+  if (pool->threads_used > 0)
     {
-      if (pool->threads_used > 0)
+      int i;
+      for (i = 1; i < pool->threads_used; i++)
 	{
-	  int i;
-	  for (i = 1; i < pool->threads_used; i++)
-	    {
-	      struct gomp_thread *nthr = pool->threads[i];
-	      nthr->fn = gomp_free_pool_helper;
-	      nthr->data = pool;
-	    }
-	  /* This barrier undocks threads docked on pool->threads_dock.  */
-	  gomp_barrier_wait (&pool->threads_dock);
-	  /* And this waits till all threads have called gomp_barrier_wait_last
-	     in gomp_free_pool_helper.  */
-	  gomp_barrier_wait (&pool->threads_dock);
-	  /* Now it is safe to destroy the barrier and free the pool.  */
-	  gomp_barrier_destroy (&pool->threads_dock);
+	  struct gomp_thread *nthr = pool->threads[i];
+	  nthr->fn = gomp_free_pool_helper;
+	  nthr->data = pool;
 	}
-      free (pool->threads);
-      if (pool->last_team)
-	free_team (pool->last_team);
-      free (pool);
+      /* This barrier undocks threads docked on pool->threads_dock.  */
+      gomp_barrier_wait (&pool->threads_dock);
+      /* And this waits till all threads have called gomp_barrier_wait_last
+	 in gomp_free_pool_helper.  */
+      gomp_barrier_wait (&pool->threads_dock);
+      /* Now it is safe to destroy the barrier and free the pool.  */
+      gomp_barrier_destroy (&pool->threads_dock);
+
+      if (!pool->parked)
+	{
+#ifdef HAVE_SYNC_BUILTINS
+	  __sync_fetch_and_add (&gomp_managed_threads,
+				1L - pool->threads_used);
+#else
+	  gomp_mutex_lock (&gomp_remaining_threads_lock);
+	  gomp_managed_threads -= pool->threads_used - 1L;
+	  gomp_mutex_unlock (&gomp_remaining_threads_lock);
+#endif
+	}
+    }
+  free (pool->threads);
+  if (pool->last_team)
+    free_team (pool->last_team);
+  if (pool->spare_team)
+    free_team (pool->spare_team);
+  if (pool->nested)
+    gomp_free_pool (pool->nested);
+  free (pool);
+}
+
+/* Free the nested pools THR uses at nesting levels deeper than LEVEL,
+   and release their threads.  */
+
+static void
+gomp_free_nested_pools (struct gomp_thread *thr, unsigned level)
+{
+  struct gomp_thread_pool **poolp = &thr->nested_pool;
+
+  while (*poolp != NULL && (*poolp)->level <= level)
+    poolp = &(*poolp)->nested;
+  if (*poolp != NULL)
+    {
+      gomp_free_pool (*poolp);
+      *poolp = NULL;
+    }
+}
+
+/* Stop counting the threads of the nested pools of THR in
+   gomp_managed_threads if PARK, or count them again if not.  Threads
+   docked in the pool of an idle owner can't be woken up, so they
+   shouldn't make waits elsewhere spin less.  */
+
+static void
+gomp_park_nested_pools (struct gomp_thread *thr, bool park)
+{
+  struct gomp_thread_pool *pool;
+  long diff = 0;
+
+  for (pool = thr->nested_pool; pool != NULL; pool = pool->nested)
+    if (pool->parked != park)
+      {
+	pool->parked = park;
+	if (pool->threads_used > 0)
+	  diff += pool->threads_used - 1L;
+      }
+  if (diff == 0)
+    return;
+  if (park)
+    diff = -diff;
+
+#ifdef HAVE_SYNC_BUILTINS
+  __sync_fetch_and_add (&gomp_managed_threads, diff);
+#else
+  gomp_mutex_lock (&gomp_remaining_threads_lock);
+  gomp_managed_threads += diff;
+  gomp_mutex_unlock (&gomp_remaining_threads_lock);
+#endif
+}
+
+/* THR is about to become idle.  Keep its nested pools for the nested
+   teams of the next region it takes part in, unless nesting has been
+   disabled, in which case there won't be any.  */
+
+static void
+gomp_idle_nested_pools (struct gomp_thread *thr)
+{
+  if (thr->nested_pool == NULL)
+    return;
+  if (gomp_icv (false)->nest_var)
+    gomp_park_nested_pools (thr, true);
+  else
+    gomp_free_nested_pools (thr, 0);
+}
+
+/* Free the thread pools of the current thread and release their
+   threads. */
+
+static void
+gomp_free_thread (void *arg __attribute__((unused)))
+{
+  struct gomp_thread *thr = gomp_thread ();
+  gomp_free_nested_pools (thr, 0);
+  if (thr->thread_pool)
+    {
+      gomp_free_pool (thr->thread_pool);
       thr->thread_pool = NULL;
     }
   if (thr->task != NULL)
@@ -244,6 +411,7 @@ gomp_free_thread (void *arg __attribute__((unused)))
       gomp_end_task ();
       free (task);
     }
+  gomp_free_task_cache (thr);
 }
 
 /* Launch a team.  */
@@ -263,12 +431,17 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
 
   thr = gomp_thread ();
   nested = thr->ts.team != NULL;
+  if (!nested)
+    gomp_park_nested_pools (thr, false);
+  gomp_trace (GOMP_TRACE_PARALLEL_BEGIN, nthreads, (uintptr_t) fn);
   if (__builtin_expect (thr->thread_pool == NULL, 0))
     {
       thr->thread_pool = gomp_new_thread_pool ();
       pthread_setspecific (gomp_thread_destructor, thr);
     }
-  pool = thr->thread_pool;
+  /* A team of one thread takes none from a pool, so don't make a
+     nested pool for it.  */
+  pool = nthreads > 1 ? gomp_team_pool (thr, true) : NULL;
   task = thr->task;
   icv = task ? &task->icv : &gomp_global_icv;
 
@@ -296,71 +469,67 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
 
   i = 1;
 
-  /* We only allow the reuse of idle threads for non-nested PARALLEL
-     regions.  This appears to be implied by the semantics of
-     threadprivate variables, but perhaps that's reading too much into
-     things.  Certainly it does prevent any locking problems, since
-     only the initial program thread will modify gomp_threads.  */
-  if (!nested)
-    {
-      old_threads_used = pool->threads_used;
+  /* Idle threads are reused for nested PARALLEL regions too, but each
+     master thread takes them from a pool of its own for every nesting
+     level, so only the thread owning a pool ever modifies it.
+     Threadprivate variables need not persist across nested regions, so
+     handing them to different threads of the pool is fine.  */
+  old_threads_used = pool->threads_used;
 
-      if (nthreads <= old_threads_used)
-	n = nthreads;
-      else if (old_threads_used == 0)
-	{
-	  n = 0;
-	  gomp_barrier_init (&pool->threads_dock, nthreads);
-	}
-      else
-	{
-	  n = old_threads_used;
+  if (nthreads <= old_threads_used)
+    n = nthreads;
+  else if (old_threads_used == 0)
+    {
+      n = 0;
+      gomp_barrier_init (&pool->threads_dock, nthreads);
+    }
+  else
+    {
+      n = old_threads_used;
 
-	  /* Increase the barrier threshold to make sure all new
-	     threads arrive before the team is released.  */
-	  gomp_barrier_reinit (&pool->threads_dock, nthreads);
-	}
+      /* Increase the barrier threshold to make sure all new
+	 threads arrive before the team is released.  */
+      gomp_barrier_reinit (&pool->threads_dock, nthreads);
+    }
 
-      /* Not true yet, but soon will be.  We're going to release all
-	 threads from the dock, and those that aren't part of the
-	 team will exit.  */
-      pool->threads_used = nthreads;
+  /* Not true yet, but soon will be.  We're going to release all
+     threads from the dock, and those that aren't part of the
+     team will exit.  */
+  pool->threads_used = nthreads;
 
-      /* Release existing idle threads.  */
-      for (; i < n; ++i)
-	{
-	  nthr = pool->threads[i];
-	  nthr->ts.team = team;
-	  nthr->ts.work_share = &team->work_shares[0];
-	  nthr->ts.last_work_share = NULL;
-	  nthr->ts.team_id = i;
-	  nthr->ts.level = team->prev_ts.level + 1;
-	  nthr->ts.active_level = thr->ts.active_level;
+  /* Release existing idle threads.  */
+  for (; i < n; ++i)
+    {
+      nthr = pool->threads[i];
+      nthr->ts.team = team;
+      nthr->ts.work_share = &team->work_shares[0];
+      nthr->ts.last_work_share = NULL;
+      nthr->ts.team_id = i;
+      nthr->ts.level = team->prev_ts.level + 1;
+      nthr->ts.active_level = thr->ts.active_level;
 #ifdef HAVE_SYNC_BUILTINS
-	  nthr->ts.single_count = 0;
+      nthr->ts.single_count = 0;
 #endif
-	  nthr->ts.static_trip = 0;
-	  nthr->task = &team->implicit_task[i];
-	  gomp_init_task (nthr->task, task, icv);
-	  nthr->fn = fn;
-	  nthr->data = data;
-	  team->ordered_release[i] = &nthr->release;
-	}
+      nthr->ts.static_trip = 0;
+      nthr->task = &team->implicit_task[i];
+      gomp_init_task (nthr->task, task, icv);
+      nthr->fn = fn;
+      nthr->data = data;
+    }
 
-      if (i == nthreads)
-	goto do_release;
+  if (i == nthreads)
+    goto do_release;
 
-      /* If necessary, expand the size of the gomp_threads array.  It is
-	 expected that changes in the number of threads are rare, thus we
-	 make no effort to expand gomp_threads_size geometrically.  */
-      if (nthreads >= pool->threads_size)
-	{
-	  pool->threads_size = nthreads + 1;
-	  pool->threads
-	    = gomp_realloc (pool->threads,
-			    pool->threads_size
-			    * sizeof (struct gomp_thread_data *));
-	}
+  /* If necessary, expand the size of the gomp_threads array.  It is
+     expected that changes in the number of threads are rare, thus we
+     make no effort to expand gomp_threads_size geometrically.  */
+  if (nthreads >= pool->threads_size)
+    {
+      pool->threads_size = nthreads + 1;
+      pool->threads
+	= gomp_realloc (pool->threads,
+			pool->threads_size
+			* sizeof (struct gomp_thread_data *));
     }
 
   if (__builtin_expect (nthreads > old_threads_used, 0))
@@ -414,10 +583,12 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
       start_data->task = &team->implicit_task[i];
       gomp_init_task (start_data->task, task, icv);
       start_data->thread_pool = pool;
-      start_data->nested = nested;
 
+      /* Members of non-nested teams are bound according to their
+	 position in the pool, so that each team member runs on the same
+	 CPU in consecutive parallel regions.  */
       if (gomp_cpu_affinity != NULL)
-	gomp_init_thread_affinity (attr);
+	gomp_init_thread_affinity (attr, nested ? ~0U : i);
 
       err = pthread_create (&pt, attr, gomp_thread_start, start_data);
       if (err != 0)
@@ -428,12 +599,11 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
     pthread_attr_destroy (&thread_attr);
 
  do_release:
-  gomp_barrier_wait (nested ? &team->barrier : &pool->threads_dock);
+  gomp_barrier_wait (&pool->threads_dock);
 
   /* Decrease the barrier threshold to match the number of threads
      that should arrive back at the end of this team.  The extra
-     threads should be exiting.  Note that we arrange for this test
-     to never be true for nested teams.  */
+     threads should be exiting.  */
   if (__builtin_expect (nthreads < old_threads_used, 0))
     {
       long diff = (long) nthreads - (long) old_threads_used;
@@ -459,27 +629,15 @@ gomp_team_end (void)
 {
   struct gomp_thread *thr = gomp_thread ();
   struct gomp_team *team = thr->ts.team;
+  struct gomp_thread_pool *pool;
 
   /* This barrier handles all pending explicit threads.  */
   gomp_team_barrier_wait (&team->barrier);
   gomp_fini_work_share (thr->ts.work_share);
 
   gomp_end_task ();
-  thr->ts = team->prev_ts;
 
-  if (__builtin_expect (thr->ts.team != NULL, 0))
-    {
-#ifdef HAVE_SYNC_BUILTINS
-      __sync_fetch_and_add (&gomp_managed_threads, 1L - team->nthreads);
-#else
-      gomp_mutex_lock (&gomp_remaining_threads_lock);
-      gomp_managed_threads -= team->nthreads - 1L;
-      gomp_mutex_unlock (&gomp_remaining_threads_lock);
-#endif
-      /* This barrier has gomp_barrier_wait_last counterparts
-	 and ensures the team can be safely destroyed.  */
-      gomp_barrier_wait (&team->barrier);
-    }
+  thr->ts = team->prev_ts;
 
   if (__builtin_expect (team->work_shares[0].next_alloc != NULL, 0))
     {
@@ -492,21 +650,31 @@ gomp_team_end (void)
 	}
       while (ws != NULL);
     }
-  gomp_sem_destroy (&team->master_release);
 #ifndef HAVE_SYNC_BUILTINS
   gomp_mutex_destroy (&team->work_share_list_free_lock);
 #endif
 
-  if (__builtin_expect (thr->ts.team != NULL, 0)
-      || __builtin_expect (team->nthreads == 1, 0))
-    free_team (team);
+  if (thr->ts.team == NULL)
+    gomp_idle_nested_pools (thr);
+
+  /* The other threads may still be leaving the team barrier, so the
+     team is only kept as the spare team of the pool, to be reused by
+     gomp_new_team, after the next team has docked them again.  */
+  pool = gomp_team_pool (thr, false);
+  if (__builtin_expect (team->nthreads == 1, 0))
+    {
+      if (pool != NULL)
+	retire_team (pool, team);
+      else
+	free_team (team);
+    }
   else
     {
-      struct gomp_thread_pool *pool = thr->thread_pool;
       if (pool->last_team)
-	free_team (pool->last_team);
+	retire_team (pool, pool->last_team);
       pool->last_team = team;
     }
+  gomp_trace (GOMP_TRACE_PARALLEL_END, 0, 0);
 }
 
 
@@ -515,8 +683,6 @@ gomp_team_end (void)
 static void __attribute__((constructor))
 initialize_team (void)
 {
-  struct gomp_thread *thr;
-
 #ifndef HAVE_TLS
   static struct gomp_thread initial_thread_tls_data;
 
@@ -526,13 +692,6 @@ initialize_team (void)
 
   if (pthread_key_create (&gomp_thread_destructor, gomp_free_thread) != 0)
     gomp_fatal ("could not create thread pool destructor.");
-
-#ifdef HAVE_TLS
-  thr = &gomp_tls_data;
-#else
-  thr = &initial_thread_tls_data;
-#endif
-  gomp_sem_init (&thr->release, 0);
 }
 
 static void __attribute__((destructor))
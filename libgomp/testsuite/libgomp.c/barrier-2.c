@@ -0,0 +1,93 @@
+/* { dg-do run { target *-*-linux* } } */
+
+/* Team barriers with GOMP_BARRIER=tree,2, which the test sets by
+   running itself again, for teams of many sizes, so that the combining
+   tree has from one to several levels.  No thread may leave a barrier
+   before every thread of the team has arrived at it, and tasks queued
+   before a barrier must be done after it.  */
+
+#include <omp.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+extern void abort (void);
+
+#define MAX_THREADS 40
+#define ROUNDS 200
+
+volatile int phase[MAX_THREADS];
+int tasks_done[MAX_THREADS];
+
+void
+check_phases (int n, int expect)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    if (phase[i] != expect)
+      abort ();
+}
+
+void
+run (int nthreads)
+{
+  int i;
+
+  for (i = 0; i < MAX_THREADS; i++)
+    phase[i] = tasks_done[i] = 0;
+
+  #pragma omp parallel num_threads (nthreads)
+    {
+      int id = omp_get_thread_num (), n = omp_get_num_threads (), r, j;
+
+      if (n != nthreads)
+	abort ();
+      for (r = 0; r < ROUNDS; r++)
+	{
+	  phase[id] = r + 1;
+	  #pragma omp barrier
+	  check_phases (n, r + 1);
+	  #pragma omp barrier
+
+	  /* The tasks of every thread are done when the barrier
+	     is left.  */
+	  #pragma omp task firstprivate (id)
+	    {
+	      #pragma omp atomic
+		tasks_done[id]++;
+	    }
+	  #pragma omp barrier
+	  for (j = 0; j < n; j++)
+	    if (tasks_done[j] != r + 1)
+	      abort ();
+	  #pragma omp barrier
+	}
+
+      /* The barrier at the end of a worksharing construct.  */
+      #pragma omp for schedule (static, 1)
+	for (i = 0; i < n; i++)
+	  phase[i] = -1;
+      check_phases (n, -1);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  int n;
+
+  if (getenv ("GOMP_BARRIER") == NULL)
+    {
+      setenv ("GOMP_BARRIER", "tree,2", 1);
+      execv ("/proc/self/exe", argv);
+    }
+
+  omp_set_dynamic (0);
+  for (n = 1; n <= 17; n++)
+    run (n);
+  run (MAX_THREADS);
+  /* Shrink again, so that teams with a smaller tree reuse threads
+     that waited on a bigger one.  */
+  for (n = 9; n >= 1; n -= 4)
+    run (n);
+  return 0;
+}
@@ -0,0 +1,89 @@
+/* { dg-do run { target *-*-linux* } } */
+
+/* Locks and critical sections under contention with GOMP_LOCK=mcs and
+   GOMP_LOCK_STATS, which the test sets by running itself again.  */
+
+#include <omp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern void abort (void);
+
+omp_lock_t lock;
+omp_nest_lock_t nest_lock;
+long counts[5];
+
+void
+check (int n)
+{
+  int i;
+  for (i = 0; i < 5; i++)
+    if (counts[i] != n)
+      abort ();
+}
+
+void
+work (int n)
+{
+  int i;
+
+  memset (counts, 0, sizeof (counts));
+  #pragma omp parallel for schedule (dynamic, 16)
+  for (i = 0; i < n; i++)
+    {
+      omp_set_lock (&lock);
+      counts[0]++;
+      omp_unset_lock (&lock);
+
+      omp_set_nest_lock (&nest_lock);
+      omp_set_nest_lock (&nest_lock);
+      counts[1]++;
+      omp_unset_nest_lock (&nest_lock);
+      omp_unset_nest_lock (&nest_lock);
+
+      while (!omp_test_lock (&lock))
+	;
+      counts[2]++;
+      omp_unset_lock (&lock);
+
+      #pragma omp critical
+	counts[3]++;
+      #pragma omp critical (named)
+	counts[4]++;
+    }
+  check (n);
+}
+
+int
+main (int argc, char **argv)
+{
+  int i;
+
+  if (getenv ("GOMP_LOCK") == NULL)
+    {
+      setenv ("GOMP_LOCK", "mcs", 1);
+      setenv ("GOMP_LOCK_STATS", "true", 1);
+      execv ("/proc/self/exe", argv);
+    }
+
+  omp_init_lock (&lock);
+  omp_init_nest_lock (&nest_lock);
+  for (i = 0; i < 3; i++)
+    work (20000);
+  omp_set_num_threads (1);
+  work (1000);
+  omp_destroy_nest_lock (&nest_lock);
+  omp_destroy_lock (&lock);
+
+  /* Locks must keep working after others have been destroyed.  */
+  for (i = 0; i < 100; i++)
+    {
+      omp_init_lock (&lock);
+      if (!omp_test_lock (&lock) || omp_test_lock (&lock))
+	abort ();
+      omp_unset_lock (&lock);
+      omp_destroy_lock (&lock);
+    }
+  return 0;
+}
@@ -0,0 +1,67 @@
+/* { dg-do run { target *-*-linux* } } */
+
+/* Locks under contention with GOMP_SPINCOUNT=adaptive, which the test
+   sets by running itself again, taken by threads that were never part
+   of a team, before and after a parallel region.  */
+
+#include <omp.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+extern void abort (void);
+
+#define THREADS 4
+#define REPS 20000
+
+omp_lock_t lock;
+long count;
+
+void *
+work (void *arg)
+{
+  int i;
+
+  for (i = 0; i < REPS; i++)
+    {
+      omp_set_lock (&lock);
+      count++;
+      omp_unset_lock (&lock);
+    }
+  return arg;
+}
+
+void
+run (void)
+{
+  pthread_t threads[THREADS];
+  int i;
+
+  count = 0;
+  for (i = 0; i < THREADS; i++)
+    if (pthread_create (&threads[i], NULL, work, NULL) != 0)
+      abort ();
+  work (NULL);
+  for (i = 0; i < THREADS; i++)
+    pthread_join (threads[i], NULL);
+  if (count != (THREADS + 1) * REPS)
+    abort ();
+}
+
+int
+main (int argc, char **argv)
+{
+  if (getenv ("GOMP_SPINCOUNT") == NULL)
+    {
+      setenv ("GOMP_SPINCOUNT", "adaptive", 1);
+      execv ("/proc/self/exe", argv);
+    }
+
+  omp_init_lock (&lock);
+  run ();
+  #pragma omp parallel
+    work (NULL);
+  run ();
+  omp_destroy_lock (&lock);
+  return 0;
+}
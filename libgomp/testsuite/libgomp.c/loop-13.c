@@ -0,0 +1,123 @@
+/* { dg-do run } */
+
+/* Dynamic and guided unsigned long long loops whose iteration ranges
+   touch the ends of the type or cross 2^63, with chunks smaller and
+   larger than the loop.  Every iteration must run exactly once.  The
+   test runs itself again with GOMP_ADAPTIVE_CHUNK=true.  */
+
+#include <omp.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+extern void abort (void);
+
+#define MAX 0xffffffffffffffffULL
+#define N 2048
+
+int hits[N];
+
+void
+check (int n)
+{
+  int i;
+  for (i = 0; i < N; i++)
+    if (hits[i] != (i < n))
+      abort ();
+    else
+      hits[i] = 0;
+}
+
+void
+hit (unsigned long long i)
+{
+  if (i >= N)
+    abort ();
+  #pragma omp atomic
+    hits[i]++;
+}
+
+/* Run the loops of the test with the schedule set by omp_set_schedule.  */
+
+void
+loops (void)
+{
+  unsigned long long u, base;
+
+  /* Up to the largest value.  */
+  base = MAX - 1000;
+  #pragma omp parallel for schedule (runtime)
+    for (u = base; u < MAX; u++)
+      hit (u - base);
+  check (1000);
+
+  /* Down from the largest value.  */
+  #pragma omp parallel for schedule (runtime)
+    for (u = MAX; u > MAX - 1500; u--)
+      hit (MAX - u);
+  check (1500);
+
+  /* Down to zero.  */
+  #pragma omp parallel for schedule (runtime)
+    for (u = 1200; u > 0; u--)
+      hit (u - 1);
+  check (1200);
+
+  /* Across 2^63.  */
+  base = 0x8000000000000000ULL - 700;
+  #pragma omp parallel for schedule (runtime)
+    for (u = base; u < base + 1400; u++)
+      hit (u - base);
+  check (1400);
+
+  /* An increment that does not divide the range, up to just below
+     the largest value.  */
+  base = MAX - 7 * 900;
+  #pragma omp parallel for schedule (runtime)
+    for (u = base; u < MAX - 3; u += 7)
+      hit ((u - base) / 7);
+  check (900);
+
+  /* Huge decrements, from the largest value down to just above
+     zero.  */
+  #pragma omp parallel for schedule (runtime)
+    for (u = MAX; u >= 0x0100000000000000ULL; u -= 0x0100000000000000ULL)
+      hit ((MAX - u) / 0x0100000000000000ULL);
+  check (255);
+
+  /* A loop with one iteration and one with none.  */
+  #pragma omp parallel for schedule (runtime)
+    for (u = MAX - 1; u < MAX; u++)
+      hit (0);
+  check (1);
+  #pragma omp parallel for schedule (runtime)
+    for (u = MAX; u < MAX; u++)
+      hit (0);
+  check (0);
+}
+
+int
+main (int argc, char **argv)
+{
+  static const int chunks[3] = { 1, 3, 1000000 };
+  int nthreads, i;
+
+  omp_set_dynamic (0);
+  for (nthreads = 1; nthreads <= 8; nthreads++)
+    {
+      omp_set_num_threads (nthreads);
+      for (i = 0; i < 3; i++)
+	{
+	  omp_set_schedule (omp_sched_dynamic, chunks[i]);
+	  loops ();
+	  omp_set_schedule (omp_sched_guided, chunks[i]);
+	  loops ();
+	}
+    }
+
+  if (getenv ("GOMP_ADAPTIVE_CHUNK") == NULL)
+    {
+      setenv ("GOMP_ADAPTIVE_CHUNK", "true", 1);
+      execv ("/proc/self/exe", argv);
+    }
+  return 0;
+}
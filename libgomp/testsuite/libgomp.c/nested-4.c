@@ -0,0 +1,46 @@
+/* { dg-do run } */
+
+/* The master thread of each nested team starts a team one level
+   deeper while the other threads of its team are still busy.  */
+
+#include <omp.h>
+#include <stdlib.h>
+
+int counts[5];
+
+void
+nest (int level)
+{
+  if (level == 5)
+    return;
+#pragma omp parallel num_threads (2)
+  {
+#pragma omp atomic
+    counts[level]++;
+    if (omp_get_thread_num () == 0)
+      nest (level + 1);
+  }
+}
+
+int
+main (void)
+{
+  int i, rep;
+
+  omp_set_nested (1);
+  omp_set_dynamic (0);
+  for (rep = 0; rep < 20; rep++)
+    {
+      for (i = 0; i < 5; i++)
+	counts[i] = 0;
+      nest (0);
+      for (i = 0; i < 5; i++)
+	if (counts[i] != 2)
+	  abort ();
+#pragma omp parallel num_threads (3)
+      nest (3);
+      if (counts[3] != 2 + 3 * 2 || counts[4] != 2 + 3 * 2)
+	abort ();
+    }
+  return 0;
+}
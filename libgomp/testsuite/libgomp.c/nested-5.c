@@ -0,0 +1,130 @@
+/* { dg-do run { target *-*-linux* } } */
+
+/* Nested teams reuse the threads of the earlier ones, both within one
+   parallel region and across consecutive ones, also when their sizes
+   change, and those threads are released once nesting is disabled.  */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern void abort (void);
+
+#define OUTER 3
+#define INNER 4
+#define REPS 500
+
+static int seen;
+#pragma omp threadprivate (seen)
+
+int new_threads;
+
+/* Return the number of threads of the process.  */
+
+int
+count_threads (void)
+{
+  char line[256];
+  int n = -1;
+  FILE *f = fopen ("/proc/self/status", "r");
+
+  if (f == NULL)
+    return -1;
+  while (fgets (line, sizeof (line), f))
+    if (strncmp (line, "Threads:", 8) == 0)
+      n = atoi (line + 8);
+  fclose (f);
+  return n;
+}
+
+void
+note_thread (void)
+{
+  if (!seen)
+    {
+      seen = 1;
+      #pragma omp atomic
+	new_threads++;
+    }
+}
+
+int
+main (void)
+{
+  int i, n, count = 0;
+
+  omp_set_nested (1);
+  omp_set_dynamic (0);
+
+  /* Teams of the same size: only the first of each master makes new
+     threads, also when the enclosing region is started again.  */
+  for (i = 0; i < 2; i++)
+    #pragma omp parallel num_threads (OUTER)
+      {
+	int j;
+
+	note_thread ();
+	for (j = 0; j < REPS; j++)
+	  {
+	    #pragma omp parallel num_threads (INNER)
+	      {
+		note_thread ();
+		if (omp_get_num_threads () != INNER || omp_get_level () != 2)
+		  abort ();
+		#pragma omp atomic
+		  count++;
+	      }
+	  }
+      }
+  if (count != 2 * OUTER * REPS * INNER)
+    abort ();
+  if (new_threads > OUTER * INNER)
+    abort ();
+
+  /* Growing and shrinking teams, two levels deep.  */
+  count = 0;
+  #pragma omp parallel num_threads (OUTER)
+    {
+      int j;
+
+      for (j = 0; j < REPS; j++)
+	{
+	  #pragma omp parallel num_threads (1 + j % INNER)
+	    {
+	      #pragma omp parallel num_threads (2)
+		{
+		  #pragma omp atomic
+		    count++;
+		}
+	    }
+	}
+    }
+  for (i = 0, n = 0; i < REPS; i++)
+    n += 2 * (1 + i % INNER);
+  if (count != OUTER * n)
+    abort ();
+
+  /* Between regions, the threads of the nested teams stay around for
+     the next one.  */
+  if (count_threads () <= OUTER)
+    abort ();
+
+  /* Once a region has ended with nesting disabled, the threads of the
+     nested teams are gone.  Those that are still exiting get some time
+     to do so.  */
+  omp_set_nested (0);
+  #pragma omp parallel num_threads (OUTER)
+    note_thread ();
+  for (i = 0; i < 1000; i++)
+    {
+      n = count_threads ();
+      if (n <= OUTER)
+	break;
+      usleep (10000);
+    }
+  if (n > OUTER)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,119 @@
+/* { dg-do run } */
+
+/* ORDERED regions run in iteration order for teams whose size is not a
+   power of two, with every schedule, with and without chunk sizes, for
+   long and unsigned long long loops in both directions, and when only
+   some iterations enter the ordered region.  */
+
+#include <omp.h>
+#include <stdlib.h>
+
+#define N 1000
+
+long cnt;
+
+void
+check (long x)
+{
+  if (cnt != x)
+    abort ();
+  cnt++;
+}
+
+void
+done (long n)
+{
+  if (cnt != n)
+    abort ();
+  cnt = 0;
+}
+
+void
+test_long (void)
+{
+  long i;
+
+  #pragma omp parallel for ordered schedule (runtime)
+  for (i = 0; i < N; i++)
+    {
+      #pragma omp ordered
+	check (i);
+    }
+  done (N);
+
+  #pragma omp parallel for ordered schedule (runtime)
+  for (i = N + 6; i > 6; i -= 3)
+    {
+      #pragma omp ordered
+	check ((N + 6 - i) / 3);
+    }
+  done ((N + 2) / 3);
+
+  #pragma omp parallel for ordered schedule (runtime)
+  for (i = 0; i < N; i++)
+    if (i % 7 == 3)
+      {
+	#pragma omp ordered
+	  check (i / 7);
+      }
+  done ((N + 3) / 7);
+}
+
+/* Make the compiler use the unsigned long long entry points.  */
+unsigned long long base = -2ULL * N;
+
+void
+test_ull (void)
+{
+  unsigned long long i;
+
+  #pragma omp parallel for ordered schedule (runtime)
+  for (i = base; i < base + N; i++)
+    {
+      #pragma omp ordered
+	check (i - base);
+    }
+  done (N);
+
+  #pragma omp parallel for ordered schedule (runtime)
+  for (i = base + N + 6; i > base + 6; i -= 3)
+    {
+      #pragma omp ordered
+	check ((base + N + 6 - i) / 3);
+    }
+  done ((N + 2) / 3);
+
+  #pragma omp parallel for ordered schedule (runtime)
+  for (i = base; i < base + N; i++)
+    if ((i - base) % 7 == 3)
+      {
+	#pragma omp ordered
+	  check ((i - base) / 7);
+      }
+  done ((N + 3) / 7);
+}
+
+int
+main (void)
+{
+  static const int sizes[] = { 2, 3, 5, 17 };
+  static const omp_sched_t kinds[]
+    = { omp_sched_static, omp_sched_dynamic, omp_sched_guided };
+  static const int chunks[] = { 0, 1, 3, 64, 2 * N };
+  int s, k, c;
+
+  omp_set_dynamic (0);
+  for (s = 0; s < 4; s++)
+    {
+      omp_set_num_threads (sizes[s]);
+      for (k = 0; k < 3; k++)
+	for (c = 0; c < 5; c++)
+	  {
+	    /* A chunk size of 0 leaves the default.  */
+	    omp_set_schedule (kinds[k], chunks[c]);
+	    test_long ();
+	    test_ull ();
+	  }
+    }
+  return 0;
+}
@@ -0,0 +1,83 @@
+/* { dg-do run } */
+
+/* Deep recursion of tasks with small and large firstprivate blocks,
+   so that task descriptors of both kinds are recycled between threads
+   and tasks are both queued and run immediately at various depths.  */
+
+#include <omp.h>
+#include <stdlib.h>
+
+extern void abort (void);
+
+long sum, big_sum;
+
+struct big
+{
+  long v[64];
+};
+
+void
+check_big (struct big b, int n)
+{
+  int i;
+  for (i = 0; i < 64; i++)
+    if (b.v[i] != n + i)
+      abort ();
+  #pragma omp atomic
+    big_sum += n;
+}
+
+long
+walk (int n)
+{
+  long l = 0, r = 0;
+  struct big b;
+  int i;
+
+  if (n < 2)
+    return 1;
+  for (i = 0; i < 64; i++)
+    b.v[i] = n + i;
+  #pragma omp task firstprivate (b, n)
+    check_big (b, n);
+  #pragma omp task shared (l)
+    l = walk (n - 1);
+  #pragma omp task shared (r)
+    r = walk (n - 2);
+  #pragma omp task firstprivate (n)
+    {
+      #pragma omp atomic
+	sum += n;
+    }
+  #pragma omp taskwait
+  return l + r + 1;
+}
+
+long
+walk_serial (int n, long *s)
+{
+  if (n < 2)
+    return 1;
+  *s += n;
+  return walk_serial (n - 1, s) + walk_serial (n - 2, s) + 1;
+}
+
+int
+main ()
+{
+  long nodes, expect_nodes, expect_sum = 0;
+  int rep;
+
+  expect_nodes = walk_serial (20, &expect_sum);
+  for (rep = 0; rep < 3; rep++)
+    {
+      sum = 0;
+      big_sum = 0;
+      #pragma omp parallel
+	#pragma omp single
+	  nodes = walk (20);
+      if (nodes != expect_nodes || sum != expect_sum || big_sum != expect_sum)
+	abort ();
+    }
+  return 0;
+}
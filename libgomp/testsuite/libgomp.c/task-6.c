@@ -0,0 +1,124 @@
+/* { dg-do run } */
+
+/* Tasks queued by one thread are stolen by the others, both while it
+   keeps queueing and while it waits for them.  Every task, and every
+   child of a stolen task, must run exactly once.  */
+
+#include <omp.h>
+#include <stdlib.h>
+
+extern void abort (void);
+
+#define N 4096
+
+int runs[N], child_runs[N][2];
+int ran_on[N];
+
+void
+child (int i, int j)
+{
+  #pragma omp atomic
+    child_runs[i][j]++;
+}
+
+void
+work (int i)
+{
+  volatile int spin;
+
+  #pragma omp atomic
+    runs[i]++;
+  ran_on[i] = omp_get_thread_num ();
+  if (i % 4 == 0)
+    {
+      #pragma omp task firstprivate (i)
+	child (i, 0);
+      #pragma omp task firstprivate (i)
+	child (i, 1);
+      #pragma omp taskwait
+      if (child_runs[i][0] != 1 || child_runs[i][1] != 1)
+	abort ();
+    }
+  for (spin = 0; spin < (i % 7) * 100; spin++)
+    ;
+}
+
+void
+check (int nthreads, int waited)
+{
+  int i, stolen = 0;
+
+  for (i = 0; i < N; i++)
+    {
+      if (runs[i] != 1)
+	abort ();
+      if (i % 4 == 0 && (child_runs[i][0] != 1 || child_runs[i][1] != 1))
+	abort ();
+      if (i % 4 != 0 && (child_runs[i][0] != 0 || child_runs[i][1] != 0))
+	abort ();
+      if (ran_on[i] != 0)
+	stolen++;
+      runs[i] = child_runs[i][0] = child_runs[i][1] = 0;
+    }
+  /* Task 0 was waited for until another thread had run it.  */
+  if (nthreads > 1 && waited && stolen == 0)
+    abort ();
+}
+
+int
+main (void)
+{
+  int nthreads, rep, i;
+
+  omp_set_dynamic (0);
+  for (nthreads = 1; nthreads <= 8; nthreads *= 2)
+    for (rep = 0; rep < 4; rep++)
+      {
+	int waited = 0;
+
+	/* Thread 0 queues all the tasks and the other threads steal them
+	   at the closing barrier.  */
+	#pragma omp parallel num_threads (nthreads)
+	  #pragma omp master
+	    {
+	      volatile int *run0 = &runs[0];
+
+	      #pragma omp task
+		work (0);
+	      /* Give the other threads the chance to steal the first
+		 task before queueing the rest.  */
+	      if (omp_get_num_threads () > 1)
+		{
+		  while (*run0 == 0)
+		    ;
+		  waited = 1;
+		}
+	      for (i = 1; i < N; i++)
+		{
+		  #pragma omp task firstprivate (i)
+		    work (i);
+		}
+	    }
+	check (nthreads, waited);
+
+	/* Thread 0 waits for its own tasks while the others steal
+	   them.  */
+	#pragma omp parallel num_threads (nthreads)
+	  {
+	    #pragma omp single
+	      {
+		for (i = 0; i < N; i++)
+		  {
+		    #pragma omp task firstprivate (i)
+		      work (i);
+		  }
+		#pragma omp taskwait
+		for (i = 0; i < N; i++)
+		  if (runs[i] != 1)
+		    abort ();
+	      }
+	  }
+	check (nthreads, 0);
+      }
+  return 0;
+}
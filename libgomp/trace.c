@@ -0,0 +1,211 @@
+/* Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNU OpenMP Library (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This file implements GOMP_TRACE: every thread records timestamped
+   runtime events into a ring buffer of its own, without any locking,
+   and the buffers are written to a file when the program exits.
+
+   The file starts with a header of the magic string "GOMPTRC1", then
+   the 32-bit words 0x01020304, to tell the byte order, the size of an
+   event record, 24, the process id and a zero.  It is followed by one
+   block per thread: a 32-bit thread number, a 32-bit zero, the 64-bit
+   count of all events the thread recorded and the 64-bit count N of
+   events that follow, and then the last N events the thread recorded,
+   oldest first, each as struct gomp_trace_event.  contrib/gomp-trace2json.c
+   turns such a file into a trace the Chrome trace viewer can show.  */
+
+#include "libgomp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if TIME_WITH_SYS_TIME
+# include <sys/time.h>
+# include <time.h>
+#else
+# if HAVE_SYS_TIME_H
+#  include <sys/time.h>
+# else
+#  include <time.h>
+# endif
+#endif
+
+struct gomp_trace_event
+{
+  /* Nanoseconds since gomp_trace_init.  */
+  uint64_t time;
+  /* An enum gomp_trace_kind.  */
+  uint32_t kind;
+  uint32_t arg0;
+  uint64_t arg1;
+};
+
+struct gomp_trace_buffer
+{
+  struct gomp_trace_buffer *next;
+  uint32_t thread;
+  /* The number of events recorded so far.  Event I is kept in
+     events[I & trace_mask] until it is overwritten.  */
+  uint64_t count;
+  struct gomp_trace_event events[];
+};
+
+bool gomp_trace_var;
+
+static char *trace_file;
+static unsigned long trace_mask;
+static uint64_t trace_start;
+
+/* All buffers, for writing them out at exit, and the number of threads
+   that got one.  */
+static struct gomp_trace_buffer *trace_buffers;
+static uint32_t trace_threads;
+static gomp_mutex_t trace_lock;
+
+static inline uint64_t
+trace_clock (void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ts;
+# ifdef CLOCK_MONOTONIC
+  if (clock_gettime (CLOCK_MONOTONIC, &ts) < 0)
+# endif
+    clock_gettime (CLOCK_REALTIME, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#endif
+}
+
+/* Start tracing into FILE, keeping the last SIZE events of each thread.
+   A %p in FILE is replaced by the process id, so that the processes of
+   a job with several of them don't overwrite each other's traces.  */
+
+void
+gomp_trace_init (const char *file, unsigned long size)
+{
+  const char *p = strstr (file, "%p");
+  unsigned long n;
+
+  n = strlen (file) + 3 * sizeof (long);
+  trace_file = gomp_malloc (n);
+  if (p == NULL)
+    strcpy (trace_file, file);
+  else
+    snprintf (trace_file, n, "%.*s%ld%s", (int) (p - file), file,
+	      (long) getpid (), p + 2);
+
+  for (n = 1; n < size && n * 2 != 0; n *= 2)
+    ;
+  trace_mask = n - 1;
+  gomp_mutex_init (&trace_lock);
+  trace_start = trace_clock ();
+  gomp_trace_var = true;
+}
+
+/* Give the current thread its ring buffer.  */
+
+static struct gomp_trace_buffer *
+trace_new_buffer (struct gomp_thread *thr)
+{
+  struct gomp_trace_buffer *buf;
+
+  buf = gomp_malloc (sizeof (*buf)
+		     + (trace_mask + 1) * sizeof (struct gomp_trace_event));
+  buf->count = 0;
+  gomp_mutex_lock (&trace_lock);
+  buf->thread = trace_threads++;
+  buf->next = trace_buffers;
+  trace_buffers = buf;
+  gomp_mutex_unlock (&trace_lock);
+  thr->trace = buf;
+  return buf;
+}
+
+void
+gomp_trace_record (enum gomp_trace_kind kind, unsigned int arg0,
+		   unsigned long long arg1)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_trace_buffer *buf = thr->trace;
+  struct gomp_trace_event *ev;
+
+  if (__builtin_expect (buf == NULL, 0))
+    buf = trace_new_buffer (thr);
+  ev = &buf->events[buf->count & trace_mask];
+  ev->time = trace_clock () - trace_start;
+  ev->kind = kind;
+  ev->arg0 = arg0;
+  ev->arg1 = arg1;
+  buf->count++;
+}
+
+/* Write out the events of all threads.  Threads still running at this
+   point can go on recording while their buffer is being written, which
+   at worst garbles a few of the oldest events of a full buffer.  */
+
+static void __attribute__((destructor))
+trace_destructor (void)
+{
+  struct gomp_trace_buffer *buf;
+  uint32_t header[4];
+  FILE *f;
+
+  if (!gomp_trace_var)
+    return;
+  gomp_trace_var = false;
+
+  f = fopen (trace_file, "wb");
+  if (f == NULL)
+    {
+      gomp_error ("could not open trace file %s", trace_file);
+      return;
+    }
+  fwrite ("GOMPTRC1", 1, 8, f);
+  header[0] = 0x01020304;
+  header[1] = sizeof (struct gomp_trace_event);
+  header[2] = getpid ();
+  header[3] = 0;
+  fwrite (header, sizeof (header[0]), 4, f);
+
+  gomp_mutex_lock (&trace_lock);
+  for (buf = trace_buffers; buf != NULL; buf = buf->next)
+    {
+      uint64_t count = buf->count, n, i;
+
+      n = count <= trace_mask + 1 ? count : trace_mask + 1;
+      header[0] = buf->thread;
+      header[1] = 0;
+      fwrite (header, sizeof (header[0]), 2, f);
+      fwrite (&count, sizeof (count), 1, f);
+      fwrite (&n, sizeof (n), 1, f);
+      for (i = count - n; i < count; i++)
+	fwrite (&buf->events[i & trace_mask], sizeof (buf->events[0]), 1, f);
+    }
+  gomp_mutex_unlock (&trace_lock);
+
+  if (fclose (f) != 0)
+    gomp_error ("could not write trace file %s", trace_file);
+}
@@ -93,26 +93,33 @@ gomp_init_work_share (struct gomp_work_share *ws, bool ordered,
 		      unsigned nthreads)
 {
   gomp_mutex_init (&ws->lock);
-  if (__builtin_expect (ordered, 0))
+  ws->ordered_slots = NULL;
+  ws->ordered_slots_alloc = NULL;
+  if (__builtin_expect (ordered, 0) && nthreads > 1)
     {
-#define INLINE_ORDERED_TEAM_IDS_CNT \
-  ((sizeof (struct gomp_work_share) \
-    - offsetof (struct gomp_work_share, inline_ordered_team_ids)) \
-   / sizeof (((struct gomp_work_share *) 0)->inline_ordered_team_ids[0]))
-
-      if (nthreads > INLINE_ORDERED_TEAM_IDS_CNT)
-	ws->ordered_team_ids
-	  = gomp_malloc (nthreads * sizeof (*ws->ordered_team_ids));
+      unsigned i, n;
+
+      /* Ticket 0 may proceed right away, the other slots show tickets
+	 already past.  */
+      for (n = 1; n < nthreads; n *= 2)
+	;
+      if (n <= INLINE_ORDERED_SLOTS)
+	ws->ordered_slots = ws->inline_ordered_slots;
       else
-	ws->ordered_team_ids = ws->inline_ordered_team_ids;
-      memset (ws->ordered_team_ids, '\0',
-	      nthreads * sizeof (*ws->ordered_team_ids));
-      ws->ordered_num_used = 0;
-      ws->ordered_owner = -1;
-      ws->ordered_cur = 0;
+	{
+	  ws->ordered_slots_alloc
+	    = gomp_malloc (n * sizeof (gomp_ticket_t)
+			   + __alignof__ (gomp_ticket_t) - 1);
+	  ws->ordered_slots
+	    = (void *) (((uintptr_t) ws->ordered_slots_alloc
+			 + __alignof__ (gomp_ticket_t) - 1)
+			& ~(uintptr_t) (__alignof__ (gomp_ticket_t) - 1));
+	}
+      for (i = 0; i < n; i++)
+	gomp_ticket_init (&ws->ordered_slots[i], i == 0 ? 0 : i - n);
+      ws->ordered_mask = n - 1;
+      ws->ordered_next_ticket = 0;
     }
-  else
-    ws->ordered_team_ids = NULL;
   gomp_ptrlock_init (&ws->next_ws, NULL);
   ws->threads_completed = 0;
 }
@@ -124,8 +131,14 @@ void
 gomp_fini_work_share (struct gomp_work_share *ws)
 {
   gomp_mutex_destroy (&ws->lock);
-  if (ws->ordered_team_ids != ws->inline_ordered_team_ids)
-    free (ws->ordered_team_ids);
+  if (__builtin_expect (ws->ordered_slots != NULL, 0))
+    {
+      unsigned i;
+
+      for (i = 0; i <= ws->ordered_mask; i++)
+	gomp_ticket_destroy (&ws->ordered_slots[i]);
+      free (ws->ordered_slots_alloc);
+    }
   gomp_ptrlock_destroy (&ws->next_ws);
 }
 
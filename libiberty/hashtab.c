@@ -60,6 +60,10 @@ Boston, MA 02110-1301, USA.  */
 #include "ansidecl.h"
 #include "hashtab.h"
 
+#if defined (__SSE2__) && HTAB_GROUP_SIZE == 16
+#include <emmintrin.h>
+#endif
+
 #ifndef CHAR_BIT
 #define CHAR_BIT 8
 #endif
@@ -72,6 +76,12 @@ static hashval_t hash_pointer (const void *);
 static int eq_pointer (const void *, const void *);
 static int htab_expand (htab_t);
 static PTR *find_empty_slot_for_expand (htab_t, hashval_t);
+static PTR *htab_alloc_entries (htab_t, size_t);
+static unsigned int htab_grouped_index (size_t);
+static PTR *find_empty_slot_grouped (htab_t, hashval_t);
+static PTR *htab_find_slot_grouped (htab_t, const PTR, hashval_t,
+				    enum insert_option);
+static void htab_mark_deleted (htab_t, PTR *);
 
 /* At some point, we could make these be NULL, and modify the
    hash-table routines to handle NULL specially; that would avoid
@@ -191,6 +201,96 @@ higher_prime_index (unsigned long n)
   return low;
 }
 
+/* Tables created by htab_create_grouped_alloc keep a control byte for
+   each slot after the slots themselves.  The control byte of a slot
+   that holds an element has its top bit set and seven bits of the hash
+   of the element below.  */
+
+#define HTAB_CTRL_EMPTY 0
+#define HTAB_CTRL_DELETED 1
+
+#define htab_ctrl(htab) ((unsigned char *) ((htab)->entries + (htab)->size))
+
+/* Return the index of the smallest grouped table size of at least N
+   slots, in the sense of size_prime_index.  */
+
+static unsigned int
+htab_grouped_index (size_t n)
+{
+  unsigned int index = 0;
+
+  while (((size_t) HTAB_GROUP_SIZE << index) < n)
+    index++;
+  return index;
+}
+
+/* Scramble HASH, since a grouped table takes the bits it needs from it
+   directly.  */
+
+static inline hashval_t
+htab_grouped_mix (hashval_t hash)
+{
+  return (hash * (hashval_t) 0x9e3779b1) & 0xffffffff;
+}
+
+/* Return the group at which to start looking for an element whose
+   scrambled hash is MIXED in HTAB.  */
+
+static inline size_t
+htab_grouped_first (hashval_t mixed, htab_t htab)
+{
+  return (mixed >> 1) >> (31 - htab->size_prime_index);
+}
+
+/* Return the control byte of an element whose scrambled hash is
+   MIXED.  */
+
+static inline unsigned char
+htab_grouped_ctrl (hashval_t mixed)
+{
+  return 0x80 | ((mixed ^ (mixed >> 15)) & 0x7f);
+}
+
+/* Return a mask with bit I set for each of the HTAB_GROUP_SIZE control
+   bytes I from CTRL that are equal to C.  */
+
+static inline unsigned int
+htab_group_match (const unsigned char *ctrl, unsigned char c)
+{
+#if defined (__SSE2__) && HTAB_GROUP_SIZE == 16
+  __m128i group = _mm_loadu_si128 ((const __m128i *) ctrl);
+
+  return _mm_movemask_epi8 (_mm_cmpeq_epi8 (group,
+					    _mm_set1_epi8 ((char) c)));
+#else
+  unsigned int i, mask = 0;
+
+  for (i = 0; i < HTAB_GROUP_SIZE; i++)
+    if (ctrl[i] == c)
+      mask |= 1u << i;
+  return mask;
+#endif
+}
+
+/* Return the number of the lowest bit set in MASK, which is nonzero.  */
+
+static inline unsigned int
+htab_lowest_bit (unsigned int mask)
+{
+#if GCC_VERSION >= 3004
+  return __builtin_ctz (mask);
+#else
+  unsigned int i = 0;
+
+  while (!(mask & 1))
+    {
+      mask >>= 1;
+      i++;
+    }
+  return i;
+#endif
+}
+
 /* Returns a hash code for P.  */
 
 static hashval_t
@@ -350,6 +450,44 @@ htab_create_alloc_ex (size_t size, htab_hash hash_f, htab_eq eq_f,
   return result;
 }
 
+/* As htab_create_alloc, but create a grouped table: the slots come in
+   groups of HTAB_GROUP_SIZE, each with a control byte holding bits of
+   the hash of its element.  A search compares the control bytes of a
+   group at once, calls EQ_F only on the elements whose bits match, and
+   goes on to another group only if the group has no empty slot.  */
+
+htab_t
+htab_create_grouped_alloc (size_t size, htab_hash hash_f, htab_eq eq_f,
+			   htab_del del_f, htab_alloc alloc_f,
+			   htab_free free_f)
+{
+  htab_t result;
+  unsigned int size_index;
+
+  size_index = htab_grouped_index (size);
+  size = (size_t) HTAB_GROUP_SIZE << size_index;
+
+  result = (htab_t) (*alloc_f) (1, sizeof (struct htab));
+  if (result == NULL)
+    return NULL;
+  result->grouped = 1;
+  result->alloc_f = alloc_f;
+  result->free_f = free_f;
+  result->entries = htab_alloc_entries (result, size);
+  if (result->entries == NULL)
+    {
+      if (free_f != NULL)
+	(*free_f) (result);
+      return NULL;
+    }
+  result->size = size;
+  result->size_prime_index = size_index;
+  result->hash_f = hash_f;
+  result->eq_f = eq_f;
+  result->del_f = del_f;
+  return result;
+}
+
 /* Update the function pointers and allocation parameter in the htab_t.  */
 
 void
@@ -424,21 +562,29 @@ htab_empty (htab_t htab)
   /* Instead of clearing megabyte, downsize the table.  */
   if (size > 1024*1024 / sizeof (PTR))
     {
-      int nindex = higher_prime_index (1024 / sizeof (PTR));
-      int nsize = prime_tab[nindex].prime;
+      int nindex, nsize;
+
+      if (htab->grouped)
+	{
+	  nindex = htab_grouped_index (1024 / sizeof (PTR));
+	  nsize = HTAB_GROUP_SIZE << nindex;
+	}
+      else
+	{
+	  nindex = higher_prime_index (1024 / sizeof (PTR));
+	  nsize = prime_tab[nindex].prime;
+	}
 
       if (htab->free_f != NULL)
 	(*htab->free_f) (htab->entries);
       else if (htab->free_with_arg_f != NULL)
 	(*htab->free_with_arg_f) (htab->alloc_arg, htab->entries);
-      if (htab->alloc_with_arg_f != NULL)
-	htab->entries = (PTR *) (*htab->alloc_with_arg_f) (htab->alloc_arg, nsize,
-						           sizeof (PTR *));
-      else
-	htab->entries = (PTR *) (*htab->alloc_f) (nsize, sizeof (PTR *));
+      htab->entries = htab_alloc_entries (htab, nsize);
      htab->size = nsize;
      htab->size_prime_index = nindex;
     }
+  else if (htab->grouped)
+    memset (entries, 0, size * sizeof (PTR) + size);
   else
     memset (entries, 0, size * sizeof (PTR));
   htab->n_deleted = 0;
@@ -480,6 +626,52 @@ find_empty_slot_for_expand (htab_t htab, hashval_t hash)
     }
 }
 
+/* Like find_empty_slot_for_expand, but for a grouped table; also set
+   the control byte of the slot.  */
+
+static PTR *
+find_empty_slot_grouped (htab_t htab, hashval_t hash)
+{
+  hashval_t mixed = htab_grouped_mix (hash);
+  unsigned char *ctrl = htab_ctrl (htab);
+  size_t mask = htab_size (htab) / HTAB_GROUP_SIZE - 1;
+  size_t group = htab_grouped_first (mixed, htab);
+  size_t step = 0;
+
+  for (;;)
+    {
+      size_t base = group * HTAB_GROUP_SIZE;
+      unsigned int empty = htab_group_match (ctrl + base, HTAB_CTRL_EMPTY);
+
+      if (empty)
+	{
+	  size_t index = base + htab_lowest_bit (empty);
+
+	  ctrl[index] = htab_grouped_ctrl (mixed);
+	  return htab->entries + index;
+	}
+      group = (group + ++step) & mask;
+    }
+}
+
+/* Allocate the slots of a table of SIZE entries for HTAB, followed by
+   their control bytes if HTAB is grouped.  */
+
+static PTR *
+htab_alloc_entries (htab_t htab, size_t size)
+{
+  size_t n = size;
+
+  if (htab->grouped)
+    n += size / sizeof (PTR);
+
+  if (htab->alloc_with_arg_f != NULL)
+    return (PTR *) (*htab->alloc_with_arg_f) (htab->alloc_arg, n,
+					      sizeof (PTR));
+  else
+    return (PTR *) (*htab->alloc_f) (n, sizeof (PTR));
+}
+
 /* The following function changes size of memory allocated for the
    entries and repeatedly inserts the table elements.  The occupancy
    of the table after the call will be about 50%.  Naturally the hash
@@ -508,8 +700,16 @@ htab_expand (htab_t htab)
      too full or too empty.  */
   if (elts * 2 > osize || (elts * 8 < osize && osize > 32))
     {
-      nindex = higher_prime_index (elts * 2);
-      nsize = prime_tab[nindex].prime;
+      if (htab->grouped)
+	{
+	  nindex = htab_grouped_index (elts * 2);
+	  nsize = (size_t) HTAB_GROUP_SIZE << nindex;
+	}
+      else
+	{
+	  nindex = higher_prime_index (elts * 2);
+	  nsize = prime_tab[nindex].prime;
+	}
     }
   else
     {
@@ -517,11 +717,7 @@ htab_expand (htab_t htab)
       nsize = osize;
     }
 
-  if (htab->alloc_with_arg_f != NULL)
-    nentries = (PTR *) (*htab->alloc_with_arg_f) (htab->alloc_arg, nsize,
-						  sizeof (PTR *));
-  else
-    nentries = (PTR *) (*htab->alloc_f) (nsize, sizeof (PTR *));
+  nentries = htab_alloc_entries (htab, nsize);
   if (nentries == NULL)
     return 0;
   htab->entries = nentries;
@@ -537,8 +733,12 @@ htab_expand (htab_t htab)
 
       if (x != HTAB_EMPTY_ENTRY && x != HTAB_DELETED_ENTRY)
 	{
-	  PTR *q = find_empty_slot_for_expand (htab, (*htab->hash_f) (x));
+	  PTR *q;
 
+	  if (htab->grouped)
+	    q = find_empty_slot_grouped (htab, (*htab->hash_f) (x));
+	  else
+	    q = find_empty_slot_for_expand (htab, (*htab->hash_f) (x));
 	  *q = x;
 	}
 
@@ -563,6 +763,13 @@ htab_find_with_hash (htab_t htab, const PTR element, hashval_t hash)
   size_t size;
   PTR entry;
 
+  if (htab->grouped)
+    {
+      PTR *slot = htab_find_slot_grouped (htab, element, hash, NO_INSERT);
+
+      return slot ? *slot : HTAB_EMPTY_ENTRY;
+    }
+
   htab->searches++;
   size = htab_size (htab);
   index = htab_mod (hash, htab);
@@ -621,6 +828,9 @@ htab_find_slot_with_hash (htab_t htab, const PTR element,
       size = htab_size (htab);
     }
 
+  if (htab->grouped)
+    return htab_find_slot_grouped (htab, element, hash, insert);
+
   index = htab_mod (hash, htab);
 
   htab->searches++;
@@ -669,6 +879,73 @@ htab_find_slot_with_hash (htab_t htab, const PTR element,
   return &htab->entries[index];
 }
 
+/* The part of htab_find_slot_with_hash for grouped tables.  */
+
+static PTR *
+htab_find_slot_grouped (htab_t htab, const PTR element, hashval_t hash,
+			enum insert_option insert)
+{
+  hashval_t mixed = htab_grouped_mix (hash);
+  unsigned char c = htab_grouped_ctrl (mixed);
+  unsigned char *ctrl = htab_ctrl (htab);
+  size_t size = htab_size (htab);
+  size_t mask = size / HTAB_GROUP_SIZE - 1;
+  size_t group = htab_grouped_first (mixed, htab);
+  size_t step = 0;
+  size_t first_free = size;
+
+  htab->searches++;
+
+  for (;;)
+    {
+      size_t base = group * HTAB_GROUP_SIZE;
+      unsigned int match = htab_group_match (ctrl + base, c);
+      unsigned int empty;
+
+      /* Only the elements whose hash bits match need comparing.  */
+      while (match)
+	{
+	  size_t index = base + htab_lowest_bit (match);
+	  PTR entry = htab->entries[index];
+
+	  if (entry != HTAB_EMPTY_ENTRY && entry != HTAB_DELETED_ENTRY
+	      && (*htab->eq_f) (entry, element))
+	    return &htab->entries[index];
+	  match &= match - 1;
+	}
+
+      empty = htab_group_match (ctrl + base, HTAB_CTRL_EMPTY);
+      if (insert == INSERT && first_free == size)
+	{
+	  unsigned int free_slots
+	    = empty | htab_group_match (ctrl + base, HTAB_CTRL_DELETED);
+
+	  if (free_slots)
+	    first_free = base + htab_lowest_bit (free_slots);
+	}
+
+      /* An element is never put past a group with an empty slot.  */
+      if (empty)
+	break;
+
+      htab->collisions++;
+      group = (group + ++step) & mask;
+    }
+
+  if (insert == NO_INSERT)
+    return NULL;
+
+  if (ctrl[first_free] == HTAB_CTRL_DELETED)
+    {
+      htab->n_deleted--;
+      htab->entries[first_free] = HTAB_EMPTY_ENTRY;
+    }
+  else
+    htab->n_elements++;
+  ctrl[first_free] = c;
+  return &htab->entries[first_free];
+}
+
 /* Like htab_find_slot_with_hash, but compute the hash value from the
    element.  */
 
@@ -706,8 +983,7 @@ htab_remove_elt_with_hash (htab_t htab, PTR element, hashval_t hash)
   if (htab->del_f)
     (*htab->del_f) (*slot);
 
-  *slot = HTAB_DELETED_ENTRY;
-  htab->n_deleted++;
+  htab_mark_deleted (htab, slot);
 }
 
 /* This function clears a specified slot in a hash table.  It is
@@ -724,6 +1000,32 @@ htab_clear_slot (htab_t htab, PTR *slot)
   if (htab->del_f)
     (*htab->del_f) (*slot);
 
+  htab_mark_deleted (htab, slot);
+}
+
+/* Mark SLOT of HTAB, whose element has been removed, as deleted.  */
+
+static void
+htab_mark_deleted (htab_t htab, PTR *slot)
+{
+  if (htab->grouped)
+    {
+      size_t index = slot - htab->entries;
+      unsigned char *ctrl = htab_ctrl (htab);
+      size_t base = index & ~(size_t) (HTAB_GROUP_SIZE - 1);
+
+      /* No search goes past a group with an empty slot, so in such a
+	 group the slot can simply become empty again.  */
+      if (htab_group_match (ctrl + base, HTAB_CTRL_EMPTY))
+	{
+	  ctrl[index] = HTAB_CTRL_EMPTY;
+	  *slot = HTAB_EMPTY_ENTRY;
+	  htab->n_elements--;
+	  return;
+	}
+      ctrl[index] = HTAB_CTRL_DELETED;
+    }
+
   *slot = HTAB_DELETED_ENTRY;
   htab->n_deleted++;
 }
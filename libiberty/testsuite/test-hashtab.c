@@ -0,0 +1,280 @@
+/* Hash table test and benchmark program.
+   Copyright (C) 2009 Free Software Foundation, Inc.
+
+   This file is part of the libiberty library, which is part of GCC.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   In addition to the permissions in the GNU General Public License, the
+   Free Software Foundation gives you unlimited permission to link the
+   compiled version of this file into combinations with other programs,
+   and to distribute those combinations without any restriction coming
+   from the use of this file.  (The General Public License restrictions
+   do apply in other respects; for example, they cover modification of
+   the file, and distribution when not linked into a combined
+   executable.)
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* Without arguments, check that tables created by htab_create_alloc
+   and by htab_create_grouped_alloc behave the same.  With "-b N",
+   time both kinds of table on N elements instead.  */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include "libiberty.h"
+#include "hashtab.h"
+#include <stdio.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#ifndef EXIT_SUCCESS
+#define EXIT_SUCCESS 0
+#endif
+
+#ifndef EXIT_FAILURE
+#define EXIT_FAILURE 1
+#endif
+
+/* The elements of the tables.  */
+
+struct elt
+{
+  unsigned int key;
+  unsigned int pad[7];
+};
+
+/* The number of calls to eq_elt.  */
+static unsigned long eq_calls;
+
+static hashval_t
+hash_elt (const void *p)
+{
+  return iterative_hash_object (((const struct elt *) p)->key, 0);
+}
+
+static int
+eq_elt (const void *p1, const void *p2)
+{
+  eq_calls++;
+  return ((const struct elt *) p1)->key == ((const struct elt *) p2)->key;
+}
+
+static int
+count_elt (void **slot ATTRIBUTE_UNUSED, void *info)
+{
+  (*(size_t *) info)++;
+  return 1;
+}
+
+/* Clear the slots of the elements with keys that are multiples of 3.  */
+
+static int
+clear_elt (void **slot, void *info)
+{
+  if (((struct elt *) *slot)->key % 3 == 0)
+    htab_clear_slot ((htab_t) info, slot);
+  return 1;
+}
+
+/* Create a table for the test of the given kind.  */
+
+static htab_t
+create_table (int grouped)
+{
+  if (grouped)
+    return htab_create_grouped_alloc (1, hash_elt, eq_elt, NULL,
+				      xcalloc, free);
+  else
+    return htab_create_alloc (1, hash_elt, eq_elt, NULL, xcalloc, free);
+}
+
+/* Allocate N elements with keys 0 to N - 1.  */
+
+static struct elt *
+make_elts (size_t n)
+{
+  struct elt *elts = XCNEWVEC (struct elt, n);
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    elts[i].key = i;
+  return elts;
+}
+
+/* Insert, look up and remove elements in a table of the given kind,
+   checking the results.  Return the number of failures.  */
+
+static int
+run_tests (int grouped)
+{
+  const char *name = grouped ? "grouped" : "plain";
+  const size_t n = 20000;
+  struct elt *elts = make_elts (2 * n);
+  htab_t htab = create_table (grouped);
+  size_t i, count;
+  int fails = 0;
+
+#define CHECK(COND, WHAT)						\
+  do									\
+    if (!(COND))							\
+      {									\
+	printf ("FAIL: test-hashtab %s: %s\n", name, WHAT);		\
+	fails++;							\
+	goto done;							\
+      }									\
+  while (0)
+
+  for (i = 0; i < n; i++)
+    {
+      void **slot = htab_find_slot (htab, &elts[i], INSERT);
+
+      CHECK (*slot == HTAB_EMPTY_ENTRY, "element found before insertion");
+      *slot = &elts[i];
+    }
+  CHECK (htab_elements (htab) == n, "wrong number of elements");
+
+  for (i = 0; i < 2 * n; i++)
+    {
+      void *found = htab_find (htab, &elts[i]);
+
+      CHECK (found == (i < n ? &elts[i] : NULL), "lookup");
+    }
+
+  for (i = 0; i < n; i += 2)
+    htab_remove_elt (htab, &elts[i]);
+  CHECK (htab_elements (htab) == n / 2, "wrong number after removal");
+  for (i = 0; i < n; i++)
+    CHECK (htab_find (htab, &elts[i]) == (i % 2 ? &elts[i] : NULL),
+	   "lookup after removal");
+
+  /* Reinsert the removed elements, and more.  */
+  for (i = 0; i < 2 * n; i += 2)
+    *htab_find_slot (htab, &elts[i], INSERT) = &elts[i];
+  CHECK (htab_elements (htab) == n + n / 2, "wrong number after reinsertion");
+  for (i = 0; i < 2 * n; i++)
+    CHECK (htab_find (htab, &elts[i]) == (i < n || i % 2 == 0
+					  ? &elts[i] : NULL),
+	   "lookup after reinsertion");
+
+  htab_traverse (htab, clear_elt, htab);
+  count = 0;
+  htab_traverse (htab, count_elt, &count);
+  CHECK (count == htab_elements (htab), "traversal");
+  for (i = 0; i < 2 * n; i++)
+    CHECK (htab_find (htab, &elts[i]) == ((i < n || i % 2 == 0) && i % 3
+					  ? &elts[i] : NULL),
+	   "lookup after clearing slots");
+
+  htab_empty (htab);
+  CHECK (htab_elements (htab) == 0, "emptying");
+  for (i = 0; i < n; i++)
+    CHECK (htab_find (htab, &elts[i]) == NULL, "lookup after emptying");
+  for (i = 0; i < n; i++)
+    *htab_find_slot (htab, &elts[i], INSERT) = &elts[i];
+  for (i = 0; i < n; i++)
+    CHECK (htab_find (htab, &elts[i]) == &elts[i], "lookup after refilling");
+
+  printf ("PASS: test-hashtab %s.\n", name);
+
+ done:
+#undef CHECK
+  htab_delete (htab);
+  free (elts);
+  return fails;
+}
+
+/* Time insertions and successful and failed lookups of N elements in
+   a table of the given kind.  */
+
+static void
+run_benchmark (int grouped, size_t n)
+{
+  struct elt *elts = make_elts (2 * n);
+  struct elt **order = XNEWVEC (struct elt *, n);
+  htab_t htab = create_table (grouped);
+  long start, insert_time, hit_time, miss_time;
+  unsigned long hit_calls, miss_calls;
+  size_t i, round, rounds = 1 + 4000000 / n;
+
+  /* Visit the elements in a scrambled order, as a compiler would.  */
+  for (i = 0; i < n; i++)
+    order[i] = &elts[(i * 7919) % n];
+
+  start = get_run_time ();
+  for (i = 0; i < n; i++)
+    *htab_find_slot (htab, order[i], INSERT) = order[i];
+  insert_time = get_run_time () - start;
+
+  eq_calls = 0;
+  start = get_run_time ();
+  for (round = 0; round < rounds; round++)
+    for (i = 0; i < n; i++)
+      if (htab_find (htab, order[i]) != order[i])
+	abort ();
+  hit_time = get_run_time () - start;
+  hit_calls = eq_calls;
+
+  eq_calls = 0;
+  start = get_run_time ();
+  for (round = 0; round < rounds; round++)
+    for (i = n; i < 2 * n; i++)
+      if (htab_find (htab, &elts[i]) != NULL)
+	abort ();
+  miss_time = get_run_time () - start;
+  miss_calls = eq_calls;
+
+  printf ("%-8s %9lu elements: insert %6ld us, %lu hits %8ld us"
+	  " (%.2f eq/lookup), misses %8ld us (%.2f eq/lookup)\n",
+	  grouped ? "grouped" : "plain", (unsigned long) n, insert_time,
+	  (unsigned long) (rounds * n), hit_time,
+	  (double) hit_calls / (rounds * n), miss_time,
+	  (double) miss_calls / (rounds * n));
+
+  htab_delete (htab);
+  free (order);
+  free (elts);
+}
+
+int
+main (int argc, char **argv)
+{
+  int fails;
+
+  if (argc == 3 && strcmp (argv[1], "-b") == 0)
+    {
+      size_t n = atol (argv[2]);
+
+      if (n == 0)
+	{
+	  fprintf (stderr, "usage: %s [-b N]\n", argv[0]);
+	  exit (EXIT_FAILURE);
+	}
+      run_benchmark (0, n);
+      run_benchmark (1, n);
+      exit (EXIT_SUCCESS);
+    }
+
+  fails = run_tests (0);
+  fails += run_tests (1);
+  if (!fails)
+    exit (EXIT_SUCCESS);
+  else
+    exit (EXIT_FAILURE);
+}